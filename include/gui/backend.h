@@ -19,4 +19,9 @@ namespace guicpp
 
     auto backend_load_texture(const char *path, int *width, int *height) -> BackendTexture;
     auto backend_load_texture(const uint8_t *data, size_t size, int *width, int *height) -> BackendTexture;
+    // Empty RGBA texture drawn with nearest filtering, for pixels that change
+    auto backend_create_texture(int width, int height) -> BackendTexture;
+    // Replaces rows [y, y + rows) with width RGBA pixels per row
+    void backend_update_texture(BackendTexture texture, int y, int width, int rows, const uint8_t *rgba);
+    void backend_free_texture(BackendTexture texture);
 }
@@ -1,7 +1,14 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <functional>
+#include <mutex>
 #include <vector>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include <fmt/format.h>
 #include <fmt/chrono.h>
 #include <chrono>
@@ -310,28 +317,655 @@ private:
     std::vector<Widget> widgets_;
 };
 
+class LogChannel
+{
+public:
+    LogChannel(const char *name, size_t max_lines = 10000);
+    ~LogChannel();
+    const char* name() const;
+    void add_log(const char *text);
+
+    // Keeps evicted lines compressed in memory, or in the file at path, instead of dropping them.
+    // A LogWindow bound to this channel alone can then still scroll and filter the whole history.
+    void enable_archive(const char *path = nullptr);
+
+    template <typename... Args>
+    void info(Args&&... args)
+    {
+        log("info", std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    void warn(Args&&... args)
+    {
+        log("warning", std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    void error(Args&&... args)
+    {
+        log("error", std::forward<Args>(args)...);
+    }
+
+private:
+    friend class LogWindow;
+    struct impl;
+    std::shared_ptr<impl> pimpl_;
+
+    template <typename... Args>
+    void log(std::string_view tag, std::string_view format_str, Args&&... args)
+    {
+        auto now = std::chrono::system_clock::now();
+        auto result = fmt::format("{:%Y-%m-%d %H:%M:%S} {}: {}\n", now, tag, fmt::format(format_str, std::forward<Args>(args)...));
+        add_log(result.c_str());
+    }
+};
+
 class LogWindow
 {
 public:
     LogWindow(const char* text, Size size = {}, Position position = {});
+    LogWindow(const char* text, std::vector<LogChannel> channels, Size size = {}, Position position = {});
     ~LogWindow();
     LogWindow(LogWindow const& rhs);
     void draw() const;
     void add_log(const char *text);
+    void add_channel(LogChannel channel);
+
+private:
+    struct impl;
+    std::unique_ptr<impl> pimpl_;
+};
+
+// Read-only view of a text file of any size. The file is memory-mapped and its lines are indexed on a
+// background thread, so nothing is copied and only the visible lines are touched when drawing.
+class TextFileView
+{
+public:
+    TextFileView(const char* text, const char *path, Size size = {}, Position position = {});
+    ~TextFileView();
+    TextFileView(TextFileView const& rhs);
+    void draw() const;
 
 private:
     struct impl;
     std::unique_ptr<impl> pimpl_;
 };
 
+// Source of the bytes shown by a MemoryEditorWindow. The visible range is read once per frame,
+// edits are written back as coalesced ranges.
+class MemoryProvider
+{
+public:
+    virtual ~MemoryProvider() = default;
+    virtual size_t size() const = 0;
+    virtual void read(size_t offset, uint8_t *out, size_t size) = 0;
+    virtual void write(size_t offset, const uint8_t *in, size_t size) = 0;
+    // Sets the entries of out for bytes to highlight, out is cleared beforehand
+    virtual void highlight(size_t /*offset*/, bool * /*out*/, size_t /*size*/) {}
+    // Sets the entries of out for bytes that are not available yet, drawn as placeholders
+    virtual void pending(size_t /*offset*/, bool * /*out*/, size_t /*size*/) {}
+};
+
+// Memory behind a slow transport (a device on a pipe, a socket...), read and written in pages.
+// Calls come from a worker thread of the window, never from the UI thread.
+class PageSource
+{
+public:
+    virtual ~PageSource() = default;
+    virtual size_t size() const = 0;
+    virtual size_t page_size() const { return 4096; }
+    // Reads [offset, offset + size), returns false on failure and the page is requested again later
+    virtual bool fetch(size_t offset, uint8_t *out, size_t size) = 0;
+    virtual bool store(size_t /*offset*/, const uint8_t * /*in*/, size_t /*size*/) { return false; }
+};
+
+// Memory shared with another thread (e.g. an emulator) behind a sequence lock: writers never wait
+// for the UI, and reads are retried until no write overlapped them, so a frame never shows a torn update.
+class SeqLockMemory : public MemoryProvider
+{
+public:
+    SeqLockMemory(uint8_t *bytes, size_t size) : bytes_{bytes}, size_{size} {}
+
+    // Changes the memory from any thread, f is called with the bytes
+    template <typename F>
+    void modify(F&& f)
+    {
+        std::lock_guard<std::mutex> lock{write_mutex_};
+        begin_write();
+        f(bytes_);
+        end_write();
+    }
+
+    // Number of completed modifications
+    uint64_t version() const { return seq_.load(std::memory_order_acquire) / 2; }
+
+    size_t size() const override { return size_; }
+    void read(size_t offset, uint8_t *out, size_t size) override;
+    void write(size_t offset, const uint8_t *in, size_t size) override;
+
+private:
+    void begin_write();
+    void end_write();
+
+    uint8_t *bytes_;
+    size_t size_;
+    std::atomic<uint64_t> seq_{0};
+    std::mutex write_mutex_;
+};
+
+// Editable view of a file with inserts and deletes. The file is mapped read-only and its contents
+// become a sequence of pieces of the file or of a buffer of added bytes, held in a balanced tree by
+// offset: reads and edits cost O(log pieces) whatever the size of the file, and an edit adds a
+// constant number of pieces and undo records. Give it to MemoryEditorWindow as its provider.
+class PieceTable : public MemoryProvider
+{
+public:
+    // Throws -1 when the file cannot be opened
+    explicit PieceTable(const char *path);
+    ~PieceTable() override;
+    PieceTable(PieceTable const&) = delete;
+    PieceTable& operator=(PieceTable const&) = delete;
+
+    size_t size() const override;
+    void read(size_t offset, uint8_t *out, size_t size) override;
+    // Overwrites bytes. Single bytes written one after the other, as typed, are one undo step.
+    void write(size_t offset, const uint8_t *in, size_t size) override;
+    void insert(size_t offset, const uint8_t *in, size_t size);
+    void erase(size_t offset, size_t size);
+
+    bool undo();
+    bool redo();
+    bool can_undo() const;
+    bool can_redo() const;
+    // Differs from the file on disk
+    bool modified() const;
+    size_t piece_count() const;
+    const char* path() const;
+
+    // Streams the pieces to a temporary file that then replaces the file. The file is opened again,
+    // which clears the history. Returns false on failure.
+    bool save();
+    // Writes a copy, the table stays on its file
+    bool save(const char *path) const;
+
+private:
+    struct impl;
+    std::unique_ptr<impl> pimpl_;
+};
+
+enum class FieldType { u8, i8, u16, i16, u32, i32, u64, i64, f32, f64 };
+enum class Endian { little, big };
+
+// Loads sizeof(T) bytes in the given byte order. Instantiated per type, it compiles to a load and
+// at most a byte swap.
+template <typename T, Endian E>
+uint64_t load_field(const uint8_t *bytes)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < sizeof(T); i++) {
+        value |= static_cast<uint64_t>(bytes[E == Endian::little ? i : sizeof(T) - 1 - i]) << (8 * i);
+    }
+    return value;
+}
+
+// Field of a structure layout. Arrays repeat it count times, bitfields take bit_width bits from
+// bit_offset of the loaded value (0 for the whole value).
+struct LayoutField
+{
+    std::string name;
+    FieldType type;
+    Endian endian;
+    size_t offset;
+    size_t count;
+    unsigned bit_offset;
+    unsigned bit_width;
+    uint64_t (*load)(const uint8_t *bytes);
+};
+
+// Field of a layout known at compile time, for StructLayout::fixed
+template <typename T, size_t Offset, Endian E = Endian::little, unsigned BitOffset = 0, unsigned BitWidth = 0>
+struct FixedField
+{
+    using type = T;
+    static constexpr size_t offset = Offset;
+    static constexpr Endian endian = E;
+    static constexpr unsigned bit_offset = BitOffset;
+    static constexpr unsigned bit_width = BitWidth;
+};
+
+// Loads every field into out, in order. The loads unroll into straight-line code at constant offsets.
+template <typename... Fields>
+void decode_fields(const uint8_t *bytes, uint64_t *out)
+{
+    size_t i = 0;
+    ((out[i++] = load_field<typename Fields::type, Fields::endian>(bytes + Fields::offset)), ...);
+}
+
+// C structure or register layout to overlay on memory. Layouts built in code get the loaders
+// instantiated for their field types, layouts parsed at runtime pick the same loaders from a
+// table by type and byte order. Fixed layouts also get one decoder for all their fields.
+class StructLayout
+{
+public:
+    using DecodeFn = void (*)(const uint8_t *bytes, uint64_t *out);
+
+    explicit StructLayout(std::string name) : name_{std::move(name)} {}
+
+    // Layout with all of its fields known at compile time, e.g.
+    //   StructLayout::fixed<FixedField<uint32_t, 0>, FixedField<uint16_t, 4, Endian::big>>("header", {"magic", "length"})
+    template <typename... Fields>
+    static StructLayout fixed(std::string name, std::array<const char*, sizeof...(Fields)> const& names)
+    {
+        StructLayout layout{std::move(name)};
+        size_t i = 0;
+        (layout.add(LayoutField{names[i++], field_type<typename Fields::type>(), Fields::endian, Fields::offset, 1,
+            Fields::bit_offset, Fields::bit_width, &load_field<typename Fields::type, Fields::endian>}), ...);
+        layout.decode_ = &decode_fields<Fields...>;
+        return layout;
+    }
+
+    template <typename T, Endian E = Endian::little>
+    StructLayout& field(const char *name, size_t offset, size_t count = 1)
+    {
+        return add(LayoutField{name, field_type<T>(), E, offset, count, 0, 0, &load_field<T, E>});
+    }
+
+    template <typename T, Endian E = Endian::little>
+    StructLayout& bits(const char *name, size_t offset, unsigned bit_offset, unsigned bit_width)
+    {
+        return add(LayoutField{name, field_type<T>(), E, offset, 1, bit_offset, bit_width, &load_field<T, E>});
+    }
+
+    // C-like declarations, one field per statement, e.g.
+    //   struct header { u32 magic; be u16 length; u8 mode : 3; u8 flags : 5; f32 gain[4]; u16 crc @ 0x3E; };
+    // Fields are aligned to their size as in C, unless the struct is declared "packed struct" or the
+    // field is placed with @. Bitfields of the same type share a unit from its lowest bit, aligned
+    // like a field of that type. Throws -1 on errors.
+    static StructLayout parse(std::string_view text);
+    static StructLayout load(const char *path);
+
+    // Throws -1 for bitfields that do not fit their type and empty arrays
+    StructLayout& add(LayoutField field);
+
+    // Loads every field of a fixed layout at once, nullptr for other layouts
+    DecodeFn decoder() const { return decode_; }
+
+    static size_t type_size(FieldType type);
+
+    std::string const& name() const { return name_; }
+    std::vector<LayoutField> const& fields() const { return fields_; }
+    // End of the last field
+    size_t size() const { return size_; }
+
+private:
+    template <typename T>
+    static constexpr FieldType field_type()
+    {
+        static_assert(std::is_arithmetic<T>::value && sizeof(T) <= 8, "fields are integers or floating point");
+        if constexpr (std::is_floating_point<T>::value) {
+            return sizeof(T) == 4 ? FieldType::f32 : FieldType::f64;
+        } else {
+            constexpr int size_index = sizeof(T) == 1 ? 0 : sizeof(T) == 2 ? 1 : sizeof(T) == 4 ? 2 : 3;
+            return static_cast<FieldType>(size_index * 2 + (std::is_signed<T>::value ? 1 : 0));
+        }
+    }
+
+    std::string name_;
+    std::vector<LayoutField> fields_;
+    size_t size_ = 0;
+    DecodeFn decode_ = nullptr;
+};
+
+// Symbols of a firmware image, read from a GNU ld map (-Map), an IAR ENTRY LIST or nm output
+// (nm -S adds sizes). Symbols are kept as disjoint address ranges sorted by address: a symbol ends
+// at its size, the end of its section or the next symbol, whichever comes first. Names refer to
+// the mapped file, which stays open.
+class SymbolTable
+{
+public:
+    struct Symbol
+    {
+        uint64_t address;
+        uint64_t size;
+        std::string_view name;
+    };
+
+    // Throws -1 when the file cannot be read or has no symbols
+    explicit SymbolTable(const char *path);
+    ~SymbolTable();
+    SymbolTable(SymbolTable const&) = delete;
+    SymbolTable& operator=(SymbolTable const&) = delete;
+
+    std::vector<Symbol> const& symbols() const;
+    // The symbol containing address, null when it is between symbols
+    Symbol const* at(uint64_t address) const;
+    // The first symbol starting at or after address, null when there is none
+    Symbol const* next(uint64_t address) const;
+    // Address of a symbol by name, aliases at the same address included
+    bool find(std::string_view name, uint64_t &address) const;
+
+private:
+    struct impl;
+    std::unique_ptr<impl> pimpl_;
+};
+
+class PersistentMemory;
+
+// Called when watched bytes changed, with their previous and current values
+using MemoryWatchFn = std::function<void(size_t offset, size_t size, const uint8_t *before, const uint8_t *after)>;
+
+// Pixels of a memory bitmap. rgb565 is little endian, mono1 has the first pixel in the high bit.
+enum class PixelFormat { gray8, rgb565, rgba8, mono1 };
+
 class MemoryEditorWindow
 {
 public:
     MemoryEditorWindow(const char* text, uint8_t *bytes, size_t bytes_size, Size size = {}, Position position = {});
+    // Edits a file in place through a memory mapping, read-only if it cannot be opened for writing.
+    MemoryEditorWindow(const char* text, const char *path, Size size = {}, Position position = {});
+    MemoryEditorWindow(const char* text, std::shared_ptr<MemoryProvider> provider, Size size = {}, Position position = {});
+    // Fetches pages around the view in the background and draws placeholders until they arrive
+    MemoryEditorWindow(const char* text, std::shared_ptr<PageSource> source, Size size = {}, Position position = {});
     ~MemoryEditorWindow();
     MemoryEditorWindow(MemoryEditorWindow const& rhs);
     void draw() const;
 
+    // Highlights changed bytes, fading out over decay seconds. The memory is compared to a shadow
+    // copy every frame, or at most every interval seconds.
+    MemoryEditorWindow& heatmap(double decay = 2.0, double interval = 0.0);
+    MemoryEditorWindow& watch(size_t offset, size_t size, MemoryWatchFn f);
+    // Logs the old and new bytes of the range to channel when they change
+    MemoryEditorWindow& watch(const char *name, size_t offset, size_t size, LogChannel channel);
+    // Marks the pages edited in the window dirty, memory must outlive the window
+    MemoryEditorWindow& persist(PersistentMemory &memory);
+    // Records snapshots every interval seconds, or only with the Snapshot button when 0, and adds a
+    // timeline slider showing any of them read-only. Snapshots are stored as deltas within max_bytes.
+    MemoryEditorWindow& history(double interval = 0.0, size_t max_bytes = 64 << 20);
+    // Adds a CRC/checksum line for the whole memory or a range of it, updated in the background
+    MemoryEditorWindow& checksums();
+    // Decodes layout at offset into a table in a window of its own. Values are decoded every frame
+    // and formatted again only when they change, changed values are marked for a moment.
+    MemoryEditorWindow& overlay(const char *text, StructLayout layout, size_t offset, Size size = {}, Position position = {});
+    // Labels rows with the symbols they hold and accepts symbol names, also name+offset, in the goto
+    // field, where addresses then need a 0x prefix. Addresses are shown from base, the address of the
+    // first byte. table must outlive the window.
+    MemoryEditorWindow& symbols(SymbolTable const& table, uint64_t base = 0);
+    // Adds importing and exporting Intel HEX and S-record files, base being the address of the first
+    // byte in the files. Exports cover the selection or the whole memory, in the format of the extension.
+    MemoryEditorWindow& hex_files(uint64_t base = 0);
+    // Adds a column beside the rows colored by entropy, zero/0xFF fill or printable bytes, refreshed every
+    // interval seconds for the blocks that changed, and a line with the min, max, sum and set bits of the selection
+    MemoryEditorWindow& minimap(double interval = 1.0);
+    // Shows width x height pixels from offset as an image in a window of its own, the format, offset and
+    // size being adjustable there. Only the rows whose bytes changed are converted and uploaded again,
+    // and clicking a pixel highlights its bytes in the editor.
+    MemoryEditorWindow& bitmap(const char *text, PixelFormat format, size_t offset, int width, int height, Size size = {}, Position position = {});
+
+private:
+    struct impl;
+    std::unique_ptr<impl> pimpl_;
+};
+
+// Two memories side by side in one scrolled view, with differing bytes highlighted. Differences are
+// indexed as ranges, for jumping between them and marking them next to the scrollbar, and the index
+// is only updated where one side changed.
+class MemoryDiffWindow
+{
+public:
+    MemoryDiffWindow(const char* text, const uint8_t *a, size_t a_size, const uint8_t *b, size_t b_size, Size size = {}, Position position = {});
+    // Compares bytes with a file, e.g. a reference dump
+    MemoryDiffWindow(const char* text, const uint8_t *bytes, size_t bytes_size, const char *path, Size size = {}, Position position = {});
+    ~MemoryDiffWindow();
+    MemoryDiffWindow(MemoryDiffWindow const& rhs);
+    void draw() const;
+
+    // Diffs the lines in view again every interval seconds, 0.5 by default. The rest is diffed once,
+    // and again when Rescan is clicked or after mark_changed().
+    MemoryDiffWindow& interval(double seconds);
+    // Diffs [begin, end) again at the next draw, from any thread, after either side was written
+    // there. Once used, the lines in view are no longer diffed every interval. Copies of the window
+    // share the marks.
+    MemoryDiffWindow& mark_changed(size_t begin, size_t end);
+
+private:
+    struct impl;
+    std::unique_ptr<impl> pimpl_;
+};
+
+// Table of expressions over bound memories, compiled once to bytecode and evaluated every frame.
+// u8(a), i8, u16le, u16be, i16le, ..., u64be, f32le, f32be, f64le and f64be read at an address of the
+// first memory bound, or of another as in u32le(eeprom, 0x100), and eeprom[a] reads a byte. Besides
+// the C operators there are bit(x, n), min, max, abs, int and float. u64 values compare and divide
+// unsigned as in C, and shift counts outside 0..63 fail the watch. Values can be plotted and logged.
+class WatchWindow
+{
+public:
+    WatchWindow(const char* text, Size size = {}, Position position = {});
+    ~WatchWindow();
+    WatchWindow(WatchWindow const& rhs);
+    void draw() const;
+
+    // bytes must outlive the window
+    WatchWindow& bind(const char *name, const uint8_t *bytes, size_t size);
+    WatchWindow& bind(const char *name, std::shared_ptr<MemoryProvider> provider);
+    // Adds a watch, more can be typed in the window. Expressions that do not compile show the error.
+    WatchWindow& watch(const char *expression, bool plot = false);
+    // Lets watches log their changes to channel, with a Log checkbox per watch
+    WatchWindow& log(LogChannel channel);
+
+private:
+    struct impl;
+    std::unique_ptr<impl> pimpl_;
+};
+
+// View of contiguous elements, until std::span is available
+template <typename T>
+class Span
+{
+public:
+    Span() = default;
+    Span(T *data, size_t size) : data_{data}, size_{size} {}
+
+    T* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    T* begin() const { return data_; }
+    T* end() const { return data_ + size_; }
+    T& operator[](size_t i) const { return data_[i]; }
+    Span subspan(size_t offset, size_t count) const { return Span{data_ + offset, count}; }
+
+private:
+    T *data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Flash-like memory of equally sized sectors, all in one cache line aligned allocation so that
+// whole-device operations are single passes over contiguous memory.
+class SectorStore
+{
+public:
+    SectorStore(size_t sector_count, size_t sector_size, uint8_t erased_value = 0xFF);
+    ~SectorStore();
+    SectorStore(SectorStore const&) = delete;
+    SectorStore& operator=(SectorStore const&) = delete;
+
+    size_t sector_count() const { return sector_count_; }
+    size_t sector_size() const { return sector_size_; }
+    size_t size() const { return sector_count_ * sector_size_; }
+    uint8_t erased_value() const { return erased_value_; }
+
+    Span<uint8_t> bytes() { return {data_, size()}; }
+    Span<const uint8_t> bytes() const { return {data_, size()}; }
+    Span<uint8_t> sector(size_t index) { return {data_ + index * sector_size_, sector_size_}; }
+    Span<const uint8_t> sector(size_t index) const { return {data_ + index * sector_size_, sector_size_}; }
+    uint8_t& at(size_t sector, size_t offset) { return data_[sector * sector_size_ + offset]; }
+
+    void erase(size_t sector);
+    void erase_all();
+
+private:
+    uint8_t *data_;
+    size_t sector_count_;
+    size_t sector_size_;
+    uint8_t erased_value_;
+};
+
+// Sector memory that only allocates the pages written to. Unwritten and erased pages all read
+// from one shared erased page, so a mostly empty device costs little more than its page table.
+class SparseSectorStore
+{
+public:
+    SparseSectorStore(size_t sector_count, size_t sector_size, uint8_t erased_value = 0xFF);
+    SparseSectorStore(SparseSectorStore const&) = delete;
+    SparseSectorStore& operator=(SparseSectorStore const&) = delete;
+
+    size_t sector_count() const { return sector_count_; }
+    size_t sector_size() const { return sector_size_; }
+    size_t size() const { return sector_count_ * sector_size_; }
+    uint8_t erased_value() const { return erased_value_; }
+
+    // Pages are 4 KiB, or one sector when sectors are smaller or not a multiple of it
+    size_t page_size() const { return page_size_; }
+    size_t page_count() const { return pages_.size(); }
+    bool is_allocated(size_t page) const { return pages_[page] != nullptr; }
+    // Bytes of a page, the shared erased page if it was never written
+    Span<const uint8_t> page(size_t index) const;
+    size_t allocated_bytes() const { return allocated_pages_ * page_size_; }
+    // Counts the writes to and erases of a sector, readers compare it with the count they last saw
+    // to find the sectors changed since
+    uint32_t write_count(size_t sector) const { return write_counts_[sector]; }
+
+    void read(size_t offset, uint8_t *out, size_t size) const;
+    void write(size_t offset, const uint8_t *in, size_t size);
+    uint8_t get(size_t sector, size_t offset) const;
+    void set(size_t sector, size_t offset, uint8_t value);
+
+    // Releases the pages of the sector
+    void erase(size_t sector);
+    void erase_all();
+
+private:
+    uint8_t* writable_page(size_t index);
+
+    size_t sector_count_;
+    size_t sector_size_;
+    size_t page_size_;
+    uint8_t erased_value_;
+    std::vector<std::unique_ptr<uint8_t[]>> pages_;
+    std::vector<uint8_t> erased_page_;
+    std::vector<uint32_t> write_counts_;
+    size_t allocated_pages_ = 0;
+};
+
+enum class HexFormat { intel, srecord };
+
+// Reads Intel HEX and Motorola S-record files in one pass over a mapping of the file. Hex digits
+// are decoded 16 at a time and the checksum of every record is verified, the first bad record
+// stops the read. Addresses are those of the file, memories are loaded from their base address.
+class HexReader
+{
+public:
+    // Called with runs of consecutive data bytes, records joined when they follow each other
+    using DataFn = std::function<void(uint64_t address, const uint8_t *bytes, size_t size)>;
+
+    // Throws -1 when the file cannot be opened or is in neither format
+    explicit HexReader(const char *path);
+    ~HexReader();
+    HexReader(HexReader const&) = delete;
+    HexReader& operator=(HexReader const&) = delete;
+
+    HexFormat format() const;
+
+    // Each read checks the whole file first and returns false, without passing on any data, when
+    // a record is bad or the end record is missing
+    bool read(DataFn const& f);
+    // Data outside [base, base + size) is left out and counted in skipped()
+    bool read(uint8_t *bytes, size_t size, uint64_t base = 0);
+    bool read(SectorStore &store, uint64_t base = 0);
+    bool read(SparseSectorStore &store, uint64_t base = 0);
+
+    // Line of the bad record and what is wrong with it, after a failed read
+    size_t error_line() const;
+    const char* error() const;
+    // Data bytes of the last read, and those of them outside the memory
+    uint64_t bytes_read() const;
+    uint64_t skipped() const;
+    // Execution start address of the file, when it has one
+    bool has_start_address() const;
+    uint64_t start_address() const;
+
+private:
+    struct impl;
+    std::unique_ptr<impl> pimpl_;
+};
+
+// Writes Intel HEX or S-record files through a buffer. Intel files get extended linear address
+// records where the upper 16 bits change, S-records the shortest address that fits each record.
+class HexWriter
+{
+public:
+    // Throws -1 when the file cannot be created. Records hold at most record_size data bytes.
+    HexWriter(const char *path, HexFormat format, size_t record_size = 32);
+    // Finishes the file if finish() was not called
+    ~HexWriter();
+    HexWriter(HexWriter const&) = delete;
+    HexWriter& operator=(HexWriter const&) = delete;
+
+    // Records whose bytes all equal value are left out, e.g. erased flash
+    HexWriter& skip(uint8_t value);
+    HexWriter& start_address(uint64_t address);
+
+    // Returns false when the addresses do not fit the format or the file cannot be written
+    bool write(uint64_t address, const uint8_t *bytes, size_t size);
+    // Stores are written from base, without their erased records
+    bool write(SectorStore const& store, uint64_t base = 0);
+    bool write(SparseSectorStore const& store, uint64_t base = 0);
+    // Writes the end record and closes the file, false when any write failed
+    bool finish();
+
+private:
+    struct impl;
+    std::unique_ptr<impl> pimpl_;
+};
+
+// Why PersistentMemory::load() did or did not fill the memory
+enum class LoadResult { loaded, missing, wrong_size, failed };
+
+// Keeps emulated memories in a file. Writes mark their pages in a dirty bitmap, and save() hands
+// a copy of only the dirty pages to a background saver. The saver writes them to a journal first
+// and then into the file, so a crash leaves either the old or the new state.
+// The regions are stored one after the other and must keep their size.
+class PersistentMemory
+{
+public:
+    PersistentMemory(const char *path, uint8_t *bytes, size_t size, size_t page_size = 4096);
+    PersistentMemory(const char *path, std::vector<std::vector<uint8_t>> &sectors, size_t page_size = 4096);
+    PersistentMemory(const char *path, SectorStore &store, size_t page_size = 4096);
+    ~PersistentMemory();
+    PersistentMemory(PersistentMemory const&) = delete;
+    PersistentMemory& operator=(PersistentMemory const&) = delete;
+
+    // Reads the file into the memory, completing an interrupted save first. Unless it returns
+    // loaded the first save writes everything, resizing a file of the wrong size.
+    LoadResult load();
+
+    // Marks bytes written by the application, from any thread, after writing them
+    void mark_dirty(size_t offset, size_t size);
+    void mark_dirty(size_t region, size_t offset, size_t size);
+
+    // Copies the dirty pages and returns, the saver writes them in the background
+    void save();
+    // Blocks until all saves are written
+    void wait();
+    bool saving() const;
+    // A failed save marks its pages dirty again
+    bool failed() const;
+    size_t dirty_pages() const;
+
+    size_t size() const;
+    size_t page_size() const;
+
 private:
     struct impl;
     std::unique_ptr<impl> pimpl_;
@@ -341,10 +975,36 @@ class SectorMemoryEditorWindow
 {
 public:
     SectorMemoryEditorWindow(const char* text, std::vector<std::vector<uint8_t>> &sectors, int &current_sector, Size size = {}, Position position = {});
+    // Also offers a linear view of the whole device
+    SectorMemoryEditorWindow(const char* text, SectorStore &store, int &current_sector, Size size = {}, Position position = {});
+    SectorMemoryEditorWindow(const char* text, SparseSectorStore &store, int &current_sector, Size size = {}, Position position = {});
     ~SectorMemoryEditorWindow();
     SectorMemoryEditorWindow(SectorMemoryEditorWindow const& rhs);
     void draw() const;
 
+    // Same as for MemoryEditorWindow, every sector is compared to its own shadow copy
+    SectorMemoryEditorWindow& heatmap(double decay = 2.0, double interval = 0.0);
+    SectorMemoryEditorWindow& watch(int sector, size_t offset, size_t size, MemoryWatchFn f);
+    SectorMemoryEditorWindow& watch(const char *name, int sector, size_t offset, size_t size, LogChannel channel);
+    // Grid of all sectors in its own window, showing which are erased, their fill and checksum, and which
+    // changed since the last snapshot. Sectors changed since the last pass are summarized in the background
+    // every interval seconds, clicking a cell selects the sector.
+    SectorMemoryEditorWindow& overview(const char *text, double interval = 0.5, Size size = {}, Position position = {});
+    // Summarizes the sector again at the next pass, from any thread, after it was written. Once used,
+    // the sectors of vectors and stores are only summarized again when marked or edited in the window,
+    // those of a sparse store are followed through its write counts anyway. Copies share the marks.
+    SectorMemoryEditorWindow& mark_changed(int sector);
+    // Marks the pages edited in the window dirty, memory must hold the same sectors or store
+    SectorMemoryEditorWindow& persist(PersistentMemory &memory);
+    // Adds a CRC/checksum line for the sector shown, or the whole device, updated in the background
+    SectorMemoryEditorWindow& checksums();
+    // Same as for MemoryEditorWindow, base is the address of the first byte of the device or the first sector.
+    // Going to a symbol of a store switches to its sector.
+    SectorMemoryEditorWindow& symbols(SymbolTable const& table, uint64_t base = 0);
+    // Same as for MemoryEditorWindow, for the whole device of a store or the sector shown. Erased records
+    // are not exported.
+    SectorMemoryEditorWindow& hex_files(uint64_t base = 0);
+
 private:
     struct impl;
     std::unique_ptr<impl> pimpl_;
@@ -356,8 +1016,11 @@ public:
     Application(Size size, const char *title, Size log_size = Size{500,400}, Position log_position = {}) : 
         size_{size}, 
         title_(title), 
-        log_{"Log", log_size, log_position}
-    {}
+        log_{"Log", log_size, log_position},
+        channels_{LogChannel{"main"}}
+    {
+        log_.add_channel(channels_.front());
+    }
 
     void init(const uint8_t *font_data = nullptr, size_t font_data_size = 0, float font_size = 13.0) {
         ctx_ = backend_init(size_.width, size_.height, title_, font_data, font_data_size, font_size);
@@ -371,19 +1034,33 @@ public:
     template <typename... Args>
     void info(Args&&... args)
     {
-        log("info", std::forward<Args>(args)...);
+        channels_.front().info(std::forward<Args>(args)...);
     }
 
     template <typename... Args>
     void warn(Args&&... args)
     {
-        log("warning", std::forward<Args>(args)...);
+        channels_.front().warn(std::forward<Args>(args)...);
     }
 
     template <typename... Args>
     void error(Args&&... args)
     {
-        log("error", std::forward<Args>(args)...);
+        channels_.front().error(std::forward<Args>(args)...);
+    }
+
+    // Returns the named log channel, creating it on first use. Every channel is shown
+    // merged in the "Log" window; add a LogWindow bound to it for a dedicated view.
+    LogChannel channel(const char *name, size_t max_lines = 10000)
+    {
+        for (auto &c : channels_) {
+            if (std::string_view{c.name()} == name) {
+                return c;
+            }
+        }
+        channels_.emplace_back(name, max_lines);
+        log_.add_channel(channels_.back());
+        return channels_.back();
     }
 
     bool should_run() {
@@ -409,16 +1086,9 @@ private:
     Size size_;
     const char *title_;
     LogWindow log_;
+    std::vector<LogChannel> channels_;
     BackendContext ctx_;
     std::vector<Widget> widgets_;
-
-    template <typename... Args>
-    void log(std::string_view tag, std::string_view format_str, Args&&... args)
-    {
-        auto now = std::chrono::system_clock::now();
-        auto result = fmt::format("{:%Y-%m-%d %H:%M:%S} {}: {}\n", now, tag, fmt::format(format_str, std::forward<Args>(args)...));
-        log_.add_log(result.c_str());
-    }
 };
 
 }
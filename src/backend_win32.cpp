@@ -140,6 +140,34 @@ auto backend_load_texture(const uint8_t *data, size_t size, int *width, int *hei
     return backend_load_texture(stbi_load_from_memory(data, size, width, height, NULL, 4), width, height);
 }
 
+auto backend_create_texture(int width, int height) -> BackendTexture
+{
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    return BackendTexture{texture};
+}
+
+void backend_update_texture(BackendTexture texture, int y, int width, int rows, const uint8_t *rgba)
+{
+    glBindTexture(GL_TEXTURE_2D, texture.id);
+#if defined(GL_UNPACK_ROW_LENGTH) && !defined(__EMSCRIPTEN__)
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+#endif
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y, width, rows, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+}
+
+void backend_free_texture(BackendTexture texture)
+{
+    GLuint id = texture.id;
+    glDeleteTextures(1, &id);
+}
+
 static void framebuffer_size_callback(GLFWwindow *window, int width, int height)
 {
     glViewport(0, 0, width, height);
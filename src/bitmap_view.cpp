@@ -0,0 +1,281 @@
+#include "bitmap_view.h"
+#include "imgui.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GUICPP_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace guicpp
+{
+
+namespace
+{
+
+size_t pixel_bytes(PixelFormat format)
+{
+    switch (format) {
+    case PixelFormat::rgb565:
+        return 2;
+    case PixelFormat::rgba8:
+        return 4;
+    default:
+        return 1;
+    }
+}
+
+void store_pixel(uint8_t *out, uint8_t r, uint8_t g, uint8_t b)
+{
+    out[0] = r;
+    out[1] = g;
+    out[2] = b;
+    out[3] = 0xFF;
+}
+
+#ifdef GUICPP_SSE2
+// Repeats each of 16 gray bytes into an opaque pixel
+void store_gray(__m128i g, uint8_t *out)
+{
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    const __m128i lo = _mm_unpacklo_epi8(g, g);
+    const __m128i hi = _mm_unpackhi_epi8(g, g);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_or_si128(_mm_unpacklo_epi16(lo, lo), alpha));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_or_si128(_mm_unpackhi_epi16(lo, lo), alpha));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 32), _mm_or_si128(_mm_unpacklo_epi16(hi, hi), alpha));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 48), _mm_or_si128(_mm_unpackhi_epi16(hi, hi), alpha));
+}
+#endif
+
+}
+
+size_t row_bytes(PixelFormat format, int width)
+{
+    const size_t w = static_cast<size_t>(std::max(width, 0));
+    return format == PixelFormat::mono1 ? (w + 7) / 8 : w * pixel_bytes(format);
+}
+
+void convert_pixels(PixelFormat format, const uint8_t *in, size_t count, uint8_t *rgba)
+{
+    size_t i = 0;
+    switch (format) {
+    case PixelFormat::gray8:
+#ifdef GUICPP_SSE2
+        for (; i + 16 <= count; i += 16) {
+            store_gray(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), rgba + i * 4);
+        }
+#endif
+        for (; i < count; i++) {
+            store_pixel(rgba + i * 4, in[i], in[i], in[i]);
+        }
+        break;
+    case PixelFormat::rgb565:
+#ifdef GUICPP_SSE2
+        // Channels widened by repeating their high bits, then red and green interleaved with blue and alpha
+        for (; i + 8 <= count; i += 8) {
+            const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 2));
+            const __m128i r = _mm_srli_epi16(p, 11);
+            const __m128i g = _mm_and_si128(_mm_srli_epi16(p, 5), _mm_set1_epi16(0x3F));
+            const __m128i b = _mm_and_si128(p, _mm_set1_epi16(0x1F));
+            const __m128i r8 = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+            const __m128i g8 = _mm_or_si128(_mm_slli_epi16(g, 2), _mm_srli_epi16(g, 4));
+            const __m128i b8 = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+            const __m128i rg = _mm_or_si128(r8, _mm_slli_epi16(g8, 8));
+            const __m128i ba = _mm_or_si128(b8, _mm_set1_epi16(static_cast<short>(0xFF00)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + i * 4), _mm_unpacklo_epi16(rg, ba));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + i * 4 + 16), _mm_unpackhi_epi16(rg, ba));
+        }
+#endif
+        for (; i < count; i++) {
+            const unsigned p = in[i * 2] | in[i * 2 + 1] << 8;
+            const unsigned r = p >> 11;
+            const unsigned g = p >> 5 & 0x3F;
+            const unsigned b = p & 0x1F;
+            store_pixel(rgba + i * 4, static_cast<uint8_t>(r << 3 | r >> 2), static_cast<uint8_t>(g << 2 | g >> 4), static_cast<uint8_t>(b << 3 | b >> 2));
+        }
+        break;
+    case PixelFormat::rgba8:
+#ifdef GUICPP_SSE2
+        for (; i + 4 <= count; i += 4) {
+            const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 4));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + i * 4), _mm_or_si128(p, _mm_set1_epi32(static_cast<int>(0xFF000000u))));
+        }
+#endif
+        for (; i < count; i++) {
+            store_pixel(rgba + i * 4, in[i * 4], in[i * 4 + 1], in[i * 4 + 2]);
+        }
+        break;
+    case PixelFormat::mono1:
+#ifdef GUICPP_SSE2
+        // Two bytes spread over the lanes, a lane per bit, set bits becoming 0xFF
+        for (; i + 16 <= count; i += 16) {
+            const __m128i bits = _mm_set_epi8(1, 2, 4, 8, 16, 32, 64, static_cast<char>(128), 1, 2, 4, 8, 16, 32, 64, static_cast<char>(128));
+            __m128i v = _mm_cvtsi32_si128(in[i / 8] | in[i / 8 + 1] << 8);
+            v = _mm_unpacklo_epi8(v, v);
+            v = _mm_unpacklo_epi16(v, v);
+            v = _mm_unpacklo_epi32(v, v);
+            store_gray(_mm_cmpeq_epi8(_mm_and_si128(v, bits), bits), rgba + i * 4);
+        }
+#endif
+        for (; i < count; i++) {
+            const uint8_t v = (in[i / 8] >> (7 - i % 8) & 1) != 0 ? 0xFF : 0;
+            store_pixel(rgba + i * 4, v, v, v);
+        }
+        break;
+    }
+}
+
+BitmapView::BitmapView(PixelFormat format, size_t offset, int width, int height) :
+    format_{format},
+    offset_{offset},
+    width_{std::min(std::max(width, 1), max_side)},
+    height_{std::min(std::max(height, 1), max_side)}
+{}
+
+BitmapView::~BitmapView()
+{
+    if (texture_.id != 0) {
+        backend_free_texture(texture_);
+    }
+}
+
+BitmapView::BitmapView(BitmapView const& rhs) :
+    format_{rhs.format_},
+    offset_{rhs.offset_},
+    width_{rhs.width_},
+    height_{rhs.height_},
+    zoom_{rhs.zoom_}
+{}
+
+BitmapView::BitmapView(BitmapView &&rhs) noexcept :
+    format_{rhs.format_},
+    offset_{rhs.offset_},
+    width_{rhs.width_},
+    height_{rhs.height_},
+    zoom_{rhs.zoom_},
+    texture_{rhs.texture_},
+    texture_width_{rhs.texture_width_},
+    texture_height_{rhs.texture_height_},
+    converted_{rhs.converted_},
+    rows_updated_{rhs.rows_updated_},
+    previous_{std::move(rhs.previous_)}
+{
+    rhs.texture_.id = 0;
+    rhs.converted_ = false;
+}
+
+// Rows past the end of memory are converted from zeros
+void BitmapView::update(const uint8_t *bytes, size_t size)
+{
+    if (texture_.id == 0 || texture_width_ != width_ || texture_height_ != height_) {
+        if (texture_.id != 0) {
+            backend_free_texture(texture_);
+        }
+        texture_ = backend_create_texture(width_, height_);
+        texture_width_ = width_;
+        texture_height_ = height_;
+        converted_ = false;
+    }
+    const size_t stride = row_bytes(format_, width_);
+    if (!converted_) {
+        previous_.assign(stride * height_, 0);
+    }
+    rows_updated_ = 0;
+    for (int y = 0; y < height_; y++) {
+        const size_t at = y * stride;
+        const uint8_t *row = bytes + std::min(at, size);
+        if (at + stride > size) {
+            row_.assign(stride, 0);
+            if (at < size) {
+                std::memcpy(row_.data(), bytes + at, size - at);
+            }
+            row = row_.data();
+        }
+        if (converted_ && std::memcmp(row, previous_.data() + at, stride) == 0) {
+            upload(y);
+            continue;
+        }
+        std::memcpy(previous_.data() + at, row, stride);
+        if (run_begin_ < 0) {
+            run_begin_ = y;
+        }
+        const size_t n = rgba_.size();
+        rgba_.resize(n + static_cast<size_t>(width_) * 4);
+        convert_pixels(format_, row, width_, rgba_.data() + n);
+        rows_updated_++;
+    }
+    upload(height_);
+    converted_ = true;
+}
+
+// Uploads the rows changed from run_begin_ up to y
+void BitmapView::upload(int y)
+{
+    if (run_begin_ < 0) {
+        return;
+    }
+    backend_update_texture(texture_, run_begin_, width_, y - run_begin_, rgba_.data());
+    rgba_.clear();
+    run_begin_ = -1;
+}
+
+bool BitmapView::draw(size_t &begin, size_t &end)
+{
+    static const char *formats[] = {"Gray 8", "RGB565", "RGBA8", "1 bpp"};
+    const float digit_width = ImGui::CalcTextSize("0").x;
+    bool changed = false;
+
+    int format = static_cast<int>(format_);
+    ImGui::SetNextItemWidth(ImGui::CalcTextSize("RGB565").x + ImGui::GetFrameHeight() + ImGui::GetStyle().FramePadding.x * 2.0f);
+    if (ImGui::Combo("##format", &format, formats, IM_ARRAYSIZE(formats))) {
+        format_ = static_cast<PixelFormat>(format);
+        changed = true;
+    }
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(digit_width * 12);
+    changed |= ImGui::InputScalar("##offset", ImGuiDataType_U64, &offset_, nullptr, nullptr, "%llX", ImGuiInputTextFlags_CharsHexadecimal);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(digit_width * 10);
+    changed |= ImGui::InputInt("##width", &width_);
+    ImGui::SameLine();
+    ImGui::TextUnformatted("x");
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(digit_width * 10);
+    changed |= ImGui::InputInt("##height", &height_);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(digit_width * 12);
+    ImGui::SliderInt("##zoom", &zoom_, 1, 8, "%dx");
+    ImGui::SameLine();
+    ImGui::TextDisabled("%d rows updated", rows_updated_);
+    if (changed) {
+        width_ = std::min(std::max(width_, 1), max_side);
+        height_ = std::min(std::max(height_, 1), max_side);
+        converted_ = false;
+    }
+
+    bool clicked = false;
+    ImGui::BeginChild("##pixels", ImVec2(0, 0), false, ImGuiWindowFlags_HorizontalScrollbar);
+    if (texture_.id != 0) {
+        const float zoom = static_cast<float>(zoom_);
+        ImGui::Image((void*)(intptr_t)texture_.id, ImVec2(texture_width_ * zoom, texture_height_ * zoom));
+        if (ImGui::IsItemHovered()) {
+            const ImVec2 min = ImGui::GetItemRectMin();
+            const ImVec2 mouse = ImGui::GetMousePos();
+            const int x = std::min(std::max(static_cast<int>((mouse.x - min.x) / zoom), 0), texture_width_ - 1);
+            const int y = std::min(std::max(static_cast<int>((mouse.y - min.y) / zoom), 0), texture_height_ - 1);
+            const size_t stride = row_bytes(format_, texture_width_);
+            const size_t at = offset() + y * stride + (format_ == PixelFormat::mono1 ? x / 8 : x * pixel_bytes(format_));
+            ImGui::SetTooltip("%d, %d at %zX", x, y, at);
+            if (ImGui::IsItemClicked()) {
+                begin = at;
+                end = at + pixel_bytes(format_);
+                clicked = true;
+            }
+        }
+    }
+    ImGui::EndChild();
+    return clicked;
+}
+
+}
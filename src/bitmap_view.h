@@ -0,0 +1,59 @@
+#pragma once
+#include <gui/gui.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace guicpp
+{
+
+// Bytes of a row of width pixels
+size_t row_bytes(PixelFormat format, int width);
+// Converts count pixels to opaque RGBA a register at a time. mono1 reads (count + 7) / 8 bytes.
+void convert_pixels(PixelFormat format, const uint8_t *in, size_t count, uint8_t *rgba);
+
+// Pixels of memory in a texture. Each update compares the rows with the bytes converted last time
+// and uploads the runs of rows that changed, so a still framebuffer costs a compare per frame.
+class BitmapView
+{
+public:
+    // Largest width and height, textures of this size are supported everywhere
+    static constexpr int max_side = 4096;
+
+    BitmapView(PixelFormat format, size_t offset, int width, int height);
+    ~BitmapView();
+    // Copies the settings, the copy creates a texture of its own when updated
+    BitmapView(BitmapView const& rhs);
+    BitmapView(BitmapView &&rhs) noexcept;
+    BitmapView& operator=(BitmapView const&) = delete;
+
+    size_t offset() const { return static_cast<size_t>(offset_); }
+    // Bytes shown from the offset
+    size_t size() const { return row_bytes(format_, width_) * height_; }
+
+    // bytes holds the memory from the offset on, size may be short of the bitmap at the end of memory
+    void update(const uint8_t *bytes, size_t size);
+    // Settings and image. Returns true with the bytes of the pixel in [begin, end) when one was clicked.
+    bool draw(size_t &begin, size_t &end);
+
+private:
+    void upload(int y);
+
+    PixelFormat format_;
+    uint64_t offset_;
+    int width_;
+    int height_;
+    int zoom_ = 2;
+    BackendTexture texture_{0};
+    int texture_width_ = 0;
+    int texture_height_ = 0;
+    bool converted_ = false;
+    int rows_updated_ = 0;
+    std::vector<uint8_t> previous_;
+    std::vector<uint8_t> row_;
+    // Pixels of the rows changed since run_begin_
+    std::vector<uint8_t> rgba_;
+    int run_begin_ = -1;
+};
+
+}
@@ -0,0 +1,138 @@
+#include "change_tracker.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GUICPP_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace guicpp
+{
+
+static constexpr float never_changed = -1e30f;
+
+void ChangeTracker::add_watch(size_t offset, size_t size, WatchFn f)
+{
+    watches_.push_back(Watch{offset, size, std::move(f)});
+}
+
+// Records the differing bytes of [begin, end) as spans, merging with the previous span when adjacent
+void ChangeTracker::scan(const uint8_t *bytes, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++) {
+        if (bytes[i] == shadow_[i]) {
+            continue;
+        }
+        if (!spans_.empty() && spans_.back().end == i) {
+            spans_.back().end = i + 1;
+        } else {
+            spans_.push_back(Span{i, i + 1});
+        }
+    }
+}
+
+// Compares 64 bytes per step and only looks at single bytes in blocks that differ,
+// unchanged memory costs four loads and an or per cache line.
+void ChangeTracker::diff(const uint8_t *bytes, size_t size)
+{
+    spans_.clear();
+    const uint8_t *shadow = shadow_.data();
+    size_t i = 0;
+#ifdef GUICPP_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 64 <= size; i += 64) {
+        __m128i d0 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(shadow + i)));
+        __m128i d1 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i + 16)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(shadow + i + 16)));
+        __m128i d2 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i + 32)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(shadow + i + 32)));
+        __m128i d3 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i + 48)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(shadow + i + 48)));
+        __m128i any = _mm_or_si128(_mm_or_si128(d0, d1), _mm_or_si128(d2, d3));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(any, zero)) != 0xFFFF) {
+            scan(bytes, i, i + 64);
+        }
+    }
+#endif
+    for (; i + 8 <= size; i += 8) {
+        uint64_t a, b;
+        std::memcpy(&a, bytes + i, 8);
+        std::memcpy(&b, shadow + i, 8);
+        if (a != b) {
+            scan(bytes, i, i + 8);
+        }
+    }
+    scan(bytes, i, size);
+}
+
+void ChangeTracker::update(const uint8_t *bytes, size_t size, double now)
+{
+    if (!initialized_ || size != shadow_.size()) {
+        shadow_.assign(bytes, bytes + size);
+        changed_at_.clear();
+        last_update_ = now;
+        changed_ = 0;
+        initialized_ = true;
+        return;
+    }
+    if (!due(now)) {
+        return;
+    }
+    last_update_ = now;
+    diff(bytes, size);
+
+    changed_ = 0;
+    for (auto const& span : spans_) {
+        changed_ += span.end - span.begin;
+    }
+    if (changed_ == 0) {
+        return;
+    }
+
+    for (auto const& watch : watches_) {
+        auto it = std::lower_bound(spans_.begin(), spans_.end(), watch.offset, [](Span const& span, size_t offset) {
+            return span.end <= offset;
+        });
+        if (it != spans_.end() && it->begin < watch.offset + watch.size && watch.offset < size) {
+            size_t watch_size = std::min(watch.size, size - watch.offset);
+            watch.f(watch.offset, watch_size, shadow_.data() + watch.offset, bytes + watch.offset);
+        }
+    }
+
+    if (decay_ > 0.0 && changed_at_.size() != size) {
+        changed_at_.assign(size, never_changed);
+    }
+    for (auto const& span : spans_) {
+        std::memcpy(shadow_.data() + span.begin, bytes + span.begin, span.end - span.begin);
+        if (decay_ > 0.0) {
+            std::fill(changed_at_.begin() + span.begin, changed_at_.begin() + span.end, static_cast<float>(now));
+        }
+    }
+}
+
+void ChangeTracker::heat(size_t offset, float *out, size_t size, double now) const
+{
+    for (size_t i = 0; i < size; i++) {
+        size_t addr = offset + i;
+        if (addr >= changed_at_.size() || decay_ <= 0.0) {
+            out[i] = 0.0f;
+            continue;
+        }
+        double age = now - changed_at_[addr];
+        out[i] = age < decay_ ? static_cast<float>(1.0 - age / decay_) : 0.0f;
+    }
+}
+
+MemoryWatchFn log_watch(const char *name, LogChannel channel)
+{
+    return [name, channel](size_t offset, size_t size, const uint8_t *before, const uint8_t *after) mutable {
+        constexpr size_t max_logged = 16;
+        std::string old_bytes, new_bytes;
+        for (size_t i = 0; i < std::min(size, max_logged); i++) {
+            old_bytes += fmt::format("{:02X}", before[i]);
+            new_bytes += fmt::format("{:02X}", after[i]);
+        }
+        const char *more = size > max_logged ? "..." : "";
+        channel.info("{} changed at 0x{:X}: {}{} -> {}{}", name, offset, old_bytes, more, new_bytes, more);
+    };
+}
+
+}
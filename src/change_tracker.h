@@ -0,0 +1,69 @@
+#pragma once
+#include <gui/gui.h>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace guicpp
+{
+
+// Finds the bytes of a buffer that changed since the last update by comparing it against a shadow
+// copy. Remembers when each byte last changed, for heatmaps, and reports changes in watched ranges.
+class ChangeTracker
+{
+public:
+    using WatchFn = std::function<void(size_t offset, size_t size, const uint8_t *before, const uint8_t *after)>;
+
+    struct Span
+    {
+        size_t begin;
+        size_t end;
+    };
+
+    // Seconds a change stays visible in heat(), 0 (the default) does not keep per-byte change times
+    void set_decay(double seconds) { decay_ = seconds; }
+    // Minimum seconds between two diffs, 0 diffs on every update
+    void set_interval(double seconds) { interval_ = seconds; }
+    void add_watch(size_t offset, size_t size, WatchFn f);
+
+    // Whether update() would diff at now, to skip preparing the bytes otherwise
+    bool due(double now) const { return !initialized_ || now - last_update_ >= interval_; }
+    // Diffs bytes against the shadow copy. A new size resets the shadow without reporting changes.
+    void update(const uint8_t *bytes, size_t size, double now);
+    // Fills out with 1 for bytes changed at now, fading to 0 after the decay time
+    void heat(size_t offset, float *out, size_t size, double now) const;
+    // Bytes changed at the last diff
+    size_t changed() const { return changed_; }
+    // Ranges changed at the last diff, sorted
+    std::vector<Span> const& changes() const { return spans_; }
+    // Copy of the bytes as of the last diff
+    const uint8_t* shadow() const { return shadow_.data(); }
+
+private:
+
+    struct Watch
+    {
+        size_t offset;
+        size_t size;
+        WatchFn f;
+    };
+
+    void diff(const uint8_t *bytes, size_t size);
+    void scan(const uint8_t *bytes, size_t begin, size_t end);
+
+    std::vector<uint8_t> shadow_;
+    std::vector<float> changed_at_;
+    std::vector<Span> spans_;
+    std::vector<Watch> watches_;
+    double decay_ = 0.0;
+    double interval_ = 0.0;
+    double last_update_ = 0.0;
+    size_t changed_ = 0;
+    bool initialized_ = false;
+};
+
+// Watch callback logging the old and new bytes of the range to channel
+MemoryWatchFn log_watch(const char *name, LogChannel channel);
+
+}
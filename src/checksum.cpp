@@ -0,0 +1,728 @@
+#include "checksum.h"
+#include "imgui.h"
+#include <algorithm>
+#include <cstring>
+#include <map>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GUICPP_SSE2
+#include <emmintrin.h>
+#endif
+
+// PCLMUL and SSE4.2 are only used after checking the CPU, so the file builds for plain x86
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define GUICPP_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#define GUICPP_TARGET(features)
+#else
+#include <cpuid.h>
+#include <immintrin.h>
+#define GUICPP_TARGET(features) __attribute__((target(features)))
+#endif
+#endif
+
+namespace guicpp
+{
+
+namespace
+{
+
+constexpr uint32_t crc32_poly = 0xEDB88320;  // reflected
+constexpr uint32_t crc32c_poly = 0x82F63B78; // reflected
+constexpr uint32_t crc16_poly = 0x1021;
+
+struct Tables
+{
+    uint32_t crc32[8][256];
+    uint32_t crc32c[8][256];
+    uint32_t crc16[8][256];
+    // x^(2^k) modulo the polynomial of each CRC, indexed by ChecksumKind
+    uint32_t powers[3][64];
+    bool clmul = false;
+    bool sse42 = false;
+};
+
+void make_reflected(uint32_t (&table)[8][256], uint32_t poly)
+{
+    for (uint32_t b = 0; b < 256; b++) {
+        uint32_t r = b;
+        for (int bit = 0; bit < 8; bit++) {
+            r = r & 1 ? (r >> 1) ^ poly : r >> 1;
+        }
+        table[0][b] = r;
+    }
+    for (int k = 1; k < 8; k++) {
+        for (uint32_t b = 0; b < 256; b++) {
+            table[k][b] = (table[k - 1][b] >> 8) ^ table[0][table[k - 1][b] & 0xFF];
+        }
+    }
+}
+
+void make_crc16(uint32_t (&table)[8][256])
+{
+    for (uint32_t b = 0; b < 256; b++) {
+        uint32_t r = b << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            r = r & 0x8000 ? ((r << 1) ^ crc16_poly) & 0xFFFF : r << 1;
+        }
+        table[0][b] = r;
+    }
+    for (int k = 1; k < 8; k++) {
+        for (uint32_t b = 0; b < 256; b++) {
+            table[k][b] = ((table[k - 1][b] << 8) & 0xFFFF) ^ table[0][table[k - 1][b] >> 8];
+        }
+    }
+}
+
+// Polynomial products modulo the CRC polynomial. Reflected CRCs keep x^0 in the top bit.
+uint32_t multiply_reflected(uint32_t a, uint32_t b, uint32_t poly)
+{
+    uint32_t p = 0;
+    for (uint32_t m = 1u << 31; m != 0; m >>= 1) {
+        if (a & m) {
+            p ^= b;
+        }
+        b = b & 1 ? (b >> 1) ^ poly : b >> 1;
+    }
+    return p;
+}
+
+uint32_t multiply_crc16(uint32_t a, uint32_t b)
+{
+    uint32_t p = 0;
+    for (int bit = 15; bit >= 0; bit--) {
+        p = p & 0x8000 ? ((p << 1) ^ crc16_poly) & 0xFFFF : p << 1;
+        if (a >> bit & 1) {
+            p ^= b;
+        }
+    }
+    return p;
+}
+
+uint32_t multiply(ChecksumKind kind, uint32_t a, uint32_t b)
+{
+    switch (kind) {
+    case ChecksumKind::crc16:
+        return multiply_crc16(a, b);
+    case ChecksumKind::crc32c:
+        return multiply_reflected(a, b, crc32c_poly);
+    default:
+        return multiply_reflected(a, b, crc32_poly);
+    }
+}
+
+uint32_t one(ChecksumKind kind)
+{
+    return kind == ChecksumKind::crc16 ? 1 : 1u << 31;
+}
+
+Tables make_tables()
+{
+    Tables t;
+    make_reflected(t.crc32, crc32_poly);
+    make_reflected(t.crc32c, crc32c_poly);
+    make_crc16(t.crc16);
+    for (ChecksumKind kind : {ChecksumKind::crc16, ChecksumKind::crc32, ChecksumKind::crc32c}) {
+        auto &powers = t.powers[static_cast<int>(kind)];
+        powers[0] = kind == ChecksumKind::crc16 ? 2 : 1u << 30;
+        for (int k = 1; k < 64; k++) {
+            powers[k] = multiply(kind, powers[k - 1], powers[k - 1]);
+        }
+    }
+#ifdef GUICPP_X86
+#ifdef _MSC_VER
+    int regs[4];
+    __cpuid(regs, 1);
+    unsigned ecx = static_cast<unsigned>(regs[2]);
+#else
+    unsigned eax, ebx, ecx = 0, edx;
+    __get_cpuid(1, &eax, &ebx, &ecx, &edx);
+#endif
+    t.clmul = (ecx & (1u << 1)) != 0 && (ecx & (1u << 19)) != 0;
+    t.sse42 = (ecx & (1u << 20)) != 0;
+#endif
+    return t;
+}
+
+Tables const& tables()
+{
+    static const Tables t = make_tables();
+    return t;
+}
+
+// x^bits modulo the polynomial of a CRC, what a CRC is multiplied by to append bits zero bits
+uint32_t power(ChecksumKind kind, uint64_t bits)
+{
+    auto const& powers = tables().powers[static_cast<int>(kind)];
+    uint32_t p = one(kind);
+    for (int k = 0; bits != 0; bits >>= 1, k++) {
+        if (bits & 1) {
+            p = multiply(kind, powers[k], p);
+        }
+    }
+    return p;
+}
+
+// Slice-by-8, eight table lookups per eight bytes
+uint32_t update_reflected(uint32_t const (&t)[8][256], uint32_t crc, const uint8_t *p, size_t n)
+{
+    for (; n >= 8; n -= 8, p += 8) {
+        uint32_t lo = crc ^ (p[0] | p[1] << 8 | p[2] << 16 | static_cast<uint32_t>(p[3]) << 24);
+        crc = t[7][lo & 0xFF] ^ t[6][lo >> 8 & 0xFF] ^ t[5][lo >> 16 & 0xFF] ^ t[4][lo >> 24] ^
+              t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+    }
+    for (; n > 0; n--) {
+        crc = t[0][(crc ^ *p++) & 0xFF] ^ crc >> 8;
+    }
+    return crc;
+}
+
+uint32_t update_crc16(uint32_t crc, const uint8_t *p, size_t n)
+{
+    auto const& t = tables().crc16;
+    for (; n >= 8; n -= 8, p += 8) {
+        crc ^= static_cast<uint32_t>(p[0]) << 8 | p[1];
+        crc = t[7][crc >> 8] ^ t[6][crc & 0xFF] ^ t[5][p[2]] ^ t[4][p[3]] ^
+              t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+    }
+    for (; n > 0; n--) {
+        crc = ((crc << 8) & 0xFFFF) ^ t[0][(crc >> 8) ^ *p++];
+    }
+    return crc;
+}
+
+#ifdef GUICPP_X86
+// Folds four 128-bit lanes at a time with carry-less multiplies, then reduces them to 32 bits
+// (Gopal et al., "Fast CRC computation for generic polynomials using PCLMULQDQ"). n is at least
+// 64 and a multiple of 16.
+GUICPP_TARGET("pclmul,sse4.1")
+uint32_t fold_crc32(uint32_t crc, const uint8_t *p, size_t n)
+{
+    alignas(16) static const uint64_t k1k2[] = {0x154442bd4, 0x1c6e41596};
+    alignas(16) static const uint64_t k3k4[] = {0x1751997d0, 0x0ccaa009e};
+    alignas(16) static const uint64_t k5k0[] = {0x163cd6124, 0x000000000};
+    alignas(16) static const uint64_t poly[] = {0x1db710641, 0x1f7011641};
+
+    __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16));
+    __m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 32));
+    __m128i x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 48));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+    __m128i k = _mm_load_si128(reinterpret_cast<const __m128i*>(k1k2));
+    p += 64;
+    n -= 64;
+    for (; n >= 64; n -= 64, p += 64) {
+        __m128i x5 = _mm_clmulepi64_si128(x1, k, 0x00);
+        __m128i x6 = _mm_clmulepi64_si128(x2, k, 0x00);
+        __m128i x7 = _mm_clmulepi64_si128(x3, k, 0x00);
+        __m128i x8 = _mm_clmulepi64_si128(x4, k, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, k, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, k, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, k, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, k, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 32)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 48)));
+    }
+
+    k = _mm_load_si128(reinterpret_cast<const __m128i*>(k3k4));
+    for (__m128i next : {x2, x3, x4}) {
+        __m128i x5 = _mm_clmulepi64_si128(x1, k, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, k, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, next), x5);
+    }
+    for (; n >= 16; n -= 16, p += 16) {
+        __m128i x5 = _mm_clmulepi64_si128(x1, k, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, k, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p))), x5);
+    }
+
+    // 128 to 64 bits
+    const __m128i mask = _mm_setr_epi32(~0, 0, ~0, 0);
+    __m128i y = _mm_clmulepi64_si128(x1, k, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), y);
+    k = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(k5k0));
+    y = _mm_srli_si128(x1, 4);
+    x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), k, 0x00);
+    x1 = _mm_xor_si128(x1, y);
+
+    // Barrett reduction to 32 bits
+    k = _mm_load_si128(reinterpret_cast<const __m128i*>(poly));
+    y = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), k, 0x10);
+    y = _mm_clmulepi64_si128(_mm_and_si128(y, mask), k, 0x00);
+    x1 = _mm_xor_si128(x1, y);
+    return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+GUICPP_TARGET("sse4.2")
+uint32_t update_crc32c_hardware(uint32_t crc, const uint8_t *p, size_t n)
+{
+#if defined(__x86_64__) || defined(_M_X64)
+    uint64_t crc64 = crc;
+    for (; n >= 8; n -= 8, p += 8) {
+        uint64_t v;
+        std::memcpy(&v, p, 8);
+        crc64 = _mm_crc32_u64(crc64, v);
+    }
+    crc = static_cast<uint32_t>(crc64);
+#else
+    for (; n >= 4; n -= 4, p += 4) {
+        uint32_t v;
+        std::memcpy(&v, p, 4);
+        crc = _mm_crc32_u32(crc, v);
+    }
+#endif
+    for (; n > 0; n--) {
+        crc = _mm_crc32_u8(crc, *p++);
+    }
+    return crc;
+}
+#endif
+
+uint32_t update_crc32(uint32_t crc, const uint8_t *p, size_t n)
+{
+#ifdef GUICPP_X86
+    if (n >= 64 && tables().clmul) {
+        size_t folded = n & ~static_cast<size_t>(15);
+        crc = fold_crc32(crc, p, folded);
+        p += folded;
+        n -= folded;
+    }
+#endif
+    return update_reflected(tables().crc32, crc, p, n);
+}
+
+uint32_t update_crc32c(uint32_t crc, const uint8_t *p, size_t n)
+{
+#ifdef GUICPP_X86
+    if (tables().sse42) {
+        return update_crc32c_hardware(crc, p, n);
+    }
+#endif
+    return update_reflected(tables().crc32c, crc, p, n);
+}
+
+#ifdef GUICPP_SSE2
+uint64_t horizontal_sum(__m128i v)
+{
+    uint32_t lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), v);
+    return static_cast<uint64_t>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+}
+#endif
+
+// Eight words per step: b grows by 8 times a before the step plus the words weighted 8 to 1.
+// Words are split into bytes for the signed multiplies, and the 32-bit lanes are added up
+// every 128 steps before they can overflow.
+ChecksumPart fletcher32(const uint8_t *p, size_t n)
+{
+    uint64_t a = 0;
+    uint64_t b = 0;
+    size_t words = n / 2;
+#ifdef GUICPP_SSE2
+    const __m128i low_bytes = _mm_set1_epi16(0x00FF);
+    const __m128i ones = _mm_set1_epi16(1);
+    const __m128i high = _mm_set1_epi16(256);
+    const __m128i weights = _mm_setr_epi16(8, 7, 6, 5, 4, 3, 2, 1);
+    const __m128i high_weights = _mm_slli_epi16(weights, 8);
+    while (words >= 8) {
+        __m128i sums = _mm_setzero_si128();
+        __m128i before = _mm_setzero_si128();
+        __m128i weighted = _mm_setzero_si128();
+        size_t steps = std::min<size_t>(words / 8, 128);
+        for (size_t i = 0; i < steps; i++, p += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            __m128i lo = _mm_and_si128(v, low_bytes);
+            __m128i hi = _mm_srli_epi16(v, 8);
+            before = _mm_add_epi32(before, sums);
+            sums = _mm_add_epi32(sums, _mm_add_epi32(_mm_madd_epi16(lo, ones), _mm_madd_epi16(hi, high)));
+            weighted = _mm_add_epi32(weighted, _mm_add_epi32(_mm_madd_epi16(lo, weights), _mm_madd_epi16(hi, high_weights)));
+        }
+        b = (b + 8 * (steps * a + horizontal_sum(before)) + horizontal_sum(weighted)) % 65535;
+        a = (a + horizontal_sum(sums)) % 65535;
+        words -= steps * 8;
+    }
+#endif
+    // Sums are reduced every so many words, before b can overflow
+    constexpr size_t chunk = 1 << 20;
+    while (words > 0) {
+        size_t count = std::min(words, chunk);
+        for (size_t i = 0; i < count; i++, p += 2) {
+            a += p[0] | p[1] << 8;
+            b += a;
+        }
+        a %= 65535;
+        b %= 65535;
+        words -= count;
+    }
+    if (n % 2 != 0) {
+        a = (a + *p) % 65535;
+        b = (b + a) % 65535;
+    }
+    return ChecksumPart{static_cast<uint32_t>(a), static_cast<uint32_t>(b), n};
+}
+
+uint32_t sum32(const uint8_t *p, size_t n)
+{
+    uint64_t sum = 0;
+    size_t i = 0;
+#ifdef GUICPP_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero;
+    for (; i + 16 <= n; i += 16) {
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)), zero));
+    }
+    uint64_t lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    sum = lanes[0] + lanes[1];
+#endif
+    for (; i < n; i++) {
+        sum += p[i];
+    }
+    return static_cast<uint32_t>(sum);
+}
+
+void clamp_range(bool range, uint64_t range_begin, uint64_t range_end, size_t size, size_t &begin, size_t &end)
+{
+    begin = range ? static_cast<size_t>(std::min<uint64_t>(range_begin, size)) : 0;
+    end = range ? static_cast<size_t>(std::min<uint64_t>(std::max(range_end, range_begin), size)) : size;
+}
+
+}
+
+// CRC parts hold the register for an initial value of 0, the initial value is applied by checksum_final
+ChecksumPart checksum_part(ChecksumKind kind, const uint8_t *data, size_t size)
+{
+    switch (kind) {
+    case ChecksumKind::crc16:
+        return ChecksumPart{update_crc16(0, data, size), 0, size};
+    case ChecksumKind::crc32:
+        return ChecksumPart{update_crc32(0, data, size), 0, size};
+    case ChecksumKind::crc32c:
+        return ChecksumPart{update_crc32c(0, data, size), 0, size};
+    case ChecksumKind::fletcher32:
+        return fletcher32(data, size);
+    case ChecksumKind::sum32:
+        return ChecksumPart{sum32(data, size), 0, size};
+    }
+    return ChecksumPart{0, 0, size};
+}
+
+ChecksumPart checksum_join(ChecksumKind kind, ChecksumPart const& first, ChecksumPart const& second)
+{
+    const uint64_t size = first.size + second.size;
+    switch (kind) {
+    case ChecksumKind::crc16:
+    case ChecksumKind::crc32:
+    case ChecksumKind::crc32c:
+        return ChecksumPart{multiply(kind, first.a, power(kind, 8 * second.size)) ^ second.a, 0, size};
+    case ChecksumKind::fletcher32: {
+        // Every word of the second part adds the a of the first part to b once more
+        uint64_t words = (second.size + 1) / 2;
+        uint64_t b = (first.b + second.b + words % 65535 * first.a) % 65535;
+        return ChecksumPart{(first.a + second.a) % 65535, static_cast<uint32_t>(b), size};
+    }
+    case ChecksumKind::sum32:
+        return ChecksumPart{first.a + second.a, 0, size};
+    }
+    return ChecksumPart{0, 0, size};
+}
+
+uint32_t checksum_final(ChecksumKind kind, ChecksumPart const& whole)
+{
+    switch (kind) {
+    case ChecksumKind::crc16:
+        return whole.a ^ multiply(kind, 0xFFFF, power(kind, 8 * whole.size));
+    case ChecksumKind::crc32:
+    case ChecksumKind::crc32c:
+        return whole.a ^ multiply(kind, 0xFFFFFFFF, power(kind, 8 * whole.size)) ^ 0xFFFFFFFF;
+    case ChecksumKind::fletcher32:
+        return whole.b << 16 | whole.a;
+    case ChecksumKind::sum32:
+        return whole.a;
+    }
+    return 0;
+}
+
+uint32_t checksum(ChecksumKind kind, const uint8_t *data, size_t size)
+{
+    return checksum_final(kind, checksum_part(kind, data, size));
+}
+
+ChecksumPanel::~ChecksumPanel()
+{
+    stop_ = true;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+float ChecksumPanel::height()
+{
+    return ImGui::GetFrameHeightWithSpacing();
+}
+
+// Settings, and whether a pass is due
+bool ChecksumPanel::draw_settings(size_t highlight_begin, size_t highlight_end, double now)
+{
+    static const char *kinds[] = {"CRC-16", "CRC-32", "CRC-32C", "Fletcher-32", "Sum32"};
+    const float digit_width = ImGui::CalcTextSize("0").x;
+
+    ImGui::SetNextItemWidth(ImGui::CalcTextSize("Fletcher-32").x + ImGui::GetFrameHeight() + ImGui::GetStyle().FramePadding.x * 2.0f);
+    bool changed = ImGui::Combo("##checksum", &kind_, kinds, IM_ARRAYSIZE(kinds));
+    ImGui::SameLine();
+    changed |= ImGui::Checkbox("Range", &range_);
+    if (range_) {
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(digit_width * 12);
+        changed |= ImGui::InputScalar("##begin", ImGuiDataType_U64, &range_begin_, nullptr, nullptr, "%llX", ImGuiInputTextFlags_CharsHexadecimal);
+        ImGui::SameLine();
+        ImGui::TextUnformatted("-");
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(digit_width * 12);
+        changed |= ImGui::InputScalar("##end", ImGuiDataType_U64, &range_end_, nullptr, nullptr, "%llX", ImGuiInputTextFlags_CharsHexadecimal);
+    }
+    if (highlight_end != static_cast<size_t>(-1)) {
+        ImGui::SameLine();
+        if (ImGui::Button("Highlight")) {
+            range_ = true;
+            range_begin_ = highlight_begin;
+            range_end_ = highlight_end;
+            changed = true;
+        }
+    }
+    if (changed) {
+        shown_ = false;
+        changed_ = true;
+    }
+
+    if (!running_ && thread_.joinable()) {
+        thread_.join();
+        // A result for settings changed since the pass started is computed again
+        shown_ = !changed_;
+        shown_result_ = result_;
+        shown_kind_ = job_kind_;
+    }
+    if (!running_ && ((!shown_ && !unavailable_) || now - started_ >= interval)) {
+        started_ = now;
+        return true;
+    }
+    return false;
+}
+
+void ChecksumPanel::draw_result()
+{
+    ImGui::SameLine();
+    if (unavailable_) {
+        ImGui::TextDisabled("Cannot checksum this memory");
+    } else if (shown_) {
+        ImGui::Text("%0*X", shown_kind_ == ChecksumKind::crc16 ? 4 : 8, shown_result_);
+    } else {
+        size_t total = total_blocks_;
+        ImGui::TextDisabled("%.0f%%", total > 0 ? 100.0 * done_blocks_ / total : 0.0);
+    }
+}
+
+void ChecksumPanel::draw(BytesFn const& bytes, size_t highlight_begin, size_t highlight_end)
+{
+    const double now = ImGui::GetTime();
+    if (draw_settings(highlight_begin, highlight_end, now)) {
+        size_t size = 0;
+        const uint8_t *data = bytes(size);
+        unavailable_ = data == nullptr;
+        if (!unavailable_) {
+            start(data, size, now);
+        }
+    }
+    draw_result();
+}
+
+void ChecksumPanel::draw(Reader const& reader, size_t highlight_begin, size_t highlight_end)
+{
+    if (draw_settings(highlight_begin, highlight_end, ImGui::GetTime())) {
+        unavailable_ = !start(reader);
+    }
+    draw_result();
+}
+
+void ChecksumPanel::mark_changed(size_t begin, size_t end)
+{
+    marked_.push_back(ChangeTracker::Span{begin, end});
+}
+
+// Blocks are computed again when the memory or the kind changes
+bool ChecksumPanel::prepare(size_t size)
+{
+    const ChecksumKind kind = static_cast<ChecksumKind>(kind_);
+    const size_t blocks = (size + block_size - 1) / block_size;
+    if (parts_.size() != blocks || parts_size_ != size || parts_kind_ != kind) {
+        parts_.assign(blocks, ChecksumPart{0, 0, 0});
+        dirty_.assign(blocks, 1);
+        parts_size_ = size;
+        parts_kind_ = kind;
+        return true;
+    }
+    return false;
+}
+
+void ChecksumPanel::start(const uint8_t *bytes, size_t size, double now)
+{
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    job_kind_ = static_cast<ChecksumKind>(kind_);
+    clamp_range(range_, range_begin_, range_end_, size, job_begin_, job_end_);
+    changed_ = false;
+    total_blocks_ = 0;
+    done_blocks_ = 0;
+    running_ = true;
+    thread_ = std::thread([this, bytes, size, now]() { work(bytes, size, now); });
+}
+
+// Copies the blocks marked changed, and those the range covers partly, block by block. Blocks
+// holding only one value are not read, their checksum is computed once per pass. The worker never
+// reads the memory, which may be changed while it runs.
+bool ChecksumPanel::start(Reader const& reader)
+{
+    if (!reader.read) {
+        return false;
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    const size_t size = reader.size;
+    job_kind_ = static_cast<ChecksumKind>(kind_);
+    clamp_range(range_, range_begin_, range_end_, size, job_begin_, job_end_);
+    const bool odd = job_kind_ == ChecksumKind::fletcher32 && job_begin_ % 2 != 0;
+    if (odd && job_end_ - job_begin_ > max_range_copy) {
+        return false;
+    }
+    if (!prepare(size)) {
+        for (auto const& span : marked_) {
+            for (size_t i = span.begin / block_size; i < parts_.size() && i * block_size < span.end; i++) {
+                dirty_[i] = 1;
+            }
+        }
+    }
+    marked_.clear();
+
+    job_bytes_.clear();
+    job_sources_.assign(parts_.size(), BlockSource{0, no_fill});
+    auto copy = [&](size_t i) {
+        size_t offset = i * block_size;
+        size_t count = std::min(block_size, size - offset);
+        uint8_t value;
+        if (reader.filled && reader.filled(offset, count, value)) {
+            job_sources_[i].fill = value;
+            return;
+        }
+        job_sources_[i].offset = job_bytes_.size();
+        job_sources_[i].fill = copied;
+        job_bytes_.resize(job_bytes_.size() + count);
+        reader.read(offset, job_bytes_.data() + job_sources_[i].offset, count);
+    };
+    for (size_t i = 0; i < parts_.size(); i++) {
+        if (dirty_[i]) {
+            copy(i);
+        }
+    }
+    if (job_begin_ < job_end_) {
+        for (size_t i : {job_begin_ / block_size, (job_end_ - 1) / block_size}) {
+            if (job_sources_[i].fill == no_fill) {
+                copy(i);
+            }
+        }
+    }
+    job_range_.clear();
+    if (odd) {
+        job_range_.resize(job_end_ - job_begin_);
+        reader.read(job_begin_, job_range_.data(), job_range_.size());
+    }
+
+    changed_ = false;
+    total_blocks_ = 0;
+    done_blocks_ = 0;
+    running_ = true;
+    thread_ = std::thread([this, size]() {
+        std::map<int, std::vector<uint8_t>> fills;
+        compute(size, [this, &fills](size_t block) -> const uint8_t* {
+            auto const& source = job_sources_[block];
+            if (source.fill == copied) {
+                return job_bytes_.data() + source.offset;
+            }
+            auto &fill = fills[source.fill];
+            if (fill.empty()) {
+                fill.assign(block_size, static_cast<uint8_t>(source.fill));
+            }
+            return fill.data();
+        }, job_range_.data());
+    });
+    return true;
+}
+
+// Diffs the memory against the copy of the last pass, then computes the blocks that changed from the copy
+void ChecksumPanel::work(const uint8_t *bytes, size_t size, double now)
+{
+    tracker_.update(bytes, size, now);
+    if (!prepare(size)) {
+        for (auto const& span : tracker_.changes()) {
+            for (size_t i = span.begin / block_size; i * block_size < span.end; i++) {
+                dirty_[i] = 1;
+            }
+        }
+    }
+    const uint8_t *shadow = tracker_.shadow();
+    compute(size, [shadow](size_t block) { return shadow + block * block_size; }, shadow + job_begin_);
+}
+
+// Computes the dirty blocks, then joins the blocks in the range. Only the blocks at the edges of
+// the range are read partly. range holds the bytes of the range, for Fletcher from an odd offset.
+void ChecksumPanel::compute(size_t size, std::function<const uint8_t*(size_t block)> const& block, const uint8_t *range)
+{
+    const ChecksumKind kind = job_kind_;
+    const size_t blocks = parts_.size();
+    total_blocks_ = static_cast<size_t>(std::count(dirty_.begin(), dirty_.end(), 1));
+    // Blocks of a reader filled with the same value share their bytes, which are summed once
+    const uint8_t *last = nullptr;
+    ChecksumPart last_part{0, 0, 0};
+    for (size_t i = 0; i < blocks; i++) {
+        if (stop_) {
+            running_ = false;
+            return;
+        }
+        if (dirty_[i]) {
+            size_t offset = i * block_size;
+            size_t count = std::min(block_size, size - offset);
+            const uint8_t *bytes = block(i);
+            if (bytes != last || count != last_part.size) {
+                last_part = checksum_part(kind, bytes, count);
+                last = bytes;
+            }
+            parts_[i] = last_part;
+            dirty_[i] = 0;
+            done_blocks_++;
+        }
+    }
+
+    ChecksumPart whole{0, 0, 0};
+    if (kind == ChecksumKind::fletcher32 && job_begin_ % 2 != 0) {
+        // Words would straddle the blocks
+        whole = checksum_part(kind, range, job_end_ - job_begin_);
+    } else {
+        for (size_t i = job_begin_; i < job_end_;) {
+            size_t index = i / block_size;
+            size_t block_begin = index * block_size;
+            size_t block_end = std::min(block_begin + block_size, size);
+            size_t piece_end = std::min(job_end_, block_end);
+            ChecksumPart part = i == block_begin && piece_end == block_end ? parts_[index] : checksum_part(kind, block(index) + (i - block_begin), piece_end - i);
+            whole = checksum_join(kind, whole, part);
+            i = piece_end;
+        }
+    }
+    result_ = checksum_final(kind, whole);
+    running_ = false;
+}
+
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include "change_tracker.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace guicpp
+{
+
+enum class ChecksumKind
+{
+    crc16,      // CRC-16/CCITT-FALSE
+    crc32,      // CRC-32 (zlib, Ethernet)
+    crc32c,     // CRC-32C (Castagnoli)
+    fletcher32, // over little endian 16-bit words
+    sum32,      // additive
+};
+
+// Checksum of a block with what is needed to join it to the blocks around it. Blocks other than
+// the last one must have an even size for Fletcher.
+struct ChecksumPart
+{
+    uint32_t a;
+    uint32_t b;
+    uint64_t size;
+};
+
+// CRC-32 uses PCLMUL folding and CRC-32C the SSE4.2 crc32 instruction when the CPU has them,
+// everything else slice-by-8 tables
+ChecksumPart checksum_part(ChecksumKind kind, const uint8_t *data, size_t size);
+ChecksumPart checksum_join(ChecksumKind kind, ChecksumPart const& first, ChecksumPart const& second);
+uint32_t checksum_final(ChecksumKind kind, ChecksumPart const& whole);
+uint32_t checksum(ChecksumKind kind, const uint8_t *data, size_t size);
+
+// Checksum line below a memory editor, for the whole memory or a range of it. The memory is split
+// into blocks whose checksums are joined, and only blocks that changed are computed again, on a worker.
+class ChecksumPanel
+{
+public:
+    using BytesFn = std::function<const uint8_t*(size_t &size)>;
+
+    // Memory that is not addressable, e.g. a sparse store. It is not diffed: only the blocks
+    // reported by mark_changed() are read again, at the start of a pass.
+    struct Reader
+    {
+        size_t size;
+        std::function<void(size_t offset, uint8_t *out, size_t size)> read;
+        // Whether [offset, offset + size) holds only value, which is then not read. Optional.
+        std::function<bool(size_t offset, size_t size, uint8_t &value)> filled;
+    };
+
+    static constexpr size_t block_size = 64 << 10;
+
+    ChecksumPanel() = default;
+    ~ChecksumPanel();
+    ChecksumPanel(ChecksumPanel const&) = delete;
+    ChecksumPanel& operator=(ChecksumPanel const&) = delete;
+
+    static float height();
+
+    // bytes is called when a pass starts, and returns null when the memory cannot be read whole.
+    // What it returns must stay valid until the next call. The highlighted range of the editor can
+    // be taken as the range, highlight_end is -1 when there is none.
+    void draw(BytesFn const& bytes, size_t highlight_begin, size_t highlight_end);
+    // Same, for a reader that returns no read function when the memory cannot be read
+    void draw(Reader const& reader, size_t highlight_begin, size_t highlight_end);
+    // Blocks of a reader overlapping [begin, end) are read again at the next pass
+    void mark_changed(size_t begin, size_t end);
+
+private:
+    // Changes are looked for at most this often, a pass over unchanged memory only diffs it
+    static constexpr double interval = 0.25;
+    // A Fletcher range from an odd offset cannot use the blocks, a reader copies it whole up to this
+    static constexpr size_t max_range_copy = 256 << 20;
+    static constexpr int copied = -1;
+    static constexpr int no_fill = -2;
+
+    // Where the bytes of a block of a reader are for the job: copied at offset, or all fill
+    struct BlockSource
+    {
+        size_t offset;
+        int fill;
+    };
+
+    bool draw_settings(size_t highlight_begin, size_t highlight_end, double now);
+    void draw_result();
+    bool prepare(size_t size);
+    void start(const uint8_t *bytes, size_t size, double now);
+    bool start(Reader const& reader);
+    void work(const uint8_t *bytes, size_t size, double now);
+    void compute(size_t size, std::function<const uint8_t*(size_t block)> const& block, const uint8_t *range);
+
+    ChangeTracker tracker_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> stop_{false};
+    std::atomic<size_t> total_blocks_{0};
+    std::atomic<size_t> done_blocks_{0};
+    double started_ = -1e30;
+    int kind_ = static_cast<int>(ChecksumKind::crc32);
+    bool range_ = false;
+    uint64_t range_begin_ = 0;
+    uint64_t range_end_ = 0;
+    bool changed_ = false;
+    bool unavailable_ = false;
+    bool shown_ = false;
+    uint32_t shown_result_ = 0;
+    ChecksumKind shown_kind_ = ChecksumKind::crc32;
+    std::vector<ChangeTracker::Span> marked_;
+    // Only touched by the job while it runs
+    std::vector<ChecksumPart> parts_;
+    std::vector<uint8_t> dirty_;
+    size_t parts_size_ = 0;
+    ChecksumKind parts_kind_ = ChecksumKind::crc32;
+    ChecksumKind job_kind_ = ChecksumKind::crc32;
+    size_t job_begin_ = 0;
+    size_t job_end_ = 0;
+    std::vector<BlockSource> job_sources_;
+    std::vector<uint8_t> job_bytes_;
+    std::vector<uint8_t> job_range_;
+    uint32_t result_ = 0;
+};
+
+}
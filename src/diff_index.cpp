@@ -0,0 +1,146 @@
+#include "diff_index.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GUICPP_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace guicpp
+{
+
+namespace
+{
+
+#ifdef GUICPP_SSE2
+bool equal64(const uint8_t *a, const uint8_t *b)
+{
+    __m128i d0 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(b)));
+    __m128i d1 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + 16)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 16)));
+    __m128i d2 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + 32)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 32)));
+    __m128i d3 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + 48)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 48)));
+    __m128i any = _mm_or_si128(_mm_or_si128(d0, d1), _mm_or_si128(d2, d3));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(any, _mm_setzero_si128())) == 0xFFFF;
+}
+#endif
+
+void add(std::vector<DiffIndex::Range> &out, size_t begin, size_t end)
+{
+    if (!out.empty() && begin - out.back().end < DiffIndex::merge_gap) {
+        out.back().end = end;
+    } else {
+        out.push_back(DiffIndex::Range{begin, end});
+    }
+}
+
+}
+
+// Skips equal memory 64 bytes at a time, then 8, and only compares single bytes near differences
+void DiffIndex::scan(const uint8_t *a, const uint8_t *b, size_t begin, size_t end, std::vector<Range> &out) const
+{
+    size_t limit = std::min(end, common_);
+    size_t i = begin;
+    while (i < limit) {
+#ifdef GUICPP_SSE2
+        if (i + 64 <= limit && equal64(a + i, b + i)) {
+            i += 64;
+            continue;
+        }
+#endif
+        uint64_t x, y;
+        if (i + 8 <= limit) {
+            std::memcpy(&x, a + i, 8);
+            std::memcpy(&y, b + i, 8);
+            if (x == y) {
+                i += 8;
+                continue;
+            }
+        }
+        size_t block_end = std::min(limit, i + 8);
+        for (; i < block_end; i++) {
+            if (a[i] != b[i]) {
+                add(out, i, i + 1);
+            }
+        }
+    }
+    if (end > common_ && std::max(begin, common_) < std::min(end, size_)) {
+        add(out, std::max(begin, common_), std::min(end, size_));
+    }
+}
+
+void DiffIndex::build(const uint8_t *a, size_t a_size, const uint8_t *b, size_t b_size)
+{
+    common_ = std::min(a_size, b_size);
+    size_ = std::max(a_size, b_size);
+    ranges_.clear();
+    scan(a, b, 0, size_, ranges_);
+}
+
+// Ranges within merge_gap of [begin, end) may grow or merge with the new ones, so they are
+// diffed again with it. Ranges further away cannot be affected.
+void DiffIndex::update(const uint8_t *a, const uint8_t *b, size_t begin, size_t end)
+{
+    end = std::min(end, size_);
+    if (begin >= end) {
+        return;
+    }
+    size_t low = begin >= merge_gap ? begin - merge_gap : 0;
+    size_t high = end + merge_gap;
+    auto first = std::lower_bound(ranges_.begin(), ranges_.end(), low, [](Range const& r, size_t offset) {
+        return r.end <= offset;
+    });
+    auto last = std::lower_bound(first, ranges_.end(), high, [](Range const& r, size_t offset) {
+        return r.begin < offset;
+    });
+    if (first != last) {
+        begin = std::min(begin, first->begin);
+        end = std::max(end, (last - 1)->end);
+    }
+    std::vector<Range> fresh;
+    scan(a, b, begin, end, fresh);
+    size_t index = first - ranges_.begin();
+    ranges_.erase(first, last);
+    ranges_.insert(ranges_.begin() + index, fresh.begin(), fresh.end());
+}
+
+size_t DiffIndex::find(size_t offset) const
+{
+    return std::lower_bound(ranges_.begin(), ranges_.end(), offset, [](Range const& r, size_t o) {
+        return r.end <= o;
+    }) - ranges_.begin();
+}
+
+bool DiffIndex::next(size_t offset, size_t &index) const
+{
+    if (ranges_.empty()) {
+        return false;
+    }
+    index = std::upper_bound(ranges_.begin(), ranges_.end(), offset, [](size_t o, Range const& r) {
+        return o < r.begin;
+    }) - ranges_.begin();
+    if (index == ranges_.size()) {
+        index = 0;
+    }
+    return true;
+}
+
+bool DiffIndex::previous(size_t offset, size_t &index) const
+{
+    if (ranges_.empty()) {
+        return false;
+    }
+    index = std::lower_bound(ranges_.begin(), ranges_.end(), offset, [](Range const& r, size_t o) {
+        return r.begin < o;
+    }) - ranges_.begin();
+    index = index == 0 ? ranges_.size() - 1 : index - 1;
+    return true;
+}
+
+bool DiffIndex::any(size_t begin, size_t end) const
+{
+    size_t i = find(begin);
+    return i < ranges_.size() && ranges_[i].begin < end;
+}
+
+}
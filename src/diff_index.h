@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace guicpp
+{
+
+// Sorted ranges where two buffers differ. Ranges closer than merge_gap bytes are merged, so that
+// scattered changes stay a short list. Bytes past the end of the shorter buffer always differ.
+class DiffIndex
+{
+public:
+    static constexpr size_t merge_gap = 8;
+
+    struct Range
+    {
+        size_t begin;
+        size_t end;
+    };
+
+    void build(const uint8_t *a, size_t a_size, const uint8_t *b, size_t b_size);
+    // Diffs [begin, end) again, the rest of the index is kept
+    void update(const uint8_t *a, const uint8_t *b, size_t begin, size_t end);
+
+    std::vector<Range> const& ranges() const { return ranges_; }
+    size_t size() const { return size_; }
+    // Index of the first range ending after offset, ranges().size() if there is none
+    size_t find(size_t offset) const;
+    // Closest range beginning after or before offset, wrapping around. False when there are no ranges.
+    bool next(size_t offset, size_t &index) const;
+    bool previous(size_t offset, size_t &index) const;
+    // Whether a range intersects [begin, end)
+    bool any(size_t begin, size_t end) const;
+
+private:
+    void scan(const uint8_t *a, const uint8_t *b, size_t begin, size_t end, std::vector<Range> &out) const;
+
+    std::vector<Range> ranges_;
+    size_t common_ = 0;
+    size_t size_ = 0;
+};
+
+}
@@ -0,0 +1,43 @@
+#include "file_io.h"
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace guicpp
+{
+
+bool file_seek(std::FILE *f, uint64_t offset)
+{
+#ifdef _WIN32
+    return _fseeki64(f, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+    return fseeko(f, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+uint64_t file_size(std::FILE *f)
+{
+#ifdef _WIN32
+    const __int64 size = _fseeki64(f, 0, SEEK_END) == 0 ? _ftelli64(f) : -1;
+#else
+    const off_t size = fseeko(f, 0, SEEK_END) == 0 ? ftello(f) : -1;
+#endif
+    return size < 0 ? file_size_error : static_cast<uint64_t>(size);
+}
+
+bool file_resize(std::FILE *f, uint64_t size)
+{
+    if (std::fflush(f) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return _chsize_s(_fileno(f), static_cast<__int64>(size)) == 0;
+#else
+    return ftruncate(fileno(f), static_cast<off_t>(size)) == 0;
+#endif
+}
+
+}
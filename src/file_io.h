@@ -0,0 +1,14 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+
+namespace guicpp
+{
+    // Seek and size with 64-bit offsets, long is 32 bits on Win32 so fseek and ftell stop at 2 GB.
+    bool file_seek(std::FILE *f, uint64_t offset);
+    constexpr uint64_t file_size_error = ~0ull;
+    // Leaves the position at the end of the file, file_size_error when it cannot be told
+    uint64_t file_size(std::FILE *f);
+    // Truncates or extends with zeros, after flushing the C buffers
+    bool file_resize(std::FILE *f, uint64_t size);
+}
@@ -1,6 +1,5 @@
 #include <gui/gui.h>
 #include "imgui.h"
-#include "imgui_memory_editor.h"
 
 namespace guicpp
 {
@@ -245,187 +244,4 @@ void Window::draw() const
     ImGui::End();
 }
 
-struct LogWindow::impl
-{
-    impl(const char * text, Size size = {}, Position position = {}) : 
-        text_{text}, size_{size}, position_{position}
-    {}
-
-    void clear() { 
-        text_buffer.clear(); 
-        lines_offsets.clear();
-    }
-
-    void add_log(const char* str)
-    {
-        int old_size = text_buffer.size();
-        text_buffer.append(str);
-        for (int new_size = text_buffer.size(); old_size < new_size; old_size++) {
-            if (text_buffer[old_size] == '\n') {
-                lines_offsets.push_back(old_size);
-            }
-        }
-        scroll_to_bottom = true;
-    }
-
-    void draw()
-    {
-        ImGui::SetNextWindowSize(ImVec2(size_.width, size_.height), ImGuiCond_FirstUseEver);
-        ImGui::SetNextWindowPos(ImVec2(position_.x, position_.y), ImGuiCond_FirstUseEver);
-        ImGui::Begin(text_);
-        if (ImGui::Button("Clear")) {
-            clear();
-        }
-        ImGui::SameLine();
-        bool copy = ImGui::Button("Copy");
-        ImGui::SameLine();
-        filter.Draw("Filter", -100.0f);
-        ImGui::Separator();
-        ImGui::BeginChild("scrolling");
-        ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(0,1));
-        if (copy) {
-            ImGui::LogToClipboard();
-        }
-
-        if (filter.IsActive())
-        {
-            const char* buf_begin = text_buffer.begin();
-            const char* line = buf_begin;
-            for (int line_no = 0; line != NULL; line_no++)
-            {
-                const char* line_end = (line_no < lines_offsets.Size) ? buf_begin + lines_offsets[line_no] : NULL;
-                if (filter.PassFilter(line, line_end)) {
-                    ImGui::TextUnformatted(line, line_end);
-                }
-                line = line_end && line_end[1] ? line_end + 1 : NULL;
-            }
-        }
-        else
-        {
-            ImGui::TextUnformatted(text_buffer.begin());
-        }
-
-        if (scroll_to_bottom) {
-            ImGui::SetScrollHereY(1.0f);
-        }
-        scroll_to_bottom = false;
-        ImGui::PopStyleVar();
-        ImGui::EndChild();
-        ImGui::End();
-    }
-
-
-    const char *text_;
-    Size size_;
-    Position position_;
-private:
-    ImGuiTextBuffer text_buffer;
-    ImGuiTextFilter filter;
-    ImVector<int> lines_offsets;
-    bool scroll_to_bottom;
-};
-
-LogWindow::LogWindow(const char *text, Size size, Position position) :
-    pimpl_{std::make_unique<impl>(text, size, position)}
-{}
-
-LogWindow::~LogWindow() = default;
-
-LogWindow::LogWindow(LogWindow const& rhs) :
-    pimpl_(std::make_unique<impl>(rhs.pimpl_->text_, rhs.pimpl_->size_, rhs.pimpl_->position_))
-{}
-
-void LogWindow::draw() const
-{
-    pimpl_->draw();
 }
-
-void LogWindow::add_log(const char *text)
-{
-    pimpl_->add_log(text);
-}
-
-struct MemoryEditorWindow::impl
-{
-    const char *text_;
-    uint8_t *bytes_;
-    size_t bytes_size_;
-    Size size_;
-    Position position_;
-    MemoryEditor memory_editor;
-
-    impl(const char* text, uint8_t *bytes, size_t bytes_size, Size size = {}, Position position = {}) :
-        text_{text},
-        bytes_{bytes},
-        bytes_size_{bytes_size},
-        size_{size},
-        position_{position}
-    {}
-
-    void draw() {
-        ImGui::SetNextWindowSize(ImVec2(size_.width, size_.height), ImGuiCond_FirstUseEver);
-        ImGui::SetNextWindowPos(ImVec2(position_.x, position_.y), ImGuiCond_FirstUseEver);
-        memory_editor.DrawWindow(text_, bytes_, bytes_size_);
-    }
-
-};
-
-MemoryEditorWindow::MemoryEditorWindow(const char* text, uint8_t *bytes, size_t bytes_size, Size size, Position position) :
-    pimpl_{std::make_unique<impl>(text, bytes, bytes_size, size, position)}
-{}
-
-MemoryEditorWindow::~MemoryEditorWindow() = default;
-
-MemoryEditorWindow::MemoryEditorWindow(MemoryEditorWindow const& rhs) :
-    pimpl_(std::make_unique<impl>(rhs.pimpl_->text_, rhs.pimpl_->bytes_, rhs.pimpl_->bytes_size_, rhs.pimpl_->size_, rhs.pimpl_->position_))
-{}
-
-void MemoryEditorWindow::draw() const
-{
-    pimpl_->draw();
-}
-
-struct SectorMemoryEditorWindow::impl
-{
-    const char *text_;
-    std::vector<std::vector<uint8_t>> &sectors_;
-    int &current_sector_;
-    Size size_;
-    Position position_;
-    MemoryEditor memory_editor;
-    std::string full_text;
-
-    impl(const char* text, std::vector<std::vector<uint8_t>> &sectors, int &current_sector, Size size = {}, Position position = {}) :
-        text_{text},
-        sectors_{sectors},
-        current_sector_{current_sector},
-        size_{size},
-        position_{position}
-    {}
-
-    void draw() {
-        if (current_sector_ < sectors_.size()) {
-            ImGui::SetNextWindowSize(ImVec2(size_.width, size_.height), ImGuiCond_FirstUseEver);
-            ImGui::SetNextWindowPos(ImVec2(position_.x, position_.y), ImGuiCond_FirstUseEver);
-            memory_editor.DrawWindow(text_, sectors_[current_sector_].data(), sectors_[current_sector_].size());
-        }
-    }
-
-};
-
-SectorMemoryEditorWindow::SectorMemoryEditorWindow(const char* text, std::vector<std::vector<uint8_t>> &sectors, int &current_sector, Size size, Position position) :
-    pimpl_{std::make_unique<impl>(text, sectors, current_sector, size, position)}
-{}
-
-SectorMemoryEditorWindow::~SectorMemoryEditorWindow() = default;
-
-SectorMemoryEditorWindow::SectorMemoryEditorWindow(SectorMemoryEditorWindow const& rhs) :
-    pimpl_(std::make_unique<impl>(rhs.pimpl_->text_, rhs.pimpl_->sectors_, rhs.pimpl_->current_sector_, rhs.pimpl_->size_, rhs.pimpl_->position_))
-{}
-
-void SectorMemoryEditorWindow::draw() const
-{
-    pimpl_->draw();
-}
-
-}
\ No newline at end of file
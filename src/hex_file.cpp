@@ -0,0 +1,713 @@
+#include "hex_file.h"
+#include "mapped_file.h"
+#include "imgui.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GUICPP_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace guicpp
+{
+
+namespace
+{
+
+// Longest record, an Intel record of 255 data bytes, and room for the 8 bytes stored by the last chunk
+constexpr size_t max_record = 260;
+constexpr size_t record_slack = 8;
+
+const char hex_digits[] = "0123456789ABCDEF";
+
+int hex_value(unsigned char c)
+{
+    if (static_cast<unsigned>(c - '0') < 10u) {
+        return c - '0';
+    }
+    c |= 0x20;
+    return static_cast<unsigned>(c - 'a') < 6u ? c - 'a' + 10 : -1;
+}
+
+// Decodes count digits, an even number, into count / 2 bytes, false on anything but hex digits.
+// Chunks of 16 digits are decoded at once and may read up to limit past the digits, the extra
+// bytes they store past the end of out are garbage.
+bool decode_hex(const char *in, size_t count, uint8_t *out, const char *limit)
+{
+    size_t i = 0;
+#ifdef GUICPP_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; i < count && limit - (in + i) >= 16; i += 16) {
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128i digit = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+        const __m128i letter = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+        const __m128i is_digit = _mm_cmpeq_epi8(_mm_subs_epu8(digit, _mm_set1_epi8(9)), zero);
+        const __m128i is_letter = _mm_cmpeq_epi8(_mm_subs_epu8(letter, _mm_set1_epi8(5)), zero);
+        const unsigned valid = static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(is_digit, is_letter)));
+        const unsigned needed = count - i >= 16 ? 0xFFFFu : (1u << (count - i)) - 1;
+        if ((valid & needed) != needed) {
+            return false;
+        }
+        // Nibble pairs n0 | n1 << 8 become n0 << 4 | n1 in the low byte of each 16-bit lane
+        const __m128i nibbles = _mm_or_si128(_mm_and_si128(is_digit, digit),
+            _mm_and_si128(is_letter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+        const __m128i pairs = _mm_and_si128(_mm_or_si128(_mm_slli_epi16(nibbles, 4), _mm_srli_epi16(nibbles, 8)), _mm_set1_epi16(0xFF));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i / 2), _mm_packus_epi16(pairs, pairs));
+    }
+#else
+    (void)limit;
+#endif
+    for (; i < count; i += 2) {
+        const int hi = hex_value(static_cast<unsigned char>(in[i]));
+        const int lo = hex_value(static_cast<unsigned char>(in[i + 1]));
+        if (hi < 0 || lo < 0) {
+            return false;
+        }
+        out[i / 2] = static_cast<uint8_t>(hi << 4 | lo);
+    }
+    return true;
+}
+
+// Writes two uppercase digits per byte
+void encode_hex(const uint8_t *in, size_t size, char *out)
+{
+    size_t i = 0;
+#ifdef GUICPP_SSE2
+    const __m128i low_nibble = _mm_set1_epi8(0x0F);
+    for (; i + 16 <= size; i += 16) {
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128i hi = _mm_and_si128(_mm_srli_epi16(b, 4), low_nibble);
+        const __m128i lo = _mm_and_si128(b, low_nibble);
+        __m128i first = _mm_unpacklo_epi8(hi, lo);
+        __m128i second = _mm_unpackhi_epi8(hi, lo);
+        // '0' + n, and 7 more for A-F
+        const __m128i nine = _mm_set1_epi8(9);
+        first = _mm_add_epi8(_mm_add_epi8(first, _mm_set1_epi8('0')), _mm_and_si128(_mm_cmpgt_epi8(first, nine), _mm_set1_epi8(7)));
+        second = _mm_add_epi8(_mm_add_epi8(second, _mm_set1_epi8('0')), _mm_and_si128(_mm_cmpgt_epi8(second, nine), _mm_set1_epi8(7)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i), first);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i + 16), second);
+    }
+#endif
+    for (; i < size; i++) {
+        out[2 * i] = hex_digits[in[i] >> 4];
+        out[2 * i + 1] = hex_digits[in[i] & 0x0F];
+    }
+}
+
+uint8_t byte_sum(const uint8_t *bytes, size_t size)
+{
+    unsigned sum = 0;
+    for (size_t i = 0; i < size; i++) {
+        sum += bytes[i];
+    }
+    return static_cast<uint8_t>(sum);
+}
+
+uint64_t big_endian(const uint8_t *bytes, size_t size)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; i++) {
+        value = value << 8 | bytes[i];
+    }
+    return value;
+}
+
+bool is_blank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Part of the data in the memory of size bytes at base, moving address to the offset in it
+bool clip(uint64_t base, size_t size, uint64_t &address, const uint8_t *&bytes, size_t &count)
+{
+    const uint64_t end = address + count;
+    const uint64_t memory_end = base + size;
+    if (end <= base || address >= memory_end) {
+        return false;
+    }
+    if (address < base) {
+        bytes += base - address;
+        address = base;
+    }
+    count = static_cast<size_t>(std::min(end, memory_end) - address);
+    address -= base;
+    return true;
+}
+
+}
+
+struct HexReader::impl
+{
+    // Runs given to DataFn are cut at this size
+    static constexpr size_t max_run = 64 << 10;
+
+    MappedFile file;
+    HexFormat format = HexFormat::intel;
+    size_t error_line = 0;
+    const char *error = nullptr;
+    uint64_t bytes_read = 0;
+    uint64_t skipped = 0;
+    bool has_start_address = false;
+    uint64_t start_address = 0;
+
+    bool fail(size_t line, const char *what)
+    {
+        error_line = line;
+        error = what;
+        return false;
+    }
+
+    // Calls sink(address, bytes, size) for every data record
+    template <typename Sink>
+    bool parse(Sink &&sink)
+    {
+        error_line = 0;
+        error = nullptr;
+        bytes_read = skipped = 0;
+        has_start_address = false;
+        start_address = 0;
+        const char *p = reinterpret_cast<const char*>(file.data());
+        const char *const end = p + file.size();
+        uint8_t record[max_record + record_slack];
+        uint64_t upper = 0;
+        size_t data_records = 0;
+        size_t line = 0;
+        while (p < end) {
+            line++;
+            const char *eol = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+            const char *next = eol != nullptr ? eol + 1 : end;
+            const char *last = eol != nullptr ? eol : end;
+            while (p < last && is_blank(*p)) {
+                p++;
+            }
+            while (last > p && is_blank(last[-1])) {
+                last--;
+            }
+            if (p == last) {
+                p = next;
+                continue;
+            }
+            if (format == HexFormat::intel) {
+                if (*p != ':') {
+                    return fail(line, "Not an Intel HEX record");
+                }
+                const size_t digits = static_cast<size_t>(last - p - 1);
+                if (digits % 2 != 0 || digits < 10 || digits > 2 * max_record) {
+                    return fail(line, "Bad record length");
+                }
+                const size_t size = digits / 2;
+                if (!decode_hex(p + 1, digits, record, end)) {
+                    return fail(line, "Not hexadecimal");
+                }
+                if (record[0] + 5u != size) {
+                    return fail(line, "Bad record length");
+                }
+                if (byte_sum(record, size) != 0) {
+                    return fail(line, "Bad checksum");
+                }
+                const uint8_t *data = record + 4;
+                const size_t count = record[0];
+                const uint8_t type = record[3];
+                const size_t expected[] = {count, 0, 2, 4, 2, 4};
+                if (type > 5) {
+                    return fail(line, "Unknown record type");
+                }
+                if (count != expected[type]) {
+                    return fail(line, "Bad record length");
+                }
+                switch (type) {
+                case 0:
+                    bytes_read += count;
+                    sink(upper + big_endian(record + 1, 2), data, count);
+                    break;
+                case 1:
+                    return true;
+                case 2:
+                    upper = big_endian(data, 2) << 4;
+                    break;
+                case 3:
+                    has_start_address = true;
+                    start_address = (big_endian(data, 2) << 4) + big_endian(data + 2, 2);
+                    break;
+                case 4:
+                    upper = big_endian(data, 2) << 16;
+                    break;
+                case 5:
+                    has_start_address = true;
+                    start_address = big_endian(data, 4);
+                    break;
+                }
+            } else {
+                if (last - p < 2 || *p != 'S' || p[1] < '0' || p[1] > '9' || p[1] == '4') {
+                    return fail(line, "Not an S-record");
+                }
+                const int type = p[1] - '0';
+                const size_t digits = static_cast<size_t>(last - p - 2);
+                if (digits % 2 != 0 || digits < 6 || digits > 2 * max_record) {
+                    return fail(line, "Bad record length");
+                }
+                const size_t size = digits / 2;
+                if (!decode_hex(p + 2, digits, record, end)) {
+                    return fail(line, "Not hexadecimal");
+                }
+                if (record[0] + 1u != size) {
+                    return fail(line, "Bad record length");
+                }
+                if (byte_sum(record, size) != 0xFF) {
+                    return fail(line, "Bad checksum");
+                }
+                static const size_t address_sizes[] = {2, 2, 3, 4, 0, 2, 3, 4, 3, 2};
+                const size_t address_size = address_sizes[type];
+                if (record[0] < address_size + 1) {
+                    return fail(line, "Bad record length");
+                }
+                const uint64_t address = big_endian(record + 1, address_size);
+                const uint8_t *data = record + 1 + address_size;
+                const size_t count = record[0] - address_size - 1;
+                if (type >= 1 && type <= 3) {
+                    bytes_read += count;
+                    data_records++;
+                    sink(address, data, count);
+                } else if (type == 5 || type == 6) {
+                    if (address != data_records) {
+                        return fail(line, "Wrong record count");
+                    }
+                } else if (type >= 7) {
+                    has_start_address = true;
+                    start_address = address;
+                    return true;
+                }
+            }
+            p = next;
+        }
+        return fail(line + 1, "No end record");
+    }
+
+    // A first pass checks the whole file, so nothing is written from a file that turns out bad
+    bool validate()
+    {
+        return parse([](uint64_t, const uint8_t*, size_t) {});
+    }
+
+    // Joins consecutive records into runs
+    bool read(DataFn const& f)
+    {
+        if (!validate()) {
+            return false;
+        }
+        std::vector<uint8_t> run;
+        uint64_t run_address = 0;
+        bool ok = parse([&](uint64_t address, const uint8_t *bytes, size_t size) {
+            if (!run.empty() && (address != run_address + run.size() || run.size() + size > max_run)) {
+                f(run_address, run.data(), run.size());
+                run.clear();
+            }
+            if (run.empty()) {
+                run_address = address;
+            }
+            run.insert(run.end(), bytes, bytes + size);
+        });
+        if (!run.empty()) {
+            f(run_address, run.data(), run.size());
+        }
+        return ok;
+    }
+};
+
+HexReader::HexReader(const char *path) :
+    pimpl_{std::make_unique<impl>()}
+{
+    if (!pimpl_->file.open(path)) {
+        throw -1;
+    }
+    const char *p = reinterpret_cast<const char*>(pimpl_->file.data());
+    const char *end = p + pimpl_->file.size();
+    while (p < end && std::isspace(static_cast<unsigned char>(*p))) {
+        p++;
+    }
+    if (p == end || (*p != ':' && *p != 'S')) {
+        throw -1;
+    }
+    pimpl_->format = *p == ':' ? HexFormat::intel : HexFormat::srecord;
+}
+
+HexReader::~HexReader() = default;
+
+HexFormat HexReader::format() const
+{
+    return pimpl_->format;
+}
+
+bool HexReader::read(DataFn const& f)
+{
+    return pimpl_->read(f);
+}
+
+// Records are copied straight into the memory, without joining them
+bool HexReader::read(uint8_t *bytes, size_t size, uint64_t base)
+{
+    auto &p = *pimpl_;
+    if (!p.validate()) {
+        return false;
+    }
+    uint64_t skipped = 0;
+    bool ok = p.parse([&](uint64_t address, const uint8_t *data, size_t count) {
+        const size_t total = count;
+        if (clip(base, size, address, data, count)) {
+            std::memcpy(bytes + address, data, count);
+        } else {
+            count = 0;
+        }
+        skipped += total - count;
+    });
+    p.skipped = skipped;
+    return ok;
+}
+
+bool HexReader::read(SectorStore &store, uint64_t base)
+{
+    return read(store.bytes().data(), store.size(), base);
+}
+
+bool HexReader::read(SparseSectorStore &store, uint64_t base)
+{
+    uint64_t skipped = 0;
+    bool ok = pimpl_->read([&](uint64_t address, const uint8_t *data, size_t count) {
+        const size_t total = count;
+        if (clip(base, store.size(), address, data, count)) {
+            store.write(static_cast<size_t>(address), data, count);
+        } else {
+            count = 0;
+        }
+        skipped += total - count;
+    });
+    pimpl_->skipped = skipped;
+    return ok;
+}
+
+size_t HexReader::error_line() const
+{
+    return pimpl_->error_line;
+}
+
+const char* HexReader::error() const
+{
+    return pimpl_->error;
+}
+
+uint64_t HexReader::bytes_read() const
+{
+    return pimpl_->bytes_read;
+}
+
+uint64_t HexReader::skipped() const
+{
+    return pimpl_->skipped;
+}
+
+bool HexReader::has_start_address() const
+{
+    return pimpl_->has_start_address;
+}
+
+uint64_t HexReader::start_address() const
+{
+    return pimpl_->start_address;
+}
+
+struct HexWriter::impl
+{
+    static constexpr size_t buffer_size = 64 << 10;
+
+    std::FILE *file = nullptr;
+    HexFormat format;
+    size_t record_size;
+    std::vector<char> buffer;
+    size_t used = 0;
+    bool ok = true;
+    int skip = -1;
+    bool has_start_address = false;
+    uint64_t start_address = 0;
+    // Upper 16 bits of the last extended linear address record
+    uint64_t upper = 0;
+    // Widest S-record address so far, which sets the end record
+    size_t address_size = 2;
+    size_t data_records = 0;
+
+    void flush()
+    {
+        if (used > 0 && std::fwrite(buffer.data(), 1, used, file) != used) {
+            ok = false;
+        }
+        used = 0;
+    }
+
+    // Writes one line of the header bytes and data, followed by the checksum
+    void record(const char *start, const uint8_t *header, size_t header_size, const uint8_t *data, size_t size)
+    {
+        const size_t start_size = std::strlen(start);
+        const size_t line_size = start_size + 2 * (header_size + size + 1) + 1;
+        if (used + line_size > buffer.size()) {
+            flush();
+        }
+        char *out = buffer.data() + used;
+        std::memcpy(out, start, start_size);
+        out += start_size;
+        encode_hex(header, header_size, out);
+        out += 2 * header_size;
+        encode_hex(data, size, out);
+        out += 2 * size;
+        uint8_t sum = static_cast<uint8_t>(byte_sum(header, header_size) + byte_sum(data, size));
+        sum = format == HexFormat::intel ? static_cast<uint8_t>(-sum) : static_cast<uint8_t>(~sum);
+        encode_hex(&sum, 1, out);
+        out[2] = '\n';
+        used += line_size;
+    }
+
+    void intel(uint8_t type, uint16_t address, const uint8_t *data, size_t size)
+    {
+        const uint8_t header[] = {static_cast<uint8_t>(size), static_cast<uint8_t>(address >> 8), static_cast<uint8_t>(address), type};
+        record(":", header, sizeof(header), data, size);
+    }
+
+    void srecord(int type, size_t address_bytes, uint64_t address, const uint8_t *data, size_t size)
+    {
+        uint8_t header[5];
+        header[0] = static_cast<uint8_t>(address_bytes + size + 1);
+        for (size_t i = 0; i < address_bytes; i++) {
+            header[1 + i] = static_cast<uint8_t>(address >> (8 * (address_bytes - 1 - i)));
+        }
+        const char start[] = {'S', static_cast<char>('0' + type), '\0'};
+        record(start, header, 1 + address_bytes, data, size);
+    }
+
+    bool write(uint64_t address, const uint8_t *bytes, size_t size)
+    {
+        if (file == nullptr || (size > 0 && address + size - 1 > 0xFFFFFFFFull)) {
+            return false;
+        }
+        while (size > 0) {
+            size_t count = std::min(size, record_size);
+            if (format == HexFormat::intel) {
+                // Records do not cross 64 KiB boundaries
+                count = std::min<size_t>(count, 0x10000 - (address & 0xFFFF));
+            }
+            const bool erased = skip >= 0 && bytes[0] == skip && std::memcmp(bytes, bytes + 1, count - 1) == 0;
+            if (!erased && format == HexFormat::intel) {
+                if ((address >> 16) != upper) {
+                    upper = address >> 16;
+                    const uint8_t data[] = {static_cast<uint8_t>(upper >> 8), static_cast<uint8_t>(upper)};
+                    intel(4, 0, data, sizeof(data));
+                }
+                intel(0, static_cast<uint16_t>(address), bytes, count);
+            } else if (!erased) {
+                const uint64_t last = address + count - 1;
+                const size_t bytes_needed = last <= 0xFFFF ? 2 : last <= 0xFFFFFF ? 3 : 4;
+                address_size = std::max(address_size, bytes_needed);
+                srecord(static_cast<int>(bytes_needed - 1), bytes_needed, address, bytes, count);
+                data_records++;
+            }
+            address += count;
+            bytes += count;
+            size -= count;
+        }
+        return ok;
+    }
+
+    bool finish()
+    {
+        if (file == nullptr) {
+            return ok;
+        }
+        if (format == HexFormat::intel) {
+            if (has_start_address && start_address <= 0xFFFFFFFFull) {
+                const uint8_t data[] = {static_cast<uint8_t>(start_address >> 24), static_cast<uint8_t>(start_address >> 16),
+                                        static_cast<uint8_t>(start_address >> 8), static_cast<uint8_t>(start_address)};
+                intel(5, 0, data, sizeof(data));
+            }
+            intel(1, 0, nullptr, 0);
+        } else {
+            if (data_records <= 0xFFFFFF) {
+                srecord(data_records <= 0xFFFF ? 5 : 6, data_records <= 0xFFFF ? 2 : 3, data_records, nullptr, 0);
+            }
+            // S9, S8 and S7 go with S1, S2 and S3 data records
+            srecord(static_cast<int>(11 - address_size), address_size, has_start_address ? start_address : 0, nullptr, 0);
+        }
+        flush();
+        ok = std::fclose(file) == 0 && ok;
+        file = nullptr;
+        return ok;
+    }
+};
+
+HexWriter::HexWriter(const char *path, HexFormat format, size_t record_size) :
+    pimpl_{std::make_unique<impl>()}
+{
+    auto &p = *pimpl_;
+    p.format = format;
+    // Intel records hold up to 255 bytes, S-records 255 with the address and checksum
+    p.record_size = std::max<size_t>(1, std::min<size_t>(record_size, format == HexFormat::intel ? 255 : 250));
+    p.buffer.resize(impl::buffer_size);
+    p.file = std::fopen(path, "wb");
+    if (p.file == nullptr) {
+        throw -1;
+    }
+    if (format == HexFormat::srecord) {
+        p.srecord(0, 2, 0, nullptr, 0);
+    }
+}
+
+HexWriter::~HexWriter()
+{
+    pimpl_->finish();
+}
+
+HexWriter& HexWriter::skip(uint8_t value)
+{
+    pimpl_->skip = value;
+    return *this;
+}
+
+HexWriter& HexWriter::start_address(uint64_t address)
+{
+    pimpl_->has_start_address = true;
+    pimpl_->start_address = address;
+    return *this;
+}
+
+bool HexWriter::write(uint64_t address, const uint8_t *bytes, size_t size)
+{
+    return pimpl_->write(address, bytes, size);
+}
+
+bool HexWriter::write(SectorStore const& store, uint64_t base)
+{
+    const int skip = pimpl_->skip;
+    pimpl_->skip = store.erased_value();
+    bool ok = pimpl_->write(base, store.bytes().data(), store.size());
+    pimpl_->skip = skip;
+    return ok;
+}
+
+// Pages never written are erased, only the others are looked at
+bool HexWriter::write(SparseSectorStore const& store, uint64_t base)
+{
+    const int skip = pimpl_->skip;
+    pimpl_->skip = store.erased_value();
+    bool ok = true;
+    for (size_t page = 0; page < store.page_count() && ok; page++) {
+        if (store.is_allocated(page)) {
+            auto bytes = store.page(page);
+            ok = pimpl_->write(base + page * store.page_size(), bytes.data(), bytes.size());
+        }
+    }
+    pimpl_->skip = skip;
+    return ok;
+}
+
+bool HexWriter::finish()
+{
+    return pimpl_->finish();
+}
+
+HexFormat hex_format_of(const char *path)
+{
+    static const char *extensions[] = {".s19", ".s28", ".s37", ".srec", ".mot", ".s"};
+    const char *dot = std::strrchr(path, '.');
+    if (dot != nullptr) {
+        for (const char *extension : extensions) {
+            size_t i = 0;
+            while (extension[i] != '\0' && std::tolower(static_cast<unsigned char>(dot[i])) == extension[i]) {
+                i++;
+            }
+            if (extension[i] == '\0' && dot[i] == '\0') {
+                return HexFormat::srecord;
+            }
+        }
+    }
+    return HexFormat::intel;
+}
+
+float HexFilePanel::height()
+{
+    return ImGui::GetFrameHeightWithSpacing();
+}
+
+void HexFilePanel::draw(uint64_t base, size_t size, ReadFn const& read, WriteFn const& write, size_t highlight_begin, size_t highlight_end, int skip)
+{
+    ImGui::SetNextItemWidth(ImGui::CalcTextSize("0").x * 32);
+    ImGui::InputTextWithHint("##hexpath", "HEX or S-record file", path_, sizeof(path_));
+    if (write) {
+        ImGui::SameLine();
+        if (ImGui::Button("Import")) {
+            import_file(base, size, write);
+        }
+    }
+    ImGui::SameLine();
+    const bool range = highlight_end != static_cast<size_t>(-1) && highlight_begin < highlight_end && highlight_begin < size;
+    if (ImGui::Button(range ? "Export selection" : "Export")) {
+        export_file(base, range ? highlight_begin : 0, range ? std::min(highlight_end, size) : size, read, skip);
+    }
+    if (status_[0] != '\0') {
+        ImGui::SameLine();
+        ImGui::TextUnformatted(status_);
+    }
+}
+
+void HexFilePanel::import_file(uint64_t base, size_t size, WriteFn const& write)
+{
+    try {
+        HexReader reader{path_};
+        uint64_t skipped = 0;
+        bool ok = reader.read([&](uint64_t address, const uint8_t *bytes, size_t count) {
+            const size_t total = count;
+            if (clip(base, size, address, bytes, count)) {
+                write(static_cast<size_t>(address), bytes, count);
+            } else {
+                count = 0;
+            }
+            skipped += total - count;
+        });
+        if (!ok) {
+            snprintf(status_, sizeof(status_), "Line %zu: %s", reader.error_line(), reader.error());
+        } else if (skipped > 0) {
+            snprintf(status_, sizeof(status_), "Imported %llu bytes, %llu outside the memory",
+                static_cast<unsigned long long>(reader.bytes_read() - skipped), static_cast<unsigned long long>(skipped));
+        } else {
+            snprintf(status_, sizeof(status_), "Imported %llu bytes", static_cast<unsigned long long>(reader.bytes_read()));
+        }
+    } catch (int) {
+        snprintf(status_, sizeof(status_), "Cannot read %s", path_);
+    }
+}
+
+void HexFilePanel::export_file(uint64_t base, size_t begin, size_t end, ReadFn const& read, int skip)
+{
+    try {
+        HexWriter writer{path_, hex_format_of(path_)};
+        if (skip >= 0) {
+            writer.skip(static_cast<uint8_t>(skip));
+        }
+        std::vector<uint8_t> chunk(std::min(chunk_size, end - begin));
+        bool ok = true;
+        for (size_t offset = begin; offset < end && ok; offset += chunk.size()) {
+            const size_t count = std::min(chunk.size(), end - offset);
+            read(offset, chunk.data(), count);
+            ok = writer.write(base + offset, chunk.data(), count);
+        }
+        ok = writer.finish() && ok;
+        if (ok) {
+            snprintf(status_, sizeof(status_), "Exported %zu bytes", end - begin);
+        } else {
+            snprintf(status_, sizeof(status_), "Cannot write %s", path_);
+        }
+    } catch (int) {
+        snprintf(status_, sizeof(status_), "Cannot create %s", path_);
+    }
+}
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <gui/gui.h>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace guicpp
+{
+
+// Files ending in .s19, .s28, .s37, .srec, .mot or .s are S-records, anything else Intel HEX
+HexFormat hex_format_of(const char *path);
+
+// Import and Export line below a memory editor, for a memory of size bytes at base in the files.
+// Imports write the records inside the memory, exports cover the highlighted range of the editor
+// (highlight_end is -1 when there is none) or the whole memory.
+class HexFilePanel
+{
+public:
+    using ReadFn = std::function<void(size_t offset, uint8_t *out, size_t size)>;
+    // Empty for read-only memories
+    using WriteFn = std::function<void(size_t offset, const uint8_t *in, size_t size)>;
+
+    static float height();
+
+    // skip is the value of erased bytes whose records are not exported, or -1
+    void draw(uint64_t base, size_t size, ReadFn const& read, WriteFn const& write, size_t highlight_begin, size_t highlight_end, int skip = -1);
+
+private:
+    // Exports are read from the memory in chunks of a multiple of the record size
+    static constexpr size_t chunk_size = 64 << 10;
+
+    void import_file(uint64_t base, size_t size, WriteFn const& write);
+    void export_file(uint64_t base, size_t begin, size_t end, ReadFn const& read, int skip);
+
+    char path_[260] = {};
+    char status_[160] = {};
+};
+
+}
@@ -38,6 +38,18 @@
 // - v0.42 (2020/10/14): fix for . character in ASCII view always being greyed out.
 // - v0.43 (2021/03/12): added OptFooterExtraHeight to allow for custom drawing at the bottom of the editor [@leiradel]
 // - v0.44 (2021/03/12): use ImGuiInputTextFlags_AlwaysOverwrite in 1.82 + fix hardcoded width.
+// - guicpp: format rows with lookup tables instead of sprintf and draw each row's hex/ascii as single text runs.
+// - guicpp: cache formatted rows keyed by a hash of their bytes, so unchanged rows are not formatted again.
+// - guicpp: 64-bit line numbers, with the scrolling region moved over huge memories; OnWriteFn notification.
+// - guicpp: DrawFooterFn, custom widgets in the OptFooterExtraHeight space of DrawWindow().
+// - guicpp: HeatRangeFn/HeatColor, background of recently changed bytes fading out.
+// - guicpp: PendingRangeFn, bytes not available yet are drawn as "??" placeholders.
+// - guicpp: LineLabelFn/OptLabelChars, a label column right of the ASCII column also showing the label at the cursor in the options line; GotoNameFn.
+// - guicpp: range selection (drag or shift-click) in HighlightMin/HighlightMax, with copy/paste of hex or text, pattern fill and file import
+//   in the right-click menu. Bulk edits are parsed with SSE2 and written as one range.
+// - guicpp: InsertRangeFn/EraseRangeFn, inserting hex, text or a pattern and deleting the selection (Delete key), applied at the end of the frame.
+// - guicpp: DrawSideFn, custom drawing in an OptSideExtraWidth column right of the rows, told the visible range.
+// - guicpp: ReadRangeFn/WriteRangeFn/HighlightRangeFn. Visible bytes are read once per frame into a snapshot, writes are coalesced and applied at the end of the frame.
 //
 // Todo/Bugs:
 // - This is generally old code, it should work but please don't use this as reference!
@@ -48,6 +60,12 @@
 
 #include <stdio.h>      // sprintf, scanf
 #include <stdint.h>     // uint8_t, etc.
+#include <string.h>     // memcpy, memset
+#include "file_io.h"    // file_seek, file_size
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IMGUI_MEMORY_EDITOR_SSE2
+#include <emmintrin.h>
+#endif
 
 #ifdef _MSC_VER
 #define _PRISizeT   "I"
@@ -85,10 +103,26 @@ struct MemoryEditor
     int             OptMidColsCount;                            // = 8      // set to 0 to disable extra spacing between every mid-cols.
     int             OptAddrDigitsCount;                         // = 0      // number of addr digits to display (default calculated based on maximum displayed addr).
     float           OptFooterExtraHeight;                       // = 0      // space to reserve at the bottom of the widget to add custom widgets
+    float           OptSideExtraWidth;                          // = 0      // space to reserve right of the rows for DrawSideFn
+    int             OptLabelChars;                              // = 24     // width of the label column in characters, when LineLabelFn is set.
     ImU32           HighlightColor;                             //          // background color of highlighted bytes.
+    ImU32           HeatColor;                                  //          // background color of bytes with heat 1, scaled down by their heat.
     ImU8            (*ReadFn)(const ImU8* data, size_t off);    // = 0      // optional handler to read bytes.
     void            (*WriteFn)(ImU8* data, size_t off, ImU8 d); // = 0      // optional handler to write bytes.
     bool            (*HighlightFn)(const ImU8* data, size_t off);//= 0      // optional handler to return Highlight property (to support non-contiguous highlighting).
+    void            (*ReadRangeFn)(void* user_data, size_t off, ImU8* out, size_t size);        // = 0 // optional handler to read a range of bytes, called once per frame for the visible rows. takes precedence over ReadFn.
+    void            (*WriteRangeFn)(void* user_data, size_t off, const ImU8* in, size_t size);  // = 0 // optional handler to write a range of bytes. takes precedence over WriteFn.
+    void            (*HighlightRangeFn)(void* user_data, size_t off, bool* out, size_t size);   // = 0 // optional handler to fill the Highlight property of a range. takes precedence over HighlightFn.
+    void            (*HeatRangeFn)(void* user_data, size_t off, float* out, size_t size);      // = 0 // optional handler to fill a 0..1 heat per byte, e.g. how recently it changed.
+    void            (*PendingRangeFn)(void* user_data, size_t off, bool* out, size_t size);     // = 0 // optional handler to flag bytes that are not available yet (e.g. still being fetched), drawn as placeholders.
+    void            (*OnWriteFn)(void* user_data, size_t off, size_t size); // = 0 // optional notification after bytes were written.
+    void            (*DrawFooterFn)(void* user_data);           // = 0      // optional handler drawing custom widgets in the OptFooterExtraHeight space, called by DrawWindow().
+    void            (*DrawSideFn)(void* user_data, size_t visible_begin, size_t visible_end); // = 0 // optional handler drawing in a child of OptSideExtraWidth right of the rows and as high, e.g. a minimap.
+    const char*     (*LineLabelFn)(void* user_data, size_t off, size_t size, bool* dim); // = 0 // optional handler labelling a range (e.g. with the symbol there), NULL for none. called once per visible row and once for the cursor.
+    bool            (*GotoNameFn)(void* user_data, const char* name, size_t* off); // = 0 // optional handler resolving what is typed in the goto field, tried first. addresses then need a 0x prefix.
+    void            (*InsertRangeFn)(void* user_data, size_t off, const ImU8* in, size_t size); // = 0 // optional handler inserting bytes before off, for memories that can grow. enables the insert menu entries.
+    void            (*EraseRangeFn)(void* user_data, size_t off, size_t size); // = 0 // optional handler deleting bytes, for memories that can shrink. enables deleting the selection.
+    void*           UserData;                                   // = 0      // passed to the range handlers, OnWriteFn and DrawFooterFn.
 
     // [Internal State]
     bool            ContentsWidthChanged;
@@ -96,12 +130,46 @@ struct MemoryEditor
     size_t          DataEditingAddr;
     bool            DataEditingTakeFocus;
     char            DataInputBuf[32];
-    char            AddrInputBuf[32];
+    char            AddrInputBuf[128];
+    char            FillInputBuf[64];
+    char            ImportPathBuf[260];
     size_t          GotoAddr;
+    size_t          ViewLineBase;                               // first line of the scrolling region, see ViewMaxLines
+    size_t          PendingViewLineBase;
+    size_t          VisibleStartAddr;
     size_t          HighlightMin, HighlightMax;
+    ImVector<ImU8>  Snapshot;                                   // visible bytes, read once per frame
+    ImVector<bool>  SnapshotHighlight;                          // one extra entry past the visible bytes, for joining highlights
+    ImVector<bool>  SnapshotPending;                            // empty when PendingRangeFn is not set
+    ImVector<float> SnapshotHeat;                               // empty when HeatRangeFn is not set
+    size_t          SnapshotAddr;
+    ImVector<ImU8>  PendingWrite;                               // contiguous bytes written this frame
+    size_t          PendingWriteAddr;
+    size_t          SelectAnchor;                               // first byte clicked, the selection extends from it
+    bool            SelectDragging;
+    ImVector<ImU8>  BulkBytes;                                  // bytes of the last bulk edit or copy
+    ImVector<char>  BulkText;
+    const char*     BulkError;                                  // why the last bulk edit failed, or NULL
+    size_t          PendingEditAddr;                            // insert or erase applied by ApplyEdit() at the end of the frame, (size_t)-1 when none
+    size_t          PendingEraseSize;                           // 0 for an insert of PendingInsert
+    ImVector<ImU8>  PendingInsert;
     int             PreviewEndianess;
     ImGuiDataType   PreviewDataType;
 
+    // Formatted text of recently drawn rows, direct-mapped by line number and validated by a hash of the row's bytes
+    struct LineCacheEntry
+    {
+        size_t  Line;           // (size_t)-1 when empty
+        int     EditingN;       // column left blank for the InputText, or -1
+        ImU64   Hash;
+        bool    HasDisabled;
+        int     TextOffset;     // hex, hex disabled, ascii, ascii disabled texts in LineCacheText
+    };
+    ImVector<LineCacheEntry> LineCache;
+    ImVector<char>  LineCacheText;
+    ImU64           LineCacheKey;
+    int             LineCacheStride;
+
     MemoryEditor()
     {
         // Settings
@@ -117,10 +185,26 @@ struct MemoryEditor
         OptMidColsCount = 8;
         OptAddrDigitsCount = 0;
         OptFooterExtraHeight = 0.0f;
+        OptSideExtraWidth = 0.0f;
+        OptLabelChars = 24;
         HighlightColor = IM_COL32(255, 255, 255, 50);
+        HeatColor = IM_COL32(255, 96, 0, 160);
         ReadFn = NULL;
         WriteFn = NULL;
         HighlightFn = NULL;
+        ReadRangeFn = NULL;
+        WriteRangeFn = NULL;
+        HighlightRangeFn = NULL;
+        HeatRangeFn = NULL;
+        PendingRangeFn = NULL;
+        OnWriteFn = NULL;
+        DrawFooterFn = NULL;
+        DrawSideFn = NULL;
+        LineLabelFn = NULL;
+        GotoNameFn = NULL;
+        InsertRangeFn = NULL;
+        EraseRangeFn = NULL;
+        UserData = NULL;
 
         // State/Internals
         ContentsWidthChanged = false;
@@ -129,9 +213,23 @@ struct MemoryEditor
         memset(DataInputBuf, 0, sizeof(DataInputBuf));
         memset(AddrInputBuf, 0, sizeof(AddrInputBuf));
         GotoAddr = (size_t)-1;
+        ViewLineBase = 0;
+        PendingViewLineBase = (size_t)-1;
+        VisibleStartAddr = 0;
         HighlightMin = HighlightMax = (size_t)-1;
+        SnapshotAddr = 0;
+        PendingWriteAddr = 0;
+        FillInputBuf[0] = 0;
+        ImportPathBuf[0] = 0;
+        SelectAnchor = (size_t)-1;
+        SelectDragging = false;
+        BulkError = NULL;
+        PendingEditAddr = (size_t)-1;
+        PendingEraseSize = 0;
         PreviewEndianess = 0;
         PreviewDataType = ImGuiDataType_S32;
+        LineCacheKey = 0;
+        LineCacheStride = 0;
     }
 
     void GotoAddrAndHighlight(size_t addr_min, size_t addr_max)
@@ -141,6 +239,348 @@ struct MemoryEditor
         HighlightMax = addr_max;
     }
 
+    static ImU32 ScaleAlpha(ImU32 col, float f)
+    {
+        const ImU32 alpha = (ImU32)(((col >> IM_COL32_A_SHIFT) & 0xFF) * f);
+        return (col & ~IM_COL32_A_MASK) | (alpha << IM_COL32_A_SHIFT);
+    }
+
+    void ReadBytes(const ImU8* mem_data, size_t off, ImU8* out, size_t size) const
+    {
+        if (ReadRangeFn)
+            ReadRangeFn(UserData, off, out, size);
+        else if (ReadFn)
+            for (size_t i = 0; i < size; i++)
+                out[i] = ReadFn(mem_data, off + i);
+        else
+            memcpy(out, mem_data + off, size);
+    }
+
+    // Reads [addr, end) and its highlight flags in one go, so the whole frame is drawn from a consistent copy
+    void TakeSnapshot(const ImU8* mem_data, size_t mem_size, size_t addr, size_t end)
+    {
+        const size_t size = end - addr;
+        const size_t highlight_size = end < mem_size ? size + 1 : size;
+        Snapshot.resize((int)size);
+        SnapshotHighlight.resize((int)highlight_size);
+        SnapshotAddr = addr;
+        if (size > 0)
+            ReadBytes(mem_data, addr, Snapshot.Data, size);
+        if (HighlightRangeFn)
+            HighlightRangeFn(UserData, addr, SnapshotHighlight.Data, highlight_size);
+        else if (HighlightFn)
+            for (size_t i = 0; i < highlight_size; i++)
+                SnapshotHighlight[(int)i] = HighlightFn(mem_data, addr + i);
+        else if (highlight_size > 0)
+            memset(SnapshotHighlight.Data, 0, highlight_size * sizeof(bool));
+        SnapshotHeat.resize(HeatRangeFn ? (int)size : 0);
+        if (HeatRangeFn && size > 0)
+            HeatRangeFn(UserData, addr, SnapshotHeat.Data, size);
+        SnapshotPending.resize(PendingRangeFn ? (int)size : 0);
+        if (PendingRangeFn && size > 0)
+        {
+            memset(SnapshotPending.Data, 0, size * sizeof(bool));
+            PendingRangeFn(UserData, addr, SnapshotPending.Data, size);
+        }
+    }
+
+    // Writes are collected into one contiguous range and applied by FlushWrites()
+    void QueueWrite(ImU8* mem_data, size_t off, const ImU8* in, size_t size)
+    {
+        if (PendingWrite.Size > 0 && off != PendingWriteAddr + PendingWrite.Size)
+            FlushWrites(mem_data);
+        if (PendingWrite.Size == 0)
+            PendingWriteAddr = off;
+        PendingWrite.resize(PendingWrite.Size + (int)size);
+        memcpy(PendingWrite.Data + PendingWrite.Size - size, in, size);
+        const size_t snapshot_end = SnapshotAddr + (size_t)Snapshot.Size;
+        const size_t begin = off > SnapshotAddr ? off : SnapshotAddr;
+        const size_t end = off + size < snapshot_end ? off + size : snapshot_end;
+        if (begin < end)
+            memcpy(Snapshot.Data + (begin - SnapshotAddr), in + (begin - off), end - begin);
+    }
+
+    void FlushWrites(ImU8* mem_data)
+    {
+        if (PendingWrite.Size == 0)
+            return;
+        const size_t off = PendingWriteAddr;
+        const size_t size = (size_t)PendingWrite.Size;
+        if (WriteRangeFn)
+            WriteRangeFn(UserData, off, PendingWrite.Data, size);
+        else if (WriteFn)
+            for (size_t i = 0; i < size; i++)
+                WriteFn(mem_data, off + i, PendingWrite[(int)i]);
+        else
+            memcpy(mem_data + off, PendingWrite.Data, size);
+        PendingWrite.resize(0);
+        if (OnWriteFn)
+            OnWriteFn(UserData, off, size);
+    }
+
+    // Bigger selections are not copied to the clipboard
+    enum { BulkCopyMax = 64 << 20 };
+
+    void Select(size_t a, size_t b)
+    {
+        HighlightMin = a < b ? a : b;
+        HighlightMax = (a < b ? b : a) + 1;
+    }
+
+    bool HasSelection() const
+    {
+        return HighlightMax != (size_t)-1 && HighlightMin < HighlightMax;
+    }
+
+    // Pasted and imported bytes go into the selection, or from the cursor to the end of the memory
+    bool BulkTarget(size_t mem_size, size_t& off, size_t& size) const
+    {
+        off = HasSelection() ? HighlightMin : DataEditingAddr != (size_t)-1 ? DataEditingAddr : DataPreviewAddr;
+        if (off >= mem_size)
+            return false;
+        size = HasSelection() && HighlightMax < mem_size ? HighlightMax - off : mem_size - off;
+        return true;
+    }
+
+    // Bulk edits are queued as one range and flushed at once, the written bytes are left selected
+    void WriteBulk(ImU8* mem_data, size_t off, const ImU8* in, size_t size)
+    {
+        BulkError = NULL;
+        if (size == 0)
+            return;
+        QueueWrite(mem_data, off, in, size);
+        FlushWrites(mem_data);
+        HighlightMin = SelectAnchor = off;
+        HighlightMax = off + size;
+    }
+
+    void CopySelection(const ImU8* mem_data, size_t mem_size, bool hex)
+    {
+        if (!HasSelection() || HighlightMin >= mem_size)
+            return;
+        const size_t size = (HighlightMax < mem_size ? HighlightMax : mem_size) - HighlightMin;
+        if (size > BulkCopyMax)
+        {
+            BulkError = "Selection too large to copy";
+            return;
+        }
+        BulkBytes.resize((int)size);
+        ReadBytes(mem_data, HighlightMin, BulkBytes.Data, size);
+        const char* hex_pairs = HexPairs(OptUpperCaseHex);
+        BulkText.resize((int)(hex ? size * 3 : size + 1));
+        char* out = BulkText.Data;
+        for (size_t i = 0; i < size; i++)
+        {
+            const ImU8 b = BulkBytes.Data[i];
+            if (hex)
+            {
+                out[0] = hex_pairs[b * 2];
+                out[1] = hex_pairs[b * 2 + 1];
+                out[2] = ' ';
+                out += 3;
+            }
+            else
+            {
+                *out++ = (b >= 32 && b < 128) ? (char)b : '.';
+            }
+        }
+        if (hex)
+            out--;
+        *out = 0;
+        ImGui::SetClipboardText(BulkText.Data);
+        BulkError = NULL;
+    }
+
+    // Hex is parsed into bytes, text is written as it is
+    void Paste(ImU8* mem_data, size_t mem_size, bool hex)
+    {
+        size_t off, size;
+        const char* text = ImGui::GetClipboardText();
+        if (ReadOnly || text == NULL || !BulkTarget(mem_size, off, size))
+            return;
+        const size_t len = strlen(text);
+        if (hex && !ParseHexBytes(text, len, BulkBytes))
+        {
+            BulkError = "Clipboard is not hexadecimal";
+            return;
+        }
+        if (!hex)
+        {
+            BulkBytes.resize((int)len);
+            memcpy(BulkBytes.Data, text, len);
+        }
+        WriteBulk(mem_data, off, BulkBytes.Data, (size_t)BulkBytes.Size < size ? (size_t)BulkBytes.Size : size);
+    }
+
+    // Fills and imports bigger than this are written a chunk at a time, ImVector sizes are ints
+    enum { BulkChunk = 16 << 20 };
+
+    void FillSelection(ImU8* mem_data, size_t mem_size)
+    {
+        ImVector<ImU8> pattern;
+        if (ReadOnly || !HasSelection() || HighlightMin >= mem_size)
+            return;
+        if (!ParseHexBytes(FillInputBuf, strlen(FillInputBuf), pattern) || pattern.Size == 0)
+        {
+            BulkError = "Pattern is not hexadecimal";
+            return;
+        }
+        const size_t off = HighlightMin;
+        const size_t size = (HighlightMax < mem_size ? HighlightMax : mem_size) - off;
+        // Whole patterns per chunk, so every chunk starts at the start of the pattern
+        const size_t chunk = (size_t)pattern.Size < BulkChunk ? BulkChunk - BulkChunk % (size_t)pattern.Size : (size_t)pattern.Size;
+        BulkError = NULL;
+        for (size_t done = 0; done < size; done += chunk)
+        {
+            const size_t n = size - done < chunk ? size - done : chunk;
+            BulkBytes.resize((int)n);
+            FillPattern(BulkBytes.Data, n, pattern.Data, (size_t)pattern.Size);
+            QueueWrite(mem_data, off + done, BulkBytes.Data, n);
+            FlushWrites(mem_data);
+        }
+        HighlightMin = SelectAnchor = off;
+        HighlightMax = off + size;
+    }
+
+    // Reads at most the target size from the start of the file
+    void ImportFile(ImU8* mem_data, size_t mem_size)
+    {
+        size_t off, size;
+        if (ReadOnly || !BulkTarget(mem_size, off, size))
+            return;
+        FILE* f = fopen(ImportPathBuf, "rb");
+        if (f == NULL)
+        {
+            BulkError = "Cannot open the file";
+            return;
+        }
+        const uint64_t file_size = guicpp::file_size(f);
+        if (file_size == guicpp::file_size_error || !guicpp::file_seek(f, 0))
+        {
+            fclose(f);
+            BulkError = "Cannot read the file";
+            return;
+        }
+        if (file_size < size)
+            size = (size_t)file_size;
+        BulkError = NULL;
+        size_t done = 0;
+        while (done < size)
+        {
+            const size_t n = size - done < BulkChunk ? size - done : (size_t)BulkChunk;
+            BulkBytes.resize((int)n);
+            if (fread(BulkBytes.Data, 1, n, f) != n)
+                break;
+            QueueWrite(mem_data, off + done, BulkBytes.Data, n);
+            FlushWrites(mem_data);
+            done += n;
+        }
+        fclose(f);
+        if (done != size)
+            BulkError = "Cannot read the file";
+        if (done > 0)
+        {
+            HighlightMin = SelectAnchor = off;
+            HighlightMax = off + done;
+        }
+    }
+
+    bool CanInsert() const { return !ReadOnly && InsertRangeFn != NULL; }
+    bool CanErase() const { return !ReadOnly && EraseRangeFn != NULL && HasSelection(); }
+
+    // Inserts go before the selection or the cursor, or at the end of the memory when there is neither
+    size_t InsertTarget(size_t mem_size) const
+    {
+        const size_t off = HasSelection() ? HighlightMin : DataEditingAddr != (size_t)-1 ? DataEditingAddr : DataPreviewAddr;
+        return off < mem_size ? off : mem_size;
+    }
+
+    // Inserts and deletes move every byte after them, so they wait for the end of the frame where
+    // the rows drawn with the old size are done. Queues the bytes in BulkBytes.
+    void QueueInsert(size_t off)
+    {
+        BulkError = NULL;
+        if (BulkBytes.Size == 0)
+            return;
+        PendingEditAddr = off;
+        PendingEraseSize = 0;
+        PendingInsert.swap(BulkBytes);
+    }
+
+    void QueueErase(size_t mem_size)
+    {
+        BulkError = NULL;
+        if (!CanErase() || HighlightMin >= mem_size)
+            return;
+        PendingEditAddr = HighlightMin;
+        PendingEraseSize = (HighlightMax < mem_size ? HighlightMax : mem_size) - HighlightMin;
+    }
+
+    void InsertClipboard(size_t mem_size, bool hex)
+    {
+        const char* text = ImGui::GetClipboardText();
+        if (!CanInsert() || text == NULL)
+            return;
+        const size_t len = strlen(text);
+        if (hex && !ParseHexBytes(text, len, BulkBytes))
+        {
+            BulkError = "Clipboard is not hexadecimal";
+            return;
+        }
+        if (!hex)
+        {
+            BulkBytes.resize((int)len);
+            memcpy(BulkBytes.Data, text, len);
+        }
+        QueueInsert(InsertTarget(mem_size));
+    }
+
+    // One copy of the fill pattern
+    void InsertPattern(size_t mem_size)
+    {
+        if (!CanInsert())
+            return;
+        if (!ParseHexBytes(FillInputBuf, strlen(FillInputBuf), BulkBytes) || BulkBytes.Size == 0)
+        {
+            BulkError = "Pattern is not hexadecimal";
+            return;
+        }
+        QueueInsert(InsertTarget(mem_size));
+    }
+
+    // Inserted bytes are left selected. Everything after the edit moved, which OnWriteFn is told.
+    void ApplyEdit(ImU8* mem_data, size_t mem_size)
+    {
+        if (PendingEditAddr == (size_t)-1)
+            return;
+        FlushWrites(mem_data);
+        const size_t off = PendingEditAddr;
+        size_t new_size;
+        PendingEditAddr = (size_t)-1;
+        if (PendingEraseSize > 0)
+        {
+            EraseRangeFn(UserData, off, PendingEraseSize);
+            new_size = mem_size - PendingEraseSize;
+            HighlightMin = HighlightMax = SelectAnchor = (size_t)-1;
+        }
+        else
+        {
+            const size_t size = (size_t)PendingInsert.Size;
+            InsertRangeFn(UserData, off, PendingInsert.Data, size);
+            new_size = mem_size + size;
+            HighlightMin = SelectAnchor = off;
+            HighlightMax = off + size;
+        }
+        DataEditingAddr = (size_t)-1;
+        DataPreviewAddr = off;
+        if (OnWriteFn && off < new_size)
+            OnWriteFn(UserData, off, new_size - off);
+    }
+
+    // ImGui scroll positions are floats and clipper counts are ints, so memories with more lines than this
+    // are shown through a scrolling region of ViewMaxLines lines starting at ViewLineBase, moved as the user scrolls.
+    enum { ViewMaxLines = 1 << 19 };
+
     struct Sizes
     {
         int     AddrDigitsCount;
@@ -152,7 +592,10 @@ struct MemoryEditor
         float   PosHexEnd;
         float   PosAsciiStart;
         float   PosAsciiEnd;
+        float   PosLabelStart;
+        float   PosLabelEnd;
         float   WindowWidth;
+        bool    Monospace;
 
         Sizes() { memset(this, 0, sizeof(*this)); }
     };
@@ -165,9 +608,21 @@ struct MemoryEditor
             for (size_t n = base_display_addr + mem_size - 1; n > 0; n >>= 4)
                 s.AddrDigitsCount++;
         s.LineHeight = ImGui::GetTextLineHeight();
-        s.GlyphWidth = ImGui::CalcTextSize("F").x + 1;                  // We assume the font is mono-space
-        s.HexCellWidth = (float)(int)(s.GlyphWidth * 2.5f);             // "FF " we include trailing space in the width to easily catch clicks everywhere
-        s.SpacingBetweenMidCols = (float)(int)(s.HexCellWidth * 0.25f); // Every OptMidColsCount columns we add a bit of extra spacing
+        const float glyph_width = ImGui::CalcTextSize("F").x;
+        s.Monospace = glyph_width == ImGui::CalcTextSize(" ").x && glyph_width == ImGui::CalcTextSize("W").x && glyph_width == ImGui::CalcTextSize("i").x;
+        if (s.Monospace)
+        {
+            // Cells are exactly "FF " so a whole row of text lines up with them and can be drawn in one run
+            s.GlyphWidth = glyph_width;
+            s.HexCellWidth = glyph_width * 3;
+            s.SpacingBetweenMidCols = glyph_width;
+        }
+        else
+        {
+            s.GlyphWidth = glyph_width + 1;
+            s.HexCellWidth = (float)(int)(s.GlyphWidth * 2.5f);             // "FF " we include trailing space in the width to easily catch clicks everywhere
+            s.SpacingBetweenMidCols = (float)(int)(s.HexCellWidth * 0.25f); // Every OptMidColsCount columns we add a bit of extra spacing
+        }
         s.PosHexStart = (s.AddrDigitsCount + 2) * s.GlyphWidth;
         s.PosHexEnd = s.PosHexStart + (s.HexCellWidth * Cols);
         s.PosAsciiStart = s.PosAsciiEnd = s.PosHexEnd;
@@ -178,7 +633,330 @@ struct MemoryEditor
                 s.PosAsciiStart += (float)((Cols + OptMidColsCount - 1) / OptMidColsCount) * s.SpacingBetweenMidCols;
             s.PosAsciiEnd = s.PosAsciiStart + Cols * s.GlyphWidth;
         }
-        s.WindowWidth = s.PosAsciiEnd + style.ScrollbarSize + style.WindowPadding.x * 2 + s.GlyphWidth;
+        s.PosLabelStart = s.PosLabelEnd = s.PosAsciiEnd;
+        if (LineLabelFn)
+        {
+            s.PosLabelStart = s.PosAsciiEnd + s.GlyphWidth * 2;
+            s.PosLabelEnd = s.PosLabelStart + OptLabelChars * s.GlyphWidth;
+        }
+        s.WindowWidth = s.PosLabelEnd + style.ScrollbarSize + style.WindowPadding.x * 2 + s.GlyphWidth;
+        if (DrawSideFn && OptSideExtraWidth > 0.0f)
+            s.WindowWidth += OptSideExtraWidth + style.ItemSpacing.x;
+    }
+
+    // "00".."FF" pairs for every byte value, indexed by byte * 2
+    static const char* HexPairs(bool upper_case)
+    {
+        struct Table
+        {
+            char Pairs[2][256 * 2];
+            Table()
+            {
+                for (int b = 0; b < 256; b++)
+                {
+                    Pairs[0][b * 2 + 0] = "0123456789abcdef"[b >> 4];
+                    Pairs[0][b * 2 + 1] = "0123456789abcdef"[b & 15];
+                    Pairs[1][b * 2 + 0] = "0123456789ABCDEF"[b >> 4];
+                    Pairs[1][b * 2 + 1] = "0123456789ABCDEF"[b & 15];
+                }
+            }
+        };
+        static const Table table;
+        return table.Pairs[upper_case ? 1 : 0];
+    }
+
+    // Writes "%0*X: " without going through sprintf. out must hold digits_count + 3 chars.
+    static void FormatAddress(char* out, size_t addr, int digits_count, const char* hex_pairs)
+    {
+        for (int i = digits_count - 1; i >= 0; i--, addr >>= 4)
+            out[i] = hex_pairs[(addr & 15) * 2 + 1];
+        out[digits_count] = ':';
+        out[digits_count + 1] = ' ';
+        out[digits_count + 2] = 0;
+    }
+
+    // Offset of column n in the row text, which has a space between mid-cols groups
+    int HexCellTextOffset(int n) const
+    {
+        return n * 3 + (OptMidColsCount > 0 ? n / OptMidColsCount : 0);
+    }
+
+    float HexCellPosX(const Sizes& s, int n) const
+    {
+        float byte_pos_x = s.PosHexStart + s.HexCellWidth * n;
+        if (OptMidColsCount > 0)
+            byte_pos_x += (float)(n / OptMidColsCount) * s.SpacingBetweenMidCols;
+        return byte_pos_x;
+    }
+
+    int HexCellFromPosX(const Sizes& s, float x) const
+    {
+        int n;
+        if (OptMidColsCount > 0)
+        {
+            const float group_width = s.HexCellWidth * OptMidColsCount + s.SpacingBetweenMidCols;
+            const int group = (int)(x / group_width);
+            const int col = (int)((x - group * group_width) / s.HexCellWidth);
+            n = group * OptMidColsCount + (col < OptMidColsCount ? col : OptMidColsCount - 1);
+        }
+        else
+        {
+            n = (int)(x / s.HexCellWidth);
+        }
+        return n < 0 ? 0 : n;
+    }
+
+    // 64-bit hash of a row's bytes. SSE2 folds 16 bytes per step with the xxh3 multiply-accumulate, varying the key per
+    // block so that swapped blocks hash differently; the tail and non-SSE2 targets use a scalar multiply-xor.
+    static ImU64 HashBytes(const ImU8* p, size_t n)
+    {
+        ImU64 h = 0x9E3779B97F4A7C15ull ^ (n * 0xC2B2AE3D27D4EB4Full);
+#ifdef IMGUI_MEMORY_EDITOR_SSE2
+        if (n >= 16)
+        {
+            __m128i acc = _mm_set_epi64x((long long)0x165667B19E3779F9ull, (long long)0x27D4EB2F165667C5ull);
+            __m128i key = _mm_set_epi64x((long long)0xBE4BA423396CFEB8ull, (long long)0x1CAD21F72C81017Cull);
+            const __m128i key_step = _mm_set_epi64x((long long)0x9E3779B97F4A7C15ull, (long long)0xC2B2AE3D27D4EB4Full);
+            for (; n >= 16; n -= 16, p += 16)
+            {
+                const __m128i v = _mm_loadu_si128((const __m128i*)p);
+                const __m128i x = _mm_xor_si128(v, key);
+                const __m128i product = _mm_mul_epu32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+                acc = _mm_add_epi64(acc, _mm_add_epi64(product, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2))));
+                key = _mm_add_epi64(key, key_step);
+            }
+            ImU64 lanes[2];
+            _mm_storeu_si128((__m128i*)lanes, acc);
+            h ^= lanes[0] * 0xFF51AFD7ED558CCDull + lanes[1];
+        }
+#endif
+        for (; n >= 8; n -= 8, p += 8)
+        {
+            ImU64 v;
+            memcpy(&v, p, 8);
+            h = (h ^ v) * 0x100000001B3ull;
+            h ^= h >> 29;
+        }
+        for (; n > 0; n--, p++)
+            h = (h ^ *p) * 0x100000001B3ull;
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        return h;
+    }
+
+#ifdef IMGUI_MEMORY_EDITOR_SSE2
+    // Nibble values of 16 characters, with a mask of the ones that are hexadecimal digits
+    static __m128i HexNibbles(__m128i v, int* digit_mask)
+    {
+        const __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        const __m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+        const __m128i is_letter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+        *digit_mask = _mm_movemask_epi8(_mm_or_si128(is_digit, is_letter));
+        return _mm_add_epi8(_mm_and_si128(v, _mm_set1_epi8(0x0F)), _mm_and_si128(is_letter, _mm_set1_epi8(9)));
+    }
+
+    static int HexSeparatorMask(__m128i v)
+    {
+        const __m128i separator = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8(','))),
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))));
+        return _mm_movemask_epi8(separator);
+    }
+#endif
+
+    static int HexDigitValue(char c)
+    {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    // Hexadecimal text to bytes. Bytes may be separated by whitespace or commas and prefixed with 0x. SSE2 converts runs of 16
+    // digits, and runs of 16 bytes each followed by one separator as copied by CopySelection(), at once; anything else goes
+    // through the scalar loop. Returns false on other characters or a lone digit.
+    static bool ParseHexBytes(const char* text, size_t len, ImVector<ImU8>& out)
+    {
+        out.resize(0);
+        out.reserve((int)(len / 2 + 8));
+        ImU8* dst = out.Data;
+        size_t i = 0;
+        while (i < len)
+        {
+#ifdef IMGUI_MEMORY_EDITOR_SSE2
+            if (len - i >= 16)
+            {
+                int digits;
+                const __m128i nibbles = HexNibbles(_mm_loadu_si128((const __m128i*)(text + i)), &digits);
+                if (digits == 0xFFFF)
+                {
+                    // Even characters are high nibbles, the low bytes of the 16-bit lanes
+                    const __m128i high = _mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00FF)), 4);
+                    _mm_storel_epi64((__m128i*)dst, _mm_packus_epi16(_mm_or_si128(high, _mm_srli_epi16(nibbles, 8)), _mm_setzero_si128()));
+                    dst += 8;
+                    i += 16;
+                    continue;
+                }
+            }
+            if (len - i >= 48)
+            {
+                ImU8 nibbles[48];
+                ImU64 digits = 0, separators = 0;
+                for (int k = 0; k < 3; k++)
+                {
+                    const __m128i v = _mm_loadu_si128((const __m128i*)(text + i + k * 16));
+                    int digit_mask;
+                    _mm_storeu_si128((__m128i*)(nibbles + k * 16), HexNibbles(v, &digit_mask));
+                    digits |= (ImU64)digit_mask << (k * 16);
+                    separators |= (ImU64)HexSeparatorMask(v) << (k * 16);
+                }
+                if (digits == 0x6DB6DB6DB6DBull && separators == 0x924924924924ull)
+                {
+                    for (int k = 0; k < 16; k++)
+                        dst[k] = (ImU8)(nibbles[k * 3] << 4 | nibbles[k * 3 + 1]);
+                    dst += 16;
+                    i += 48;
+                    continue;
+                }
+            }
+#endif
+            const char c = text[i];
+            if (c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == ',')
+            {
+                i++;
+                continue;
+            }
+            if (c == '0' && i + 1 < len && (text[i + 1] == 'x' || text[i + 1] == 'X'))
+                i += 2;
+            const int high = i < len ? HexDigitValue(text[i]) : -1;
+            const int low = i + 1 < len ? HexDigitValue(text[i + 1]) : -1;
+            if (high < 0 || low < 0)
+                return false;
+            *dst++ = (ImU8)(high << 4 | low);
+            i += 2;
+        }
+        out.resize((int)(dst - out.Data));
+        return true;
+    }
+
+    // Repeats pattern over out, doubling the filled part so that the copies are large memcpy() calls
+    static void FillPattern(ImU8* out, size_t size, const ImU8* pattern, size_t pattern_size)
+    {
+        if (pattern_size == 1)
+        {
+            memset(out, pattern[0], size);
+            return;
+        }
+        size_t filled = pattern_size < size ? pattern_size : size;
+        memcpy(out, pattern, filled);
+        while (filled < size)
+        {
+            const size_t n = filled < size - filled ? filled : size - filled;
+            memcpy(out + filled, out, n);
+            filled += n;
+        }
+    }
+
+    // Sizes the cache for the visible rows and drops it when anything affecting the row text changed
+    void PrepareLineCache(int visible_lines, int hex_text_len)
+    {
+        int slots = 64;
+        while (slots < visible_lines * 2)
+            slots *= 2;
+        const int stride = hex_text_len * 2 + Cols * 2;
+        const ImU64 key = (ImU64)(ImU32)Cols | ((ImU64)(ImU16)OptMidColsCount << 32) |
+            ((ImU64)OptUpperCaseHex << 48) | ((ImU64)OptShowHexII << 49) | ((ImU64)OptGreyOutZeroes << 50);
+        if (LineCache.Size == slots && LineCacheKey == key && LineCacheStride == stride)
+            return;
+        LineCache.resize(slots);
+        LineCacheText.resize(slots * stride);
+        for (int i = 0; i < slots; i++)
+        {
+            LineCache[i].Line = (size_t)-1;
+            LineCache[i].TextOffset = i * stride;
+        }
+        LineCacheKey = key;
+        LineCacheStride = stride;
+    }
+
+    // pending flags bytes to draw as placeholders, it may be NULL. Rows with placeholders are not kept in the cache.
+    const LineCacheEntry& FormatLine(const ImU8* bytes, const bool* pending, size_t line_i, int line_cols, int editing_n, int hex_text_len)
+    {
+        bool has_pending = false;
+        if (pending)
+            for (int n = 0; n < line_cols && !has_pending; n++)
+                has_pending = pending[n];
+        const ImU64 hash = HashBytes(bytes, (size_t)line_cols);
+        LineCacheEntry& entry = LineCache[(int)(line_i & (size_t)(LineCache.Size - 1))];
+        if (!has_pending && entry.Line == line_i && entry.Hash == hash && entry.EditingN == editing_n)
+            return entry;
+
+        entry.Line = line_i;
+        entry.Hash = hash;
+        entry.EditingN = editing_n;
+        entry.HasDisabled = false;
+        char* hex_text = &LineCacheText[entry.TextOffset];
+        char* hex_text_disabled = hex_text + hex_text_len;
+        char* ascii_text = hex_text_disabled + hex_text_len;
+        char* ascii_text_disabled = ascii_text + Cols;
+        memset(hex_text, ' ', (size_t)LineCacheStride);
+        const char* hex_pairs = HexPairs(OptUpperCaseHex);
+        for (int n = 0; n < line_cols; n++)
+        {
+            if (has_pending && pending[n])
+            {
+                ascii_text_disabled[n] = '?';
+                if (n != editing_n)
+                {
+                    const int offset = HexCellTextOffset(n);
+                    hex_text_disabled[offset] = hex_text_disabled[offset + 1] = '?';
+                    entry.HasDisabled = true;
+                }
+                continue;
+            }
+            const ImU8 b = bytes[n];
+            if (b < 32 || b >= 128)
+                ascii_text_disabled[n] = '.';
+            else
+                ascii_text[n] = (char)b;
+
+            // The byte being edited is drawn by the InputText
+            if (n == editing_n)
+                continue;
+            const int offset = HexCellTextOffset(n);
+            if (OptShowHexII)
+            {
+                if ((b >= 32 && b < 128))
+                {
+                    hex_text[offset] = '.';
+                    hex_text[offset + 1] = (char)b;
+                }
+                else if (b == 0xFF && OptGreyOutZeroes)
+                {
+                    hex_text_disabled[offset] = hex_text_disabled[offset + 1] = '#';
+                    entry.HasDisabled = true;
+                }
+                else if (b != 0x00)
+                {
+                    hex_text[offset] = hex_pairs[b * 2];
+                    hex_text[offset + 1] = hex_pairs[b * 2 + 1];
+                }
+            }
+            else
+            {
+                char* out = hex_text;
+                if (b == 0 && OptGreyOutZeroes)
+                {
+                    out = hex_text_disabled;
+                    entry.HasDisabled = true;
+                }
+                out[offset] = hex_pairs[b * 2];
+                out[offset + 1] = hex_pairs[b * 2 + 1];
+            }
+        }
+        if (has_pending)
+            entry.Line = (size_t)-1;
+        return entry;
     }
 
     // Standalone Memory Editor window
@@ -194,6 +972,8 @@ struct MemoryEditor
             if (ImGui::IsWindowHovered(ImGuiHoveredFlags_RootAndChildWindows) && ImGui::IsMouseReleased(ImGuiMouseButton_Right))
                 ImGui::OpenPopup("context");
             DrawContents(mem_data, mem_size, base_display_addr);
+            if (DrawFooterFn)
+                DrawFooterFn(UserData);
             if (ContentsWidthChanged)
             {
                 CalcSizes(s, mem_size, base_display_addr);
@@ -222,22 +1002,59 @@ struct MemoryEditor
             footer_height += height_separator + ImGui::GetFrameHeightWithSpacing() * 1;
         if (OptShowDataPreview)
             footer_height += height_separator + ImGui::GetFrameHeightWithSpacing() * 1 + ImGui::GetTextLineHeightWithSpacing() * 3;
-        ImGui::BeginChild("##scrolling", ImVec2(0, -footer_height), false, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoNav);
+        const bool draw_side = DrawSideFn && OptSideExtraWidth > 0.0f;
+        ImGui::BeginChild("##scrolling", ImVec2(draw_side ? -(OptSideExtraWidth + style.ItemSpacing.x) : 0.0f, -footer_height), false, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoNav);
         ImDrawList* draw_list = ImGui::GetWindowDrawList();
 
         ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(0, 0));
         ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(0, 0));
 
+        // The scroll target for a moved region was set last frame and has been applied by BeginChild() above
+        const size_t line_total_count = (mem_size + Cols - 1) / Cols;
+        if (PendingViewLineBase != (size_t)-1)
+        {
+            ViewLineBase = PendingViewLineBase;
+            PendingViewLineBase = (size_t)-1;
+        }
+        if (ViewLineBase + ViewMaxLines > line_total_count)
+            ViewLineBase = line_total_count > ViewMaxLines ? line_total_count - ViewMaxLines : 0;
+        const size_t view_line_count = line_total_count - ViewLineBase < ViewMaxLines ? line_total_count - ViewLineBase : (size_t)ViewMaxLines;
+
         // We are not really using the clipper API correctly here, because we rely on visible_start_addr/visible_end_addr for our scrolling function.
-        const int line_total_count = (int)((mem_size + Cols - 1) / Cols);
         ImGuiListClipper clipper;
-        clipper.Begin(line_total_count, s.LineHeight);
+        clipper.Begin((int)view_line_count, s.LineHeight);
         clipper.Step();
-        const size_t visible_start_addr = clipper.DisplayStart * Cols;
-        const size_t visible_end_addr = clipper.DisplayEnd * Cols;
+        const size_t visible_start_addr = (ViewLineBase + clipper.DisplayStart) * Cols;
+        const size_t visible_end_addr = (ViewLineBase + clipper.DisplayEnd) * Cols;
+        const int display_start = clipper.DisplayStart;
+        const int display_end = clipper.DisplayEnd;
+        VisibleStartAddr = visible_start_addr;
+        TakeSnapshot(mem_data, mem_size, visible_start_addr, visible_end_addr < mem_size ? visible_end_addr : mem_size);
 
         bool data_next = false;
 
+        // Taken before the byte being edited, whose InputText would copy or paste its own two digits
+        if (ImGui::IsWindowFocused() && ImGui::GetIO().KeyCtrl)
+        {
+            if (HasSelection() && ImGui::IsKeyPressed(ImGui::GetKeyIndex(ImGuiKey_C)))
+            {
+                CopySelection(mem_data, mem_size, true);
+                DataEditingAddr = (size_t)-1;
+            }
+            else if (!ReadOnly && ImGui::IsKeyPressed(ImGui::GetKeyIndex(ImGuiKey_V)))
+            {
+                Paste(mem_data, mem_size, true);
+                DataEditingAddr = (size_t)-1;
+            }
+        }
+        if (ImGui::IsWindowFocused() && CanErase() && ImGui::IsKeyPressed(ImGui::GetKeyIndex(ImGuiKey_Delete)))
+        {
+            QueueErase(mem_size);
+            DataEditingAddr = (size_t)-1;
+        }
+        if (!ImGui::IsMouseDown(0))
+            SelectDragging = false;
+
         if (ReadOnly || DataEditingAddr >= mem_size)
             DataEditingAddr = (size_t)-1;
         if (DataPreviewAddr >= mem_size)
@@ -258,7 +1075,7 @@ struct MemoryEditor
         if (data_editing_addr_next != (size_t)-1 && (data_editing_addr_next / Cols) != (data_editing_addr_backup / Cols))
         {
             // Track cursor movements
-            const int scroll_offset = ((int)(data_editing_addr_next / Cols) - (int)(data_editing_addr_backup / Cols));
+            const int scroll_offset = (data_editing_addr_next / Cols) < (data_editing_addr_backup / Cols) ? -1 : 1;
             const bool scroll_desired = (scroll_offset < 0 && data_editing_addr_next < visible_start_addr + Cols * 2) || (scroll_offset > 0 && data_editing_addr_next > visible_end_addr - Cols * 2);
             if (scroll_desired)
                 ImGui::SetScrollY(ImGui::GetScrollY() + scroll_offset * s.LineHeight);
@@ -272,134 +1089,180 @@ struct MemoryEditor
         const ImU32 color_text = ImGui::GetColorU32(ImGuiCol_Text);
         const ImU32 color_disabled = OptGreyOutZeroes ? ImGui::GetColorU32(ImGuiCol_TextDisabled) : color_text;
 
-        const char* format_address = OptUpperCaseHex ? "%0*" _PRISizeT "X: " : "%0*" _PRISizeT "x: ";
         const char* format_data = OptUpperCaseHex ? "%0*" _PRISizeT "X" : "%0*" _PRISizeT "x";
         const char* format_byte = OptUpperCaseHex ? "%02X" : "%02x";
-        const char* format_byte_space = OptUpperCaseHex ? "%02X " : "%02x ";
+        const char* hex_pairs = HexPairs(OptUpperCaseHex);
+
+        // Each row is formatted once into the line cache and drawn as one text run per color
+        const int hex_text_len = HexCellTextOffset(Cols - 1) + 3;
+        PrepareLineCache(clipper.DisplayEnd - clipper.DisplayStart, hex_text_len);
+        char addr_text[32];
 
         for (int line_i = clipper.DisplayStart; line_i < clipper.DisplayEnd; line_i++) // display only visible lines
         {
-            size_t addr = (size_t)(line_i * Cols);
-            ImGui::Text(format_address, s.AddrDigitsCount, base_display_addr + addr);
+            const size_t line = ViewLineBase + line_i;
+            const size_t line_addr = line * Cols;
+            const int line_cols = (mem_size - line_addr < (size_t)Cols) ? (int)(mem_size - line_addr) : Cols;
+            FormatAddress(addr_text, base_display_addr + line_addr, s.AddrDigitsCount, hex_pairs);
+            ImGui::TextUnformatted(addr_text);
+
+            const int editing_n = (DataEditingAddr >= line_addr && DataEditingAddr < line_addr + line_cols) ? (int)(DataEditingAddr - line_addr) : -1;
+            const ImU8* line_bytes = Snapshot.Data + (line_addr - SnapshotAddr);
+            const bool* line_highlight = SnapshotHighlight.Data + (line_addr - SnapshotAddr);
+            const bool* line_pending = SnapshotPending.Size > 0 ? SnapshotPending.Data + (line_addr - SnapshotAddr) : NULL;
+            const float* line_heat = SnapshotHeat.Size > 0 ? SnapshotHeat.Data + (line_addr - SnapshotAddr) : NULL;
+            const LineCacheEntry& line_text = FormatLine(line_bytes, line_pending, line, line_cols, editing_n, hex_text_len);
+            const char* hex_text = &LineCacheText[line_text.TextOffset];
+            const char* hex_text_disabled = hex_text + hex_text_len;
+            const char* ascii_text = hex_text_disabled + hex_text_len;
+            const char* ascii_text_disabled = ascii_text + Cols;
 
             // Draw Hexadecimal
-            for (int n = 0; n < Cols && addr < mem_size; n++, addr++)
+            ImGui::SameLine(s.PosHexStart);
+            const ImVec2 hex_pos = ImGui::GetCursorScreenPos();
+            const float hex_width = HexCellPosX(s, Cols - 1) + s.HexCellWidth - s.PosHexStart;
+            ImGui::Dummy(ImVec2(hex_width, s.LineHeight));
+            if (line_heat)
+                for (int n = 0; n < line_cols; n++)
+                    if (line_heat[n] > 0.0f)
+                    {
+                        const float byte_pos_x = hex_pos.x + HexCellPosX(s, n) - s.PosHexStart;
+                        draw_list->AddRectFilled(ImVec2(byte_pos_x, hex_pos.y), ImVec2(byte_pos_x + s.GlyphWidth * 2, hex_pos.y + s.LineHeight), ScaleAlpha(HeatColor, line_heat[n]));
+                    }
+            for (int n = 0; n < line_cols; n++)
             {
-                float byte_pos_x = s.PosHexStart + s.HexCellWidth * n;
-                if (OptMidColsCount > 0)
-                    byte_pos_x += (float)(n / OptMidColsCount) * s.SpacingBetweenMidCols;
-                ImGui::SameLine(byte_pos_x);
+                const size_t addr = line_addr + n;
 
                 // Draw highlight
                 bool is_highlight_from_user_range = (addr >= HighlightMin && addr < HighlightMax);
-                bool is_highlight_from_user_func = (HighlightFn && HighlightFn(mem_data, addr));
+                bool is_highlight_from_user_func = line_highlight[n];
                 bool is_highlight_from_preview = (addr >= DataPreviewAddr && addr < DataPreviewAddr + preview_data_type_size);
                 if (is_highlight_from_user_range || is_highlight_from_user_func || is_highlight_from_preview)
                 {
-                    ImVec2 pos = ImGui::GetCursorScreenPos();
+                    const float byte_pos_x = hex_pos.x + HexCellPosX(s, n) - s.PosHexStart;
                     float highlight_width = s.GlyphWidth * 2;
-                    bool is_next_byte_highlighted =  (addr + 1 < mem_size) && ((HighlightMax != (size_t)-1 && addr + 1 < HighlightMax) || (HighlightFn && HighlightFn(mem_data, addr + 1)));
+                    bool is_next_byte_highlighted =  (addr + 1 < mem_size) && ((HighlightMax != (size_t)-1 && addr + 1 < HighlightMax) || line_highlight[n + 1]);
                     if (is_next_byte_highlighted || (n + 1 == Cols))
                     {
                         highlight_width = s.HexCellWidth;
                         if (OptMidColsCount > 0 && n > 0 && (n + 1) < Cols && ((n + 1) % OptMidColsCount) == 0)
                             highlight_width += s.SpacingBetweenMidCols;
                     }
-                    draw_list->AddRectFilled(pos, ImVec2(pos.x + highlight_width, pos.y + s.LineHeight), HighlightColor);
+                    draw_list->AddRectFilled(ImVec2(byte_pos_x, hex_pos.y), ImVec2(byte_pos_x + highlight_width, hex_pos.y + s.LineHeight), HighlightColor);
                 }
-
-                if (DataEditingAddr == addr)
+            }
+            const bool has_disabled = line_text.HasDisabled;
+            if (s.Monospace)
+            {
+                draw_list->AddText(hex_pos, color_text, hex_text, hex_text + hex_text_len);
+                if (has_disabled)
+                    draw_list->AddText(hex_pos, color_disabled, hex_text_disabled, hex_text_disabled + hex_text_len);
+            }
+            else
+            {
+                for (int n = 0; n < line_cols; n++)
                 {
-                    // Display text input on current byte
-                    bool data_write = false;
-                    ImGui::PushID((void*)addr);
-                    if (DataEditingTakeFocus)
+                    const int offset = HexCellTextOffset(n);
+                    const ImVec2 pos(hex_pos.x + HexCellPosX(s, n) - s.PosHexStart, hex_pos.y);
+                    if (hex_text[offset] != ' ' || hex_text[offset + 1] != ' ')
+                        draw_list->AddText(pos, color_text, hex_text + offset, hex_text + offset + 2);
+                    else if (hex_text_disabled[offset] != ' ')
+                        draw_list->AddText(pos, color_disabled, hex_text_disabled + offset, hex_text_disabled + offset + 2);
+                }
+            }
+            // Click and drag, or click and shift-click, select a range
+            if (ImGui::IsWindowHovered(ImGuiHoveredFlags_AllowWhenBlockedByActiveItem) && ImGui::IsMouseHoveringRect(hex_pos, ImVec2(hex_pos.x + hex_width, hex_pos.y + s.LineHeight)))
+            {
+                const int n = HexCellFromPosX(s, ImGui::GetIO().MousePos.x - hex_pos.x);
+                const size_t addr = line_addr + (n < line_cols ? n : line_cols - 1);
+                if (ImGui::IsMouseClicked(0))
+                {
+                    if (ImGui::GetIO().KeyShift && SelectAnchor < mem_size)
+                        Select(SelectAnchor, addr);
+                    else
                     {
-                        ImGui::SetKeyboardFocusHere();
-                        ImGui::CaptureKeyboardFromApp(true);
-                        sprintf(AddrInputBuf, format_data, s.AddrDigitsCount, base_display_addr + addr);
-                        sprintf(DataInputBuf, format_byte, ReadFn ? ReadFn(mem_data, addr) : mem_data[addr]);
+                        SelectAnchor = addr;
+                        HighlightMin = HighlightMax = (size_t)-1;
                     }
-                    struct UserData
+                    SelectDragging = true;
+                }
+                else if (SelectDragging && (addr != SelectAnchor || HasSelection()))
+                {
+                    Select(SelectAnchor, addr);
+                }
+            }
+            if (!ReadOnly && ImGui::IsMouseClicked(0) && ImGui::IsWindowHovered() && ImGui::IsMouseHoveringRect(hex_pos, ImVec2(hex_pos.x + hex_width, hex_pos.y + s.LineHeight)))
+            {
+                const int n = HexCellFromPosX(s, ImGui::GetIO().MousePos.x - hex_pos.x);
+                if (n < line_cols && n != editing_n)
+                {
+                    DataEditingTakeFocus = true;
+                    data_editing_addr_next = line_addr + n;
+                }
+            }
+
+            if (editing_n >= 0)
+            {
+                // Display text input on current byte
+                const size_t addr = line_addr + editing_n;
+                ImGui::SameLine(HexCellPosX(s, editing_n));
+                bool data_write = false;
+                ImGui::PushID((void*)addr);
+                if (DataEditingTakeFocus)
+                {
+                    ImGui::SetKeyboardFocusHere();
+                    ImGui::CaptureKeyboardFromApp(true);
+                    sprintf(AddrInputBuf, format_data, s.AddrDigitsCount, base_display_addr + addr);
+                    sprintf(DataInputBuf, format_byte, line_bytes[editing_n]);
+                }
+                struct UserData
+                {
+                    // FIXME: We should have a way to retrieve the text edit cursor position more easily in the API, this is rather tedious. This is such a ugly mess we may be better off not using InputText() at all here.
+                    static int Callback(ImGuiInputTextCallbackData* data)
                     {
-                        // FIXME: We should have a way to retrieve the text edit cursor position more easily in the API, this is rather tedious. This is such a ugly mess we may be better off not using InputText() at all here.
-                        static int Callback(ImGuiInputTextCallbackData* data)
+                        UserData* user_data = (UserData*)data->UserData;
+                        if (!data->HasSelection())
+                            user_data->CursorPos = data->CursorPos;
+                        if (data->SelectionStart == 0 && data->SelectionEnd == data->BufTextLen)
                         {
-                            UserData* user_data = (UserData*)data->UserData;
-                            if (!data->HasSelection())
-                                user_data->CursorPos = data->CursorPos;
-                            if (data->SelectionStart == 0 && data->SelectionEnd == data->BufTextLen)
-                            {
-                                // When not editing a byte, always rewrite its content (this is a bit tricky, since InputText technically "owns" the master copy of the buffer we edit it in there)
-                                data->DeleteChars(0, data->BufTextLen);
-                                data->InsertChars(0, user_data->CurrentBufOverwrite);
-                                data->SelectionStart = 0;
-                                data->SelectionEnd = 2;
-                                data->CursorPos = 0;
-                            }
-                            return 0;
+                            // When not editing a byte, always rewrite its content (this is a bit tricky, since InputText technically "owns" the master copy of the buffer we edit it in there)
+                            data->DeleteChars(0, data->BufTextLen);
+                            data->InsertChars(0, user_data->CurrentBufOverwrite);
+                            data->SelectionStart = 0;
+                            data->SelectionEnd = 2;
+                            data->CursorPos = 0;
                         }
-                        char   CurrentBufOverwrite[3];  // Input
-                        int    CursorPos;               // Output
-                    };
-                    UserData user_data;
-                    user_data.CursorPos = -1;
-                    sprintf(user_data.CurrentBufOverwrite, format_byte, ReadFn ? ReadFn(mem_data, addr) : mem_data[addr]);
-                    ImGuiInputTextFlags flags = ImGuiInputTextFlags_CharsHexadecimal | ImGuiInputTextFlags_EnterReturnsTrue | ImGuiInputTextFlags_AutoSelectAll | ImGuiInputTextFlags_NoHorizontalScroll | ImGuiInputTextFlags_CallbackAlways;
+                        return 0;
+                    }
+                    char   CurrentBufOverwrite[3];  // Input
+                    int    CursorPos;               // Output
+                };
+                UserData user_data;
+                user_data.CursorPos = -1;
+                sprintf(user_data.CurrentBufOverwrite, format_byte, line_bytes[editing_n]);
+                ImGuiInputTextFlags flags = ImGuiInputTextFlags_CharsHexadecimal | ImGuiInputTextFlags_EnterReturnsTrue | ImGuiInputTextFlags_AutoSelectAll | ImGuiInputTextFlags_NoHorizontalScroll | ImGuiInputTextFlags_CallbackAlways;
 #if IMGUI_VERSION_NUM >= 18104
-                    flags |= ImGuiInputTextFlags_AlwaysOverwrite;
+                flags |= ImGuiInputTextFlags_AlwaysOverwrite;
 #else
-                    flags |= ImGuiInputTextFlags_AlwaysInsertMode;
+                flags |= ImGuiInputTextFlags_AlwaysInsertMode;
 #endif
-                    ImGui::SetNextItemWidth(s.GlyphWidth * 2);
-                    if (ImGui::InputText("##data", DataInputBuf, IM_ARRAYSIZE(DataInputBuf), flags, UserData::Callback, &user_data))
-                        data_write = data_next = true;
-                    else if (!DataEditingTakeFocus && !ImGui::IsItemActive())
-                        DataEditingAddr = data_editing_addr_next = (size_t)-1;
-                    DataEditingTakeFocus = false;
-                    if (user_data.CursorPos >= 2)
-                        data_write = data_next = true;
-                    if (data_editing_addr_next != (size_t)-1)
-                        data_write = data_next = false;
-                    unsigned int data_input_value = 0;
-                    if (data_write && sscanf(DataInputBuf, "%X", &data_input_value) == 1)
-                    {
-                        if (WriteFn)
-                            WriteFn(mem_data, addr, (ImU8)data_input_value);
-                        else
-                            mem_data[addr] = (ImU8)data_input_value;
-                    }
-                    ImGui::PopID();
-                }
-                else
+                ImGui::SetNextItemWidth(s.GlyphWidth * 2);
+                if (ImGui::InputText("##data", DataInputBuf, IM_ARRAYSIZE(DataInputBuf), flags, UserData::Callback, &user_data))
+                    data_write = data_next = true;
+                else if (!DataEditingTakeFocus && !ImGui::IsItemActive())
+                    DataEditingAddr = data_editing_addr_next = (size_t)-1;
+                DataEditingTakeFocus = false;
+                if (user_data.CursorPos >= 2)
+                    data_write = data_next = true;
+                if (data_editing_addr_next != (size_t)-1)
+                    data_write = data_next = false;
+                unsigned int data_input_value = 0;
+                if (data_write && sscanf(DataInputBuf, "%X", &data_input_value) == 1)
                 {
-                    // NB: The trailing space is not visible but ensure there's no gap that the mouse cannot click on.
-                    ImU8 b = ReadFn ? ReadFn(mem_data, addr) : mem_data[addr];
-
-                    if (OptShowHexII)
-                    {
-                        if ((b >= 32 && b < 128))
-                            ImGui::Text(".%c ", b);
-                        else if (b == 0xFF && OptGreyOutZeroes)
-                            ImGui::TextDisabled("## ");
-                        else if (b == 0x00)
-                            ImGui::Text("   ");
-                        else
-                            ImGui::Text(format_byte_space, b);
-                    }
-                    else
-                    {
-                        if (b == 0 && OptGreyOutZeroes)
-                            ImGui::TextDisabled("00 ");
-                        else
-                            ImGui::Text(format_byte_space, b);
-                    }
-                    if (!ReadOnly && ImGui::IsItemHovered() && ImGui::IsMouseClicked(0))
-                    {
-                        DataEditingTakeFocus = true;
-                        data_editing_addr_next = addr;
-                    }
+                    const ImU8 data_input_byte = (ImU8)data_input_value;
+                    QueueWrite(mem_data, addr, &data_input_byte, 1);
                 }
+                ImGui::PopID();
             }
 
             if (OptShowAscii)
@@ -407,35 +1270,91 @@ struct MemoryEditor
                 // Draw ASCII values
                 ImGui::SameLine(s.PosAsciiStart);
                 ImVec2 pos = ImGui::GetCursorScreenPos();
-                addr = line_i * Cols;
                 ImGui::PushID(line_i);
                 if (ImGui::InvisibleButton("ascii", ImVec2(s.PosAsciiEnd - s.PosAsciiStart, s.LineHeight)))
                 {
-                    DataEditingAddr = DataPreviewAddr = addr + (size_t)((ImGui::GetIO().MousePos.x - pos.x) / s.GlyphWidth);
+                    DataEditingAddr = DataPreviewAddr = line_addr + (size_t)((ImGui::GetIO().MousePos.x - pos.x) / s.GlyphWidth);
                     DataEditingTakeFocus = true;
                 }
                 ImGui::PopID();
-                for (int n = 0; n < Cols && addr < mem_size; n++, addr++)
+                if (line_heat)
+                    for (int n = 0; n < line_cols; n++)
+                        if (line_heat[n] > 0.0f)
+                        {
+                            const float x = pos.x + s.GlyphWidth * n;
+                            draw_list->AddRectFilled(ImVec2(x, pos.y), ImVec2(x + s.GlyphWidth, pos.y + s.LineHeight), ScaleAlpha(HeatColor, line_heat[n]));
+                        }
+                if (editing_n >= 0 && DataEditingAddr == line_addr + editing_n)
+                {
+                    const float x = pos.x + s.GlyphWidth * editing_n;
+                    draw_list->AddRectFilled(ImVec2(x, pos.y), ImVec2(x + s.GlyphWidth, pos.y + s.LineHeight), ImGui::GetColorU32(ImGuiCol_FrameBg));
+                    draw_list->AddRectFilled(ImVec2(x, pos.y), ImVec2(x + s.GlyphWidth, pos.y + s.LineHeight), ImGui::GetColorU32(ImGuiCol_TextSelectedBg));
+                }
+                if (s.Monospace)
+                {
+                    draw_list->AddText(pos, color_text, ascii_text, ascii_text + line_cols);
+                    draw_list->AddText(pos, color_disabled, ascii_text_disabled, ascii_text_disabled + line_cols);
+                }
+                else
                 {
-                    if (addr == DataEditingAddr)
+                    for (int n = 0; n < line_cols; n++, pos.x += s.GlyphWidth)
                     {
-                        draw_list->AddRectFilled(pos, ImVec2(pos.x + s.GlyphWidth, pos.y + s.LineHeight), ImGui::GetColorU32(ImGuiCol_FrameBg));
-                        draw_list->AddRectFilled(pos, ImVec2(pos.x + s.GlyphWidth, pos.y + s.LineHeight), ImGui::GetColorU32(ImGuiCol_TextSelectedBg));
+                        if (ascii_text[n] != ' ')
+                            draw_list->AddText(pos, color_text, ascii_text + n, ascii_text + n + 1);
+                        else if (ascii_text_disabled[n] != ' ')
+                            draw_list->AddText(pos, color_disabled, ascii_text_disabled + n, ascii_text_disabled + n + 1);
                     }
-                    unsigned char c = ReadFn ? ReadFn(mem_data, addr) : mem_data[addr];
-                    char display_c = (c < 32 || c >= 128) ? '.' : c;
-                    draw_list->AddText(pos, (display_c == c) ? color_text : color_disabled, &display_c, &display_c + 1);
-                    pos.x += s.GlyphWidth;
+                }
+            }
+
+            if (LineLabelFn)
+            {
+                bool dim = false;
+                if (const char* label = LineLabelFn(UserData, line_addr, (size_t)line_cols, &dim))
+                {
+                    ImGui::SameLine(s.PosLabelStart);
+                    const ImVec2 pos = ImGui::GetCursorScreenPos();
+                    const ImVec4 clip(pos.x, pos.y, pos.x + s.PosLabelEnd - s.PosLabelStart, pos.y + s.LineHeight);
+                    draw_list->AddText(NULL, 0.0f, pos, dim ? ImGui::GetColorU32(ImGuiCol_TextDisabled) : color_text, label, NULL, 0.0f, &clip);
+                    ImGui::Dummy(ImVec2(s.PosLabelEnd - s.PosLabelStart, s.LineHeight));
                 }
             }
         }
         IM_ASSERT(clipper.Step() == false);
         clipper.End();
+
+        // Move the scrolling region before the user reaches its edges, compensating the scroll position next frame
+        if (PendingViewLineBase == (size_t)-1 && line_total_count > ViewMaxLines)
+        {
+            const size_t margin = ViewMaxLines / 4;
+            size_t new_base = ViewLineBase;
+            if ((size_t)display_start < margin && ViewLineBase > 0)
+                new_base = ViewLineBase > margin ? ViewLineBase - margin : 0;
+            else if ((size_t)display_end > ViewMaxLines - margin && ViewLineBase + ViewMaxLines < line_total_count)
+                new_base = ViewLineBase + margin < line_total_count - ViewMaxLines ? ViewLineBase + margin : line_total_count - ViewMaxLines;
+            if (new_base != ViewLineBase)
+            {
+                const float shift_lines = new_base > ViewLineBase ? -(float)(new_base - ViewLineBase) : (float)(ViewLineBase - new_base);
+                ImGui::SetScrollY(ImGui::GetScrollY() + shift_lines * s.LineHeight);
+                PendingViewLineBase = new_base;
+            }
+        }
         ImGui::PopStyleVar(2);
         ImGui::EndChild();
 
+        if (draw_side)
+        {
+            const float side_height = ImGui::GetItemRectSize().y;
+            ImGui::SameLine();
+            ImGui::BeginChild("##side", ImVec2(OptSideExtraWidth, side_height), false, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoScrollbar);
+            DrawSideFn(UserData, visible_start_addr, visible_end_addr < mem_size ? visible_end_addr : mem_size);
+            ImGui::EndChild();
+        }
+
         // Notify the main window of our ideal child content size (FIXME: we are missing an API to get the contents size from the child)
         ImGui::SetCursorPosX(s.WindowWidth);
+        FlushWrites(mem_data);
+        ApplyEdit(mem_data, mem_size);
 
         if (data_next && DataEditingAddr < mem_size)
         {
@@ -461,9 +1380,58 @@ struct MemoryEditor
         }
     }
 
+    // Right-click menu entries for the selection
+    void DrawEditMenu(const Sizes& s, ImU8* mem_data, size_t mem_size)
+    {
+        ImGuiStyle& style = ImGui::GetStyle();
+        size_t target_off, target_size;
+        const bool can_paste = !ReadOnly && BulkTarget(mem_size, target_off, target_size);
+        if (HasSelection())
+            ImGui::Text("%" _PRISizeT "u bytes selected", HighlightMax - HighlightMin);
+        else
+            ImGui::TextDisabled("Drag or shift-click to select");
+        if (ImGui::MenuItem("Copy hex", "Ctrl+C", false, HasSelection()))
+            CopySelection(mem_data, mem_size, true);
+        if (ImGui::MenuItem("Copy text", NULL, false, HasSelection()))
+            CopySelection(mem_data, mem_size, false);
+        if (ImGui::MenuItem("Paste hex", "Ctrl+V", false, can_paste))
+            Paste(mem_data, mem_size, true);
+        if (ImGui::MenuItem("Paste text", NULL, false, can_paste))
+            Paste(mem_data, mem_size, false);
+        if (InsertRangeFn != NULL)
+        {
+            if (ImGui::MenuItem("Insert hex", NULL, false, CanInsert()))
+                InsertClipboard(mem_size, true);
+            if (ImGui::MenuItem("Insert text", NULL, false, CanInsert()))
+                InsertClipboard(mem_size, false);
+        }
+        if (EraseRangeFn != NULL && ImGui::MenuItem("Delete selection", "Del", false, CanErase()))
+            QueueErase(mem_size);
+        if (!ReadOnly)
+        {
+            ImGui::SetNextItemWidth(s.GlyphWidth * 16 + style.FramePadding.x * 2.0f);
+            ImGui::InputText("##fill", FillInputBuf, IM_ARRAYSIZE(FillInputBuf));
+            ImGui::SameLine();
+            if (ImGui::Button("Fill selection"))
+                FillSelection(mem_data, mem_size);
+            if (InsertRangeFn != NULL)
+            {
+                ImGui::SameLine();
+                if (ImGui::Button("Insert"))
+                    InsertPattern(mem_size);
+            }
+            ImGui::SetNextItemWidth(s.GlyphWidth * 16 + style.FramePadding.x * 2.0f);
+            ImGui::InputText("##import", ImportPathBuf, IM_ARRAYSIZE(ImportPathBuf));
+            ImGui::SameLine();
+            if (ImGui::Button("Import file") && can_paste)
+                ImportFile(mem_data, mem_size);
+        }
+        if (BulkError)
+            ImGui::TextUnformatted(BulkError);
+    }
+
     void DrawOptionsLine(const Sizes& s, void* mem_data, size_t mem_size, size_t base_display_addr)
     {
-        IM_UNUSED(mem_data);
         ImGuiStyle& style = ImGui::GetStyle();
         const char* format_range = OptUpperCaseHex ? "Range %0*" _PRISizeT "X..%0*" _PRISizeT "X" : "Range %0*" _PRISizeT "x..%0*" _PRISizeT "x";
 
@@ -472,6 +1440,8 @@ struct MemoryEditor
             ImGui::OpenPopup("context");
         if (ImGui::BeginPopup("context"))
         {
+            DrawEditMenu(s, (ImU8*)mem_data, mem_size);
+            ImGui::Separator();
             ImGui::SetNextItemWidth(s.GlyphWidth * 7 + style.FramePadding.x * 2.0f);
             if (ImGui::DragInt("##cols", &Cols, 0.2f, 4, 32, "%d cols")) { ContentsWidthChanged = true; if (Cols < 1) Cols = 1; }
             ImGui::Checkbox("Show Data Preview", &OptShowDataPreview);
@@ -486,23 +1456,65 @@ struct MemoryEditor
         ImGui::SameLine();
         ImGui::Text(format_range, s.AddrDigitsCount, base_display_addr, s.AddrDigitsCount, base_display_addr + mem_size - 1);
         ImGui::SameLine();
-        ImGui::SetNextItemWidth((s.AddrDigitsCount + 1) * s.GlyphWidth + style.FramePadding.x * 2.0f);
-        if (ImGui::InputText("##addr", AddrInputBuf, IM_ARRAYSIZE(AddrInputBuf), ImGuiInputTextFlags_CharsHexadecimal | ImGuiInputTextFlags_EnterReturnsTrue))
+        // Names are typed in the same field and looked up first, addresses then need a 0x prefix
+        const int addr_input_chars = GotoNameFn ? (s.AddrDigitsCount > 16 ? s.AddrDigitsCount : 16) : s.AddrDigitsCount;
+        ImGui::SetNextItemWidth((addr_input_chars + 1) * s.GlyphWidth + style.FramePadding.x * 2.0f);
+        if (ImGui::InputText("##addr", AddrInputBuf, IM_ARRAYSIZE(AddrInputBuf), (GotoNameFn ? 0 : ImGuiInputTextFlags_CharsHexadecimal) | ImGuiInputTextFlags_EnterReturnsTrue))
         {
+            // With names, addresses need their 0x so that names like "add" or "beef" are never taken for one
             size_t goto_addr;
-            if (sscanf(AddrInputBuf, "%" _PRISizeT "X", &goto_addr) == 1)
+            int parsed = 0;
+            const bool hex_prefix = AddrInputBuf[0] == '0' && (AddrInputBuf[1] == 'x' || AddrInputBuf[1] == 'X');
+            if (GotoNameFn && GotoNameFn(UserData, AddrInputBuf, &goto_addr))
+            {
+                GotoAddr = goto_addr;
+                HighlightMin = HighlightMax = (size_t)-1;
+            }
+            else if ((GotoNameFn == NULL || hex_prefix) && sscanf(AddrInputBuf, "%" _PRISizeT "X%n", &goto_addr, &parsed) == 1 && (GotoNameFn == NULL || AddrInputBuf[parsed] == 0))
             {
                 GotoAddr = goto_addr - base_display_addr;
                 HighlightMin = HighlightMax = (size_t)-1;
             }
         }
 
+        if (LineLabelFn)
+        {
+            const size_t cursor_addr = DataEditingAddr != (size_t)-1 ? DataEditingAddr : DataPreviewAddr != (size_t)-1 ? DataPreviewAddr : VisibleStartAddr;
+            bool dim = false;
+            if (const char* label = cursor_addr < mem_size ? LineLabelFn(UserData, cursor_addr, 1, &dim) : NULL)
+            {
+                ImGui::SameLine();
+                ImGui::TextUnformatted(label);
+            }
+        }
+
+        // The scrollbar only spans ViewMaxLines lines, this jumps anywhere in huge memories
+        if ((mem_size + Cols - 1) / Cols > ViewMaxLines)
+        {
+            ImGui::SameLine();
+            ImU64 scrub_addr = VisibleStartAddr;
+            const ImU64 scrub_min = 0, scrub_max = mem_size - 1;
+            ImGui::SetNextItemWidth(-1.0f);
+            if (ImGui::SliderScalar("##scrub", ImGuiDataType_U64, &scrub_addr, &scrub_min, &scrub_max, OptUpperCaseHex ? "%016llX" : "%016llx"))
+                GotoAddr = (size_t)scrub_addr;
+        }
+
         if (GotoAddr != (size_t)-1)
         {
             if (GotoAddr < mem_size)
             {
+                const size_t line_total_count = (mem_size + Cols - 1) / Cols;
+                const size_t goto_line = GotoAddr / Cols;
+                size_t base = PendingViewLineBase != (size_t)-1 ? PendingViewLineBase : ViewLineBase;
+                if (goto_line < base || goto_line >= base + ViewMaxLines)
+                {
+                    base = goto_line > ViewMaxLines / 2 ? goto_line - ViewMaxLines / 2 : 0;
+                    if (base + ViewMaxLines > line_total_count)
+                        base = line_total_count > ViewMaxLines ? line_total_count - ViewMaxLines : 0;
+                    PendingViewLineBase = base;
+                }
                 ImGui::BeginChild("##scrolling");
-                ImGui::SetScrollFromPosY(ImGui::GetCursorStartPos().y + (GotoAddr / Cols) * ImGui::GetTextLineHeight());
+                ImGui::SetScrollFromPosY(ImGui::GetCursorStartPos().y + (float)(goto_line - base) * ImGui::GetTextLineHeight());
                 ImGui::EndChild();
                 DataEditingAddr = DataPreviewAddr = GotoAddr;
                 DataEditingTakeFocus = true;
@@ -639,11 +1651,7 @@ struct MemoryEditor
         uint8_t buf[8];
         size_t elem_size = DataTypeGetSize(data_type);
         size_t size = addr + elem_size > mem_size ? mem_size - addr : elem_size;
-        if (ReadFn)
-            for (int i = 0, n = (int)size; i < n; ++i)
-                buf[i] = ReadFn(mem_data, addr + i);
-        else
-            memcpy(buf, mem_data + addr, size);
+        ReadBytes(mem_data, addr, buf, size);
 
         if (data_format == DataFormat_Bin)
         {
@@ -0,0 +1,474 @@
+#include <gui/gui.h>
+#include "imgui.h"
+#include "log_archive.h"
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <cstring>
+
+namespace guicpp
+{
+
+struct LogChannel::impl
+{
+    using Line = LogRecord;
+
+    impl(const char *name, size_t max_lines) :
+        name_{name}, max_lines_{std::max<size_t>(max_lines, 4)}
+    {}
+
+    void add_log(const char *str)
+    {
+        // Stamped under the lock so each channel stays sorted by time, which the merged view relies on
+        std::unique_lock<std::mutex> lock{mutex_};
+        auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        while (*str != '\0') {
+            const char *end = std::strchr(str, '\n');
+            size_t length = end ? static_cast<size_t>(end - str) : std::strlen(str);
+            lines_.push_back(Line{timestamp, text_.size(), length});
+            text_.append(str, length);
+            str += length;
+            if (*str == '\n') {
+                str++;
+            }
+        }
+        if (lines_.size() <= max_lines_ || archiving_) {
+            return;
+        }
+        const size_t count = max_lines_ / 4;
+        LogArchive *archive = archive_.get();
+        if (archive == nullptr) {
+            evict(count);
+            return;
+        }
+        // The lines are compressed and written from a copy with the lock released. They stay live
+        // until the archive has them, so readers never find a gap, and other threads keep logging.
+        archiving_ = true;
+        const uint64_t seq = first_seq_;
+        std::vector<Line> lines(lines_.begin(), lines_.begin() + count);
+        std::string text = text_.substr(0, lines_[count].offset);
+        lock.unlock();
+        archive->append(seq, lines.data(), count, text.data());
+        lock.lock();
+        evict(count);
+        archiving_ = false;
+    }
+
+    // Drops the oldest lines in one go so that the memmove of the text is amortized over many appends.
+    void evict(size_t count)
+    {
+        size_t text_count = lines_[count].offset;
+        text_.erase(0, text_count);
+        lines_.erase(lines_.begin(), lines_.begin() + count);
+        for (auto &line : lines_) {
+            line.offset -= text_count;
+        }
+        first_seq_ += count;
+    }
+
+    uint64_t end_seq() const { return first_seq_ + lines_.size(); }
+
+    Line const& line(uint64_t seq) const { return lines_[seq - first_seq_]; }
+
+    const char* line_begin(uint64_t seq) const { return text_.data() + line(seq).offset; }
+
+    const char* line_end(uint64_t seq) const { return line_begin(seq) + line(seq).length; }
+
+    // First line still reachable, live or archived.
+    uint64_t history_seq() const { return archive_ && !archive_->empty() ? archive_->first_seq() : first_seq_; }
+
+    bool line_text(uint64_t seq, const char **begin, const char **end)
+    {
+        if (seq >= first_seq_) {
+            *begin = line_begin(seq);
+            *end = line_end(seq);
+            return true;
+        }
+        return archive_ && archive_->line(seq, begin, end);
+    }
+
+    // Takes the lock itself. Archived lines are visited without it, blocks never change once appended.
+    template <typename F>
+    void for_each_line(uint64_t from, uint64_t to, F &&f)
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        LogArchive *archive = archive_.get();
+        if (archive && from < first_seq_) {
+            const uint64_t live = std::min(to, first_seq_);
+            lock.unlock();
+            archive->scan(from, live, f);
+            from = live;
+            lock.lock();
+            // Lines evicted meanwhile, at most a block
+            if (from < first_seq_) {
+                archive->scan(from, std::min(to, first_seq_), f);
+            }
+        }
+        for (uint64_t seq = std::max(from, first_seq_); seq < to; seq++) {
+            f(seq, line_begin(seq), line_end(seq));
+        }
+    }
+
+    std::string name_;
+    size_t max_lines_;
+    std::mutex mutex_;
+    std::string text_;
+    std::vector<Line> lines_;
+    uint64_t first_seq_ = 0;
+    bool archiving_ = false;
+    std::unique_ptr<LogArchive> archive_;
+};
+
+LogChannel::LogChannel(const char *name, size_t max_lines) :
+    pimpl_{std::make_shared<impl>(name, max_lines)}
+{}
+
+LogChannel::~LogChannel() = default;
+
+const char* LogChannel::name() const
+{
+    return pimpl_->name_.c_str();
+}
+
+void LogChannel::add_log(const char *text)
+{
+    pimpl_->add_log(text);
+}
+
+void LogChannel::enable_archive(const char *path)
+{
+    std::lock_guard<std::mutex> lock{pimpl_->mutex_};
+    if (!pimpl_->archive_) {
+        pimpl_->archive_ = std::make_unique<LogArchive>(path);
+    }
+}
+
+struct LogWindow::impl
+{
+    // One line of the merged view, referencing the channel's storage rather than copying it.
+    struct Entry
+    {
+        uint32_t channel;
+        uint64_t seq;
+    };
+
+    struct Source
+    {
+        std::shared_ptr<LogChannel::impl> channel;
+        uint64_t merged_seq = 0;    // lines before this are already in merged
+        uint64_t first_seq = 0;     // channel first_seq when last merged, to detect eviction
+        uint64_t cleared_seq = 0;   // lines before this were hidden by "Clear"
+    };
+
+    impl(const char * text, Size size = {}, Position position = {}) :
+        text_{text}, size_{size}, position_{position}
+    {}
+
+    void add_channel(LogChannel const& channel)
+    {
+        sources_.push_back(Source{channel.pimpl_});
+    }
+
+    void clear()
+    {
+        for (auto &source : sources_) {
+            std::lock_guard<std::mutex> lock{source.channel->mutex_};
+            source.cleared_seq = source.merged_seq = source.channel->end_seq();
+        }
+        merged_.clear();
+        merged_matches_.clear();
+    }
+
+    uint64_t begin_seq(Source const& source) const
+    {
+        return std::max(source.channel->first_seq_, source.cleared_seq);
+    }
+
+    // k-way merge of the lines appended since last frame into the merged index, by timestamp.
+    // Must be called with all channel locks held.
+    bool update_merged()
+    {
+        bool evicted = false;
+        for (auto &source : sources_) {
+            evicted |= source.channel->first_seq_ != source.first_seq;
+            source.first_seq = source.channel->first_seq_;
+            source.merged_seq = std::max(source.merged_seq, begin_seq(source));
+        }
+        auto gone = [&](Entry const& e) { return e.seq < begin_seq(sources_[e.channel]); };
+        if (evicted) {
+            merged_.erase(std::remove_if(merged_.begin(), merged_.end(), gone), merged_.end());
+            merged_matches_.erase(std::remove_if(merged_matches_.begin(), merged_matches_.end(), gone), merged_matches_.end());
+        }
+        merged_new_ = merged_.size();
+
+        auto later = [&](Entry const& a, Entry const& b) {
+            auto ta = sources_[a.channel].channel->line(a.seq).timestamp;
+            auto tb = sources_[b.channel].channel->line(b.seq).timestamp;
+            return ta != tb ? ta > tb : a.channel > b.channel;
+        };
+        std::priority_queue<Entry, std::vector<Entry>, decltype(later)> heads{later};
+        for (uint32_t i = 0; i < sources_.size(); i++) {
+            if (sources_[i].merged_seq < sources_[i].channel->end_seq()) {
+                heads.push(Entry{i, sources_[i].merged_seq});
+            }
+        }
+        bool appended = !heads.empty();
+        while (!heads.empty()) {
+            Entry e = heads.top();
+            heads.pop();
+            merged_.push_back(e);
+            auto &source = sources_[e.channel];
+            source.merged_seq = e.seq + 1;
+            if (source.merged_seq < source.channel->end_seq()) {
+                heads.push(Entry{e.channel, source.merged_seq});
+            }
+        }
+        return appended;
+    }
+
+    void draw_line(Entry const& e)
+    {
+        auto &channel = *sources_[e.channel].channel;
+        ImGui::TextDisabled("[%s] ", channel.name_.c_str());
+        ImGui::SameLine();
+        ImGui::TextUnformatted(channel.line_begin(e.seq), channel.line_end(e.seq));
+    }
+
+    // Merged lines passing the filter, extended with the lines merged this frame
+    // so the whole index is only tested again when the filter text changes.
+    void update_merged_matches()
+    {
+        size_t from = merged_new_;
+        if (merged_filter_ != filter.InputBuf) {
+            merged_filter_ = filter.InputBuf;
+            merged_matches_.clear();
+            from = 0;
+        }
+        for (size_t i = from; i < merged_.size(); i++) {
+            auto &channel = *sources_[merged_[i].channel].channel;
+            if (filter.PassFilter(channel.line_begin(merged_[i].seq), channel.line_end(merged_[i].seq))) {
+                merged_matches_.push_back(merged_[i]);
+            }
+        }
+    }
+
+    bool draw_merged(bool copy)
+    {
+        bool appended = update_merged();
+        bool filtered = filter.IsActive();
+        if (filtered) {
+            update_merged_matches();
+        } else {
+            merged_filter_.clear();
+            merged_matches_.clear();
+        }
+        auto const& shown = filtered ? merged_matches_ : merged_;
+        if (copy)
+        {
+            for (auto const& e : shown) {
+                draw_line(e);
+            }
+            return appended;
+        }
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(shown.size()));
+        while (clipper.Step()) {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                draw_line(shown[i]);
+            }
+        }
+        clipper.End();
+        return appended;
+    }
+
+    // Filter results over the whole history, extended with the lines added since last frame
+    // so the archive is only searched again when the filter text changes.
+    void update_matches(Source &source, uint64_t begin, uint64_t end)
+    {
+        auto &channel = *source.channel;
+        if (matched_filter_ != filter.InputBuf || matched_seq_ < begin) {
+            matched_filter_ = filter.InputBuf;
+            matched_seq_ = begin;
+            matches_.clear();
+        }
+        matches_.erase(matches_.begin(), std::lower_bound(matches_.begin(), matches_.end(), begin));
+        channel.for_each_line(matched_seq_, end, [&](uint64_t seq, const char *line_begin, const char *line_end) {
+            if (filter.PassFilter(line_begin, line_end)) {
+                matches_.push_back(seq);
+            }
+        });
+        matched_seq_ = end;
+    }
+
+    // A single channel is addressed by sequence number directly, which reaches into its archive.
+    // The channel lock is only held for live lines, so logging threads are not held up by a search
+    // of the archive.
+    bool draw_channel(bool copy)
+    {
+        auto &source = sources_.front();
+        auto &channel = *source.channel;
+        LogArchive *archive;
+        uint64_t begin, archived, end;
+        {
+            std::lock_guard<std::mutex> lock{channel.mutex_};
+            archive = channel.archive_.get();
+            begin = std::max(channel.history_seq(), source.cleared_seq);
+            archived = channel.first_seq_;
+            end = channel.end_seq();
+        }
+        bool appended = end != source.merged_seq;
+        source.merged_seq = end;
+
+        if (copy)
+        {
+            channel.for_each_line(begin, end, [&](uint64_t, const char *line_begin, const char *line_end) {
+                if (filter.PassFilter(line_begin, line_end)) {
+                    ImGui::TextUnformatted(line_begin, line_end);
+                }
+            });
+            return appended;
+        }
+
+        bool filtered = filter.IsActive();
+        if (filtered) {
+            update_matches(source, begin, end);
+        }
+        // Lines below archived stay in the archive, the ones after need the lock
+        std::unique_lock<std::mutex> live{channel.mutex_, std::defer_lock};
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(filtered ? matches_.size() : end - begin));
+        while (clipper.Step()) {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                const uint64_t seq = filtered ? matches_[i] : begin + i;
+                const char *line_begin, *line_end;
+                bool found;
+                if (seq < archived) {
+                    found = archive && archive->line(seq, &line_begin, &line_end);
+                } else {
+                    if (!live.owns_lock()) {
+                        live.lock();
+                    }
+                    found = channel.line_text(seq, &line_begin, &line_end);
+                }
+                if (found) {
+                    ImGui::TextUnformatted(line_begin, line_end);
+                } else {
+                    ImGui::TextDisabled("<unavailable>");
+                }
+            }
+        }
+        clipper.End();
+        return appended;
+    }
+
+    void draw()
+    {
+        ImGui::SetNextWindowSize(ImVec2(size_.width, size_.height), ImGuiCond_FirstUseEver);
+        ImGui::SetNextWindowPos(ImVec2(position_.x, position_.y), ImGuiCond_FirstUseEver);
+        ImGui::Begin(text_);
+        if (ImGui::Button("Clear")) {
+            clear();
+        }
+        ImGui::SameLine();
+        bool copy = ImGui::Button("Copy");
+        ImGui::SameLine();
+        filter.Draw("Filter", -100.0f);
+        if (sources_.size() == 1) {
+            auto &channel = *sources_.front().channel;
+            LogArchive *archive;
+            {
+                std::lock_guard<std::mutex> lock{channel.mutex_};
+                archive = channel.archive_.get();
+            }
+            if (archive && !archive->empty()) {
+                ImGui::TextDisabled("%llu archived lines, %zu KB compressed from %zu KB",
+                    static_cast<unsigned long long>(archive->end_seq() - archive->first_seq()),
+                    archive->compressed_bytes() / 1024, archive->raw_bytes() / 1024);
+            }
+        }
+        ImGui::Separator();
+        ImGui::BeginChild("scrolling");
+        ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(0,1));
+        if (copy) {
+            ImGui::LogToClipboard();
+        }
+
+        bool at_bottom = ImGui::GetScrollY() >= ImGui::GetScrollMaxY();
+        bool appended = false;
+        if (sources_.size() == 1) {
+            appended = draw_channel(copy);
+        } else if (!sources_.empty()) {
+            // The merged view only shows live lines, bounded by max_lines per channel
+            std::vector<std::unique_lock<std::mutex>> locks;
+            for (auto &source : sources_) {
+                locks.emplace_back(source.channel->mutex_);
+            }
+            appended = draw_merged(copy);
+        }
+
+        if (appended && at_bottom) {
+            ImGui::SetScrollHereY(1.0f);
+        }
+        ImGui::PopStyleVar();
+        ImGui::EndChild();
+        ImGui::End();
+    }
+
+    const char *text_;
+    Size size_;
+    Position position_;
+    std::vector<Source> sources_;
+private:
+    ImGuiTextFilter filter;
+    std::deque<Entry> merged_;
+    size_t merged_new_ = 0;         // merged_ entries from here on were appended this frame
+    std::string merged_filter_;
+    std::deque<Entry> merged_matches_;
+    std::string matched_filter_;
+    std::vector<uint64_t> matches_;
+    uint64_t matched_seq_ = 0;
+};
+
+LogWindow::LogWindow(const char *text, Size size, Position position) :
+    pimpl_{std::make_unique<impl>(text, size, position)}
+{}
+
+LogWindow::LogWindow(const char *text, std::vector<LogChannel> channels, Size size, Position position) :
+    pimpl_{std::make_unique<impl>(text, size, position)}
+{
+    for (auto &channel : channels) {
+        pimpl_->add_channel(channel);
+    }
+}
+
+LogWindow::~LogWindow() = default;
+
+LogWindow::LogWindow(LogWindow const& rhs) :
+    pimpl_(std::make_unique<impl>(rhs.pimpl_->text_, rhs.pimpl_->size_, rhs.pimpl_->position_))
+{
+    for (auto &source : rhs.pimpl_->sources_) {
+        pimpl_->sources_.push_back(impl::Source{source.channel});
+    }
+}
+
+void LogWindow::draw() const
+{
+    pimpl_->draw();
+}
+
+void LogWindow::add_log(const char *text)
+{
+    if (pimpl_->sources_.empty()) {
+        add_channel(LogChannel{pimpl_->text_});
+    }
+    pimpl_->sources_.front().channel->add_log(text);
+}
+
+void LogWindow::add_channel(LogChannel channel)
+{
+    pimpl_->add_channel(channel);
+}
+
+}
@@ -0,0 +1,243 @@
+#include "log_archive.h"
+#include "file_io.h"
+#include "lz.h"
+#include <algorithm>
+#include <cstring>
+
+namespace guicpp
+{
+
+// Raw block layout: u32 line count, then per line { i64 timestamp, u32 length }, then the concatenated text.
+static constexpr size_t record_size = sizeof(int64_t) + sizeof(uint32_t);
+
+template <typename T>
+static void put(std::vector<uint8_t> &out, T value)
+{
+    auto p = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), p, p + sizeof(T));
+}
+
+template <typename T>
+static T get(const uint8_t *p)
+{
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+LogArchive::LogArchive(const char *path, size_t cache_blocks) :
+    cache_blocks_{std::max<size_t>(cache_blocks, 1)}
+{
+    if (path != nullptr) {
+        file_ = std::fopen(path, "w+b");
+        if (file_ == nullptr) {
+            throw -1;
+        }
+    }
+}
+
+LogArchive::~LogArchive()
+{
+    if (file_ != nullptr) {
+        std::fclose(file_);
+    }
+}
+
+void LogArchive::append(uint64_t first_seq, const LogRecord *lines, size_t count, const char *text)
+{
+    if (count == 0) {
+        return;
+    }
+    size_t text_begin = lines[0].offset;
+    size_t text_size = lines[count - 1].offset + lines[count - 1].length - text_begin;
+
+    std::vector<uint8_t> raw;
+    raw.reserve(sizeof(uint32_t) + count * record_size + text_size);
+    put(raw, static_cast<uint32_t>(count));
+    for (size_t i = 0; i < count; i++) {
+        put(raw, lines[i].timestamp);
+        put(raw, static_cast<uint32_t>(lines[i].length));
+    }
+    raw.insert(raw.end(), text + text_begin, text + text_begin + text_size);
+
+    std::vector<uint8_t> compressed;
+    lz_compress(raw.data(), raw.size(), compressed);
+
+    std::lock_guard<std::mutex> lock{mutex_};
+    BlockIndex entry{first_seq, count, raw.size(), compressed.size(), 0, false};
+    if (file_ != nullptr && !write_failed_) {
+        entry.file_offset = file_size(file_);
+        entry.in_file = std::fwrite(compressed.data(), 1, compressed.size(), file_) == compressed.size() && std::fflush(file_) == 0;
+        write_failed_ = !entry.in_file;
+    }
+    if (entry.in_file) {
+        blocks_.emplace_back();
+    } else {
+        compressed.shrink_to_fit();
+        blocks_.push_back(std::move(compressed));
+    }
+    index_.push_back(entry);
+    raw_bytes_ += raw.size();
+    compressed_bytes_ += entry.compressed_size;
+}
+
+bool LogArchive::empty() const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    return index_.empty();
+}
+
+uint64_t LogArchive::first_seq() const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    return begin_locked();
+}
+
+uint64_t LogArchive::end_seq() const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    return end_locked();
+}
+
+size_t LogArchive::raw_bytes() const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    return raw_bytes_;
+}
+
+size_t LogArchive::compressed_bytes() const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    return compressed_bytes_;
+}
+
+size_t LogArchive::find_block(uint64_t seq) const
+{
+    auto it = std::upper_bound(index_.begin(), index_.end(), seq, [](uint64_t s, BlockIndex const& b) {
+        return s < b.first_seq;
+    });
+    return static_cast<size_t>(it - index_.begin()) - 1;
+}
+
+bool LogArchive::read(size_t block, std::vector<uint8_t> &compressed)
+{
+    auto const& entry = index_[block];
+    if (!entry.in_file) {
+        compressed = blocks_[block];
+        return true;
+    }
+    compressed.resize(entry.compressed_size);
+    return file_seek(file_, entry.file_offset) && std::fread(compressed.data(), 1, compressed.size(), file_) == compressed.size();
+}
+
+bool LogArchive::decode(BlockIndex const& entry, std::vector<uint8_t> const& compressed, Block &out)
+{
+    std::vector<uint8_t> raw(entry.raw_size);
+    if (!lz_decompress(compressed.data(), compressed.size(), raw.data(), raw.size())) {
+        return false;
+    }
+
+    size_t count = get<uint32_t>(raw.data());
+    const uint8_t *record = raw.data() + sizeof(uint32_t);
+    size_t text_begin = sizeof(uint32_t) + count * record_size;
+    out.lines.resize(count);
+    size_t offset = 0;
+    for (auto &line : out.lines) {
+        line.timestamp = get<int64_t>(record);
+        line.length = get<uint32_t>(record + sizeof(int64_t));
+        line.offset = offset;
+        offset += line.length;
+        record += record_size;
+    }
+    out.text.assign(reinterpret_cast<const char*>(raw.data()) + text_begin, raw.size() - text_begin);
+    return true;
+}
+
+// Decodes with the lock released, lock is held again on return
+std::shared_ptr<LogArchive::Block> LogArchive::cached(size_t block, std::unique_lock<std::mutex> &lock)
+{
+    auto it = cache_.find(block);
+    if (it != cache_.end()) {
+        lru_.splice(lru_.begin(), lru_, it->second.second);
+        return it->second.first;
+    }
+
+    std::vector<uint8_t> compressed;
+    if (!read(block, compressed)) {
+        return nullptr;
+    }
+    const BlockIndex entry = index_[block];
+    lock.unlock();
+    auto loaded = std::make_shared<Block>();
+    const bool ok = decode(entry, compressed, *loaded);
+    lock.lock();
+    if (!ok) {
+        return nullptr;
+    }
+    it = cache_.find(block);
+    if (it != cache_.end()) {
+        return it->second.first;
+    }
+    if (cache_.size() >= cache_blocks_) {
+        cache_.erase(lru_.back());
+        lru_.pop_back();
+    }
+    lru_.push_front(block);
+    cache_.emplace(block, std::make_pair(loaded, lru_.begin()));
+    return loaded;
+}
+
+bool LogArchive::line(uint64_t seq, const char **begin, const char **end)
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+    if (seq < begin_locked() || seq >= end_locked()) {
+        return false;
+    }
+    size_t block = find_block(seq);
+    auto b = cached(block, lock);
+    if (!b) {
+        return false;
+    }
+    auto const& record = b->lines[seq - index_[block].first_seq];
+    *begin = b->text.data() + record.offset;
+    *end = *begin + record.length;
+    return true;
+}
+
+// The lock is only held to find and read each block, f runs without it
+void LogArchive::scan(uint64_t from, uint64_t to, std::function<void(uint64_t seq, const char *begin, const char *end)> const& f)
+{
+    std::vector<uint8_t> compressed;
+    Block scratch;
+    for (;;) {
+        BlockIndex entry;
+        std::shared_ptr<Block> b;
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            from = std::max(from, begin_locked());
+            if (from >= std::min(to, end_locked())) {
+                return;
+            }
+            size_t block = find_block(from);
+            entry = index_[block];
+            auto it = cache_.find(block);
+            if (it != cache_.end()) {
+                b = it->second.first;
+            } else if (!read(block, compressed)) {
+                return;
+            }
+        }
+        if (!b && !decode(entry, compressed, scratch)) {
+            return;
+        }
+        Block const& lines = b ? *b : scratch;
+        uint64_t block_end = std::min<uint64_t>(to, entry.first_seq + entry.line_count);
+        for (; from < block_end; from++) {
+            auto const& record = lines.lines[from - entry.first_seq];
+            const char *begin = lines.text.data() + record.offset;
+            f(from, begin, begin + record.length);
+        }
+    }
+}
+
+}
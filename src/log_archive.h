@@ -0,0 +1,91 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace guicpp
+{
+
+struct LogRecord
+{
+    int64_t timestamp;
+    size_t offset;
+    size_t length;
+};
+
+// Keeps lines evicted from a LogChannel as LZ-compressed blocks, in memory or appended to a file,
+// with an index of sequence ranges so any line can be found with a binary search.
+// Only the blocks being looked at are decompressed, and the most recent ones are kept in an LRU cache.
+// Blocks never change once appended, so the archive has its own lock held only while a block is
+// indexed or read, and compressing and decompressing run outside of it. When a write to the file
+// fails the block, and the ones after it, stay in memory.
+class LogArchive
+{
+public:
+    LogArchive(const char *path = nullptr, size_t cache_blocks = 8);
+    ~LogArchive();
+    LogArchive(LogArchive const&) = delete;
+    LogArchive& operator=(LogArchive const&) = delete;
+
+    // Compresses lines [first_seq, first_seq + count) whose record offsets point into text.
+    void append(uint64_t first_seq, const LogRecord *lines, size_t count, const char *text);
+
+    bool empty() const;
+    uint64_t first_seq() const;
+    uint64_t end_seq() const;
+    size_t raw_bytes() const;
+    size_t compressed_bytes() const;
+
+    // The returned pointers stay valid until the block falls out of the cache.
+    bool line(uint64_t seq, const char **begin, const char **end);
+
+    // Visits lines [from, to) in order, decompressing block by block without going through the cache.
+    void scan(uint64_t from, uint64_t to, std::function<void(uint64_t seq, const char *begin, const char *end)> const& f);
+
+private:
+    struct BlockIndex
+    {
+        uint64_t first_seq;
+        size_t line_count;
+        size_t raw_size;
+        size_t compressed_size;
+        uint64_t file_offset;
+        bool in_file;
+    };
+
+    struct Block
+    {
+        std::vector<LogRecord> lines;
+        std::string text;
+    };
+
+    // These expect mutex_ to be held
+    uint64_t begin_locked() const { return index_.empty() ? 0 : index_.front().first_seq; }
+    uint64_t end_locked() const { return index_.empty() ? 0 : index_.back().first_seq + index_.back().line_count; }
+    size_t find_block(uint64_t seq) const;
+    bool read(size_t block, std::vector<uint8_t> &compressed);
+
+    static bool decode(BlockIndex const& entry, std::vector<uint8_t> const& compressed, Block &out);
+    std::shared_ptr<Block> cached(size_t block, std::unique_lock<std::mutex> &lock);
+
+    mutable std::mutex mutex_;
+    std::FILE *file_ = nullptr;
+    bool write_failed_ = false;
+    std::vector<BlockIndex> index_;
+    // Compressed blocks not in the file, empty for the others
+    std::vector<std::vector<uint8_t>> blocks_;
+    size_t raw_bytes_ = 0;
+    size_t compressed_bytes_ = 0;
+
+    size_t cache_blocks_;
+    std::list<size_t> lru_;
+    std::unordered_map<size_t, std::pair<std::shared_ptr<Block>, std::list<size_t>::iterator>> cache_;
+};
+
+}
@@ -0,0 +1,141 @@
+#include "lz.h"
+#include <cstring>
+
+namespace guicpp
+{
+
+static constexpr int hash_bits = 14;
+static constexpr size_t min_match = 4;
+static constexpr size_t max_offset = 0xFFFF;
+
+static uint32_t read32(const uint8_t *p)
+{
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static void put_length(std::vector<uint8_t> &out, size_t length)
+{
+    while (length >= 255) {
+        out.push_back(255);
+        length -= 255;
+    }
+    out.push_back(static_cast<uint8_t>(length));
+}
+
+static void put_sequence(std::vector<uint8_t> &out, const uint8_t *literals, size_t literal_count, size_t offset, size_t match_length)
+{
+    size_t match_code = match_length ? match_length - min_match : 0;
+    out.push_back(static_cast<uint8_t>(((literal_count < 15 ? literal_count : 15) << 4) | (match_code < 15 ? match_code : 15)));
+    if (literal_count >= 15) {
+        put_length(out, literal_count - 15);
+    }
+    if (literal_count) {
+        out.insert(out.end(), literals, literals + literal_count);
+    }
+    if (match_length) {
+        out.push_back(static_cast<uint8_t>(offset & 0xFF));
+        out.push_back(static_cast<uint8_t>(offset >> 8));
+        if (match_code >= 15) {
+            put_length(out, match_code - 15);
+        }
+    }
+}
+
+void lz_compress(const uint8_t *src, size_t size, std::vector<uint8_t> &out)
+{
+    out.clear();
+    out.reserve(size + size / 255 + 16);
+    std::vector<uint32_t> table(size_t{1} << hash_bits, 0);
+
+    size_t anchor = 0;
+    size_t ip = 0;
+    const size_t match_limit = size >= min_match ? size - min_match + 1 : 0;
+    while (ip < match_limit) {
+        uint32_t sequence = read32(src + ip);
+        uint32_t hash = (sequence * 2654435761u) >> (32 - hash_bits);
+        size_t candidate = table[hash];
+        table[hash] = static_cast<uint32_t>(ip);
+        if (candidate < ip && ip - candidate <= max_offset && read32(src + candidate) == sequence) {
+            size_t length = min_match;
+            while (ip + length < size && src[candidate + length] == src[ip + length]) {
+                length++;
+            }
+            put_sequence(out, src + anchor, ip - anchor, ip - candidate, length);
+            ip += length;
+            anchor = ip;
+        } else {
+            // Skip faster through data that doesn't compress
+            ip += 1 + ((ip - anchor) >> 6);
+        }
+    }
+    put_sequence(out, src + anchor, size - anchor, 0, 0);
+}
+
+static bool get_length(const uint8_t *&ip, const uint8_t *end, size_t &length)
+{
+    uint8_t b;
+    do {
+        if (ip >= end) {
+            return false;
+        }
+        b = *ip++;
+        length += b;
+    } while (b == 255);
+    return true;
+}
+
+bool lz_decompress(const uint8_t *src, size_t size, uint8_t *dst, size_t dst_size)
+{
+    const uint8_t *ip = src;
+    const uint8_t *end = src + size;
+    uint8_t *op = dst;
+    uint8_t *out_end = dst + dst_size;
+
+    while (ip < end) {
+        uint8_t token = *ip++;
+        size_t literal_count = token >> 4;
+        if (literal_count == 15 && !get_length(ip, end, literal_count)) {
+            return false;
+        }
+        if (literal_count > static_cast<size_t>(end - ip) || literal_count > static_cast<size_t>(out_end - op)) {
+            return false;
+        }
+        if (literal_count) {
+            std::memcpy(op, ip, literal_count);
+        }
+        op += literal_count;
+        ip += literal_count;
+        if (ip == end) {
+            break;
+        }
+
+        if (end - ip < 2) {
+            return false;
+        }
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        size_t length = token & 15;
+        if (length == 15 && !get_length(ip, end, length)) {
+            return false;
+        }
+        length += min_match;
+        if (offset == 0 || offset > static_cast<size_t>(op - dst) || length > static_cast<size_t>(out_end - op)) {
+            return false;
+        }
+        const uint8_t *match = op - offset;
+        if (offset >= length) {
+            std::memcpy(op, match, length);
+            op += length;
+        } else {
+            // Overlapping match repeats the last offset bytes
+            while (length--) {
+                *op++ = *match++;
+            }
+        }
+    }
+    return op == out_end;
+}
+
+}
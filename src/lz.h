@@ -0,0 +1,14 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace guicpp
+{
+    // Small LZ77 block codec using LZ4-style sequences (token, literals, 16-bit offset, match length).
+    // It trades ratio for speed: a single hash probe per position and no entropy stage.
+    void lz_compress(const uint8_t *src, size_t size, std::vector<uint8_t> &out);
+
+    // Returns false if the input is malformed or doesn't decode to exactly dst_size bytes.
+    bool lz_decompress(const uint8_t *src, size_t size, uint8_t *dst, size_t dst_size);
+}
@@ -16,12 +16,21 @@ int main(int argc, char *argv[])
 
     app.init(fonts_Roboto_Medium, fonts_Roboto_Medium_size, 14.0);
 
-    app.add(gui::MemoryEditorWindow("EEPROM", state.eeprom.bytes.data(), state.eeprom.bytes.size(), gui::Size{580,800}, gui::Position{800, 35}));
-    app.add(gui::SectorMemoryEditorWindow("DFLASH", state.dflash.bytes, state.dflash.current_sector, gui::Size{580,800}, gui::Position{835, 5}));
+    gui::PersistentMemory eeprom_state("eeprom.bin", state.eeprom.bytes.data(), state.eeprom.bytes.size());
+    gui::PersistentMemory dflash_state("dflash.bin", state.dflash.bytes);
+    eeprom_state.load();
+    dflash_state.load();
+
+    app.add(gui::MemoryEditorWindow("EEPROM", state.eeprom.bytes.data(), state.eeprom.bytes.size(), gui::Size{580,800}, gui::Position{800, 35})
+        .persist(eeprom_state)
+        .checksums());
+    app.add(gui::SectorMemoryEditorWindow("DFLASH", state.dflash.bytes, state.dflash.current_sector, gui::Size{580,800}, gui::Position{835, 5})
+        .persist(dflash_state)
+        .checksums());
 
     app.add(gui::Window("Control")
         .add(gui::InputInteger("DFLASH Sector", state.dflash.current_sector))
-        .add(gui::OnClickButton("Save State", [](){}))
+        .add(gui::OnClickButton("Save State", [&](){ eeprom_state.save(); dflash_state.save(); }))
         .add(gui::FrameRateLabel()));
     
     app.add(gui::Window("Buttons", gui::Size{100,120}, gui::Position{5, 5})
@@ -0,0 +1,242 @@
+#include "mapped_file.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+namespace guicpp
+{
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const char *path, bool writable)
+{
+    close();
+    HANDLE file = CreateFileA(path, writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    file_ = file;
+    writable_ = writable;
+    is_open_ = true;
+    if (!map(file_size())) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close()
+{
+    unmap();
+    if (file_ != nullptr) {
+        CloseHandle(file_);
+        file_ = nullptr;
+    }
+    is_open_ = false;
+}
+
+uint64_t MappedFile::file_size() const
+{
+    LARGE_INTEGER size;
+    if (file_ == nullptr || !GetFileSizeEx(file_, &size)) {
+        return 0;
+    }
+    return static_cast<uint64_t>(size.QuadPart);
+}
+
+bool MappedFile::map(uint64_t size)
+{
+    if (size == 0) {
+        return true;
+    }
+    mapping_ = CreateFileMappingA(file_, NULL, writable_ ? PAGE_READWRITE : PAGE_READONLY, static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), NULL);
+    if (mapping_ == nullptr) {
+        return false;
+    }
+    data_ = static_cast<uint8_t*>(MapViewOfFile(mapping_, writable_ ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, static_cast<SIZE_T>(size)));
+    if (data_ == nullptr) {
+        CloseHandle(mapping_);
+        mapping_ = nullptr;
+        return false;
+    }
+    size_ = size;
+    return true;
+}
+
+void MappedFile::unmap()
+{
+    if (data_ != nullptr) {
+        UnmapViewOfFile(data_);
+        data_ = nullptr;
+    }
+    if (mapping_ != nullptr) {
+        CloseHandle(mapping_);
+        mapping_ = nullptr;
+    }
+    size_ = 0;
+}
+
+bool MappedFile::flush(uint64_t offset, uint64_t size)
+{
+    if (data_ == nullptr || !writable_ || offset >= size_) {
+        return false;
+    }
+    size = std::min(size, size_ - offset);
+    return FlushViewOfFile(data_ + offset, static_cast<SIZE_T>(size)) && FlushFileBuffers(file_);
+}
+
+#else
+
+bool MappedFile::open(const char *path, bool writable)
+{
+    close();
+    fd_ = ::open(path, writable ? O_RDWR : O_RDONLY);
+    if (fd_ < 0) {
+        return false;
+    }
+    writable_ = writable;
+    is_open_ = true;
+    if (!map(file_size())) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close()
+{
+    unmap();
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    is_open_ = false;
+}
+
+uint64_t MappedFile::file_size() const
+{
+    struct stat st;
+    if (fd_ < 0 || fstat(fd_, &st) != 0) {
+        return 0;
+    }
+    return static_cast<uint64_t>(st.st_size);
+}
+
+bool MappedFile::map(uint64_t size)
+{
+    if (size == 0) {
+        return true;
+    }
+    void *data = mmap(nullptr, static_cast<size_t>(size), writable_ ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd_, 0);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    data_ = static_cast<uint8_t*>(data);
+    size_ = size;
+    return true;
+}
+
+void MappedFile::unmap()
+{
+    if (data_ != nullptr) {
+        munmap(data_, static_cast<size_t>(size_));
+        data_ = nullptr;
+    }
+    size_ = 0;
+}
+
+bool MappedFile::flush(uint64_t offset, uint64_t size)
+{
+    if (data_ == nullptr || !writable_ || offset >= size_) {
+        return false;
+    }
+    // msync wants a page aligned start address
+    uint64_t page_size = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    uint64_t begin = offset - offset % page_size;
+    uint64_t end = std::min(offset + size, size_);
+    return msync(data_ + begin, static_cast<size_t>(end - begin), MS_SYNC) == 0;
+}
+
+#endif
+
+bool MappedFile::remap()
+{
+    uint64_t size = file_size();
+    if (!is_open_ || size == size_) {
+        return is_open_;
+    }
+    unmap();
+    return map(size);
+}
+
+#ifdef __linux__
+
+FileWatcher::FileWatcher(const char *path)
+{
+    fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd_ >= 0) {
+        watch_ = inotify_add_watch(fd_, path, IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE);
+    }
+}
+
+FileWatcher::~FileWatcher()
+{
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+bool FileWatcher::wait(int timeout_ms)
+{
+    if (watch_ < 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+        return true;
+    }
+    pollfd pfd{fd_, POLLIN, 0};
+    if (poll(&pfd, 1, timeout_ms) <= 0) {
+        return false;
+    }
+    // Drain all pending events, one change notification is enough
+    alignas(inotify_event) char buffer[4096];
+    while (read(fd_, buffer, sizeof(buffer)) > 0) {
+    }
+    return true;
+}
+
+#else
+
+FileWatcher::FileWatcher(const char *)
+{}
+
+FileWatcher::~FileWatcher() = default;
+
+bool FileWatcher::wait(int timeout_ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+    return true;
+}
+
+#endif
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace guicpp
+{
+
+// Read-only or read-write memory mapping of a whole file (mmap on POSIX, file mappings on Windows).
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    bool open(const char *path, bool writable = false);
+    void close();
+
+    // Maps the file again if its size on disk changed. Pointers from data() are invalidated.
+    bool remap();
+
+    // Writes modified pages in [offset, offset + size) back to disk, blocking until done.
+    bool flush(uint64_t offset, uint64_t size);
+
+    uint64_t file_size() const;
+    bool is_open() const { return is_open_; }
+    const uint8_t* data() const { return data_; }
+    uint8_t* data() { return data_; }
+    uint64_t size() const { return size_; }
+
+private:
+    bool map(uint64_t size);
+    void unmap();
+
+#ifdef _WIN32
+    void *file_ = nullptr;
+    void *mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+    bool is_open_ = false;
+    bool writable_ = false;
+    uint8_t *data_ = nullptr;
+    uint64_t size_ = 0;
+};
+
+// Waits for changes to a file: inotify on Linux, plain polling elsewhere.
+class FileWatcher
+{
+public:
+    explicit FileWatcher(const char *path);
+    ~FileWatcher();
+    FileWatcher(FileWatcher const&) = delete;
+    FileWatcher& operator=(FileWatcher const&) = delete;
+
+    // Blocks for up to timeout_ms. Returns true when the file may have changed.
+    bool wait(int timeout_ms);
+
+private:
+    int fd_ = -1;
+    int watch_ = -1;
+};
+
+}
@@ -0,0 +1,365 @@
+#include <gui/gui.h>
+#include "imgui.h"
+#include "diff_index.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+
+namespace guicpp
+{
+
+struct MemoryDiffWindow::impl
+{
+    static constexpr size_t columns = 16;
+    static constexpr size_t none = static_cast<size_t>(-1);
+    static constexpr float ruler_width = 6.0f;
+    // ImGui scroll positions are floats and clipper counts are ints, so memories with more lines than
+    // this are shown through a scrolling region of view_max_lines lines starting at view_line_base_.
+    static constexpr size_t view_max_lines = 1 << 19;
+
+    // Shared with copies, the window drawn is usually a copy of the one marked
+    struct Marks
+    {
+        std::mutex mutex;
+        std::vector<DiffIndex::Range> ranges;
+        bool used = false;
+    };
+
+    const char *text_;
+    const uint8_t *a_;
+    size_t a_size_;
+    const uint8_t *b_;
+    size_t b_size_;
+    const char *path_ = nullptr;
+    Size size_;
+    Position position_;
+    double interval_ = 0.5;
+    std::shared_ptr<Marks> marks_ = std::make_shared<Marks>();
+
+    impl(const char* text, const uint8_t *a, size_t a_size, const uint8_t *b, size_t b_size, Size size = {}, Position position = {}) :
+        text_{text},
+        a_{a},
+        a_size_{a_size},
+        b_{b},
+        b_size_{b_size},
+        size_{size},
+        position_{position}
+    {
+        interval(interval_);
+    }
+
+    impl(const char* text, const uint8_t *bytes, size_t bytes_size, const char *path, Size size = {}, Position position = {}) :
+        impl(text, bytes, bytes_size, nullptr, 0, size, position)
+    {
+        path_ = path;
+        if (file_.open(path_)) {
+            b_ = file_.data();
+            b_size_ = static_cast<size_t>(file_.size());
+        }
+    }
+
+    void interval(double seconds)
+    {
+        interval_ = seconds;
+    }
+
+    void mark_changed(size_t begin, size_t end)
+    {
+        std::lock_guard<std::mutex> lock{marks_->mutex};
+        marks_->ranges.push_back(DiffIndex::Range{begin, end});
+        marks_->used = true;
+    }
+
+    // Ranges marked by the application are diffed again. Until the first one is, only the lines in
+    // view are diffed again every interval, the whole memories are compared on Rescan.
+    void update_index()
+    {
+        std::vector<DiffIndex::Range> marked;
+        bool marking;
+        {
+            std::lock_guard<std::mutex> lock{marks_->mutex};
+            marked.swap(marks_->ranges);
+            marking = marks_->used;
+        }
+        if (!built_) {
+            index_.build(a_, a_size_, b_, b_size_);
+            built_ = true;
+            marked.clear();
+            last_update_ = ImGui::GetTime();
+        }
+        for (auto const& range : marked) {
+            index_.update(a_, b_, range.begin, range.end);
+        }
+        double now = ImGui::GetTime();
+        if (marking || now - last_update_ < interval_) {
+            return;
+        }
+        last_update_ = now;
+        index_.update(a_, b_, top_, top_ + visible_lines_ * columns);
+    }
+
+    // Steps from the current difference, or from the top of the view before the first step
+    void step(bool forward)
+    {
+        auto const& ranges = index_.ranges();
+        size_t i;
+        if (cursor_ != none) {
+            if (!(forward ? index_.next(cursor_, i) : index_.previous(cursor_, i))) {
+                return;
+            }
+        } else if (forward) {
+            if (ranges.empty()) {
+                return;
+            }
+            i = index_.find(top_);
+            i = i < ranges.size() ? i : 0;
+        } else if (!index_.previous(top_, i)) {
+            return;
+        }
+        cursor_ = ranges[i].begin;
+        target_ = cursor_;
+    }
+
+    void draw_toolbar()
+    {
+        if (ImGui::ArrowButton("##previous", ImGuiDir_Up)) {
+            step(false);
+        }
+        ImGui::SameLine();
+        if (ImGui::ArrowButton("##next", ImGuiDir_Down)) {
+            step(true);
+        }
+        ImGui::SameLine();
+        size_t count = index_.ranges().size();
+        size_t current = cursor_ != none ? index_.find(cursor_) : count;
+        if (count == 0) {
+            ImGui::TextUnformatted("No differences");
+        } else if (current < count && index_.ranges()[current].begin == cursor_) {
+            ImGui::Text("Difference %d of %d", static_cast<int>(current + 1), static_cast<int>(count));
+        } else {
+            ImGui::Text("%d differences", static_cast<int>(count));
+        }
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Rescan")) {
+            built_ = false;
+        }
+        if (path_ != nullptr) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("%s", path_);
+        }
+        // The scrollbar only spans view_max_lines lines, this jumps anywhere in huge memories
+        size_t lines = line_count();
+        if (lines > view_max_lines) {
+            uint64_t line = top_ / columns;
+            const uint64_t line_min = 0, line_max = lines - 1;
+            ImGui::SetNextItemWidth(-1.0f);
+            if (ImGui::SliderScalar("##line", ImGuiDataType_U64, &line, &line_min, &line_max, "line %llu")) {
+                goto_line_ = static_cast<size_t>(line);
+            }
+        }
+    }
+
+    size_t line_count() const
+    {
+        return (index_.size() + columns - 1) / columns;
+    }
+
+    size_t clamp_base(size_t base, size_t lines) const
+    {
+        if (base + view_max_lines > lines) {
+            base = lines > view_max_lines ? lines - view_max_lines : 0;
+        }
+        return base;
+    }
+
+    void draw_side(ImDrawList* draw_list, float x, float y, float char_width, const uint8_t *bytes, size_t size, const uint8_t *other, size_t other_size, size_t addr)
+    {
+        const float line_height = ImGui::GetTextLineHeight();
+        const ImU32 text_color = ImGui::GetColorU32(ImGuiCol_Text);
+        for (size_t n = 0; n < columns && addr + n < size; n++) {
+            size_t i = addr + n;
+            bool differs = i >= other_size || bytes[i] != other[i];
+            float byte_x = x + n * 3 * char_width;
+            if (differs) {
+                draw_list->AddRectFilled(ImVec2(byte_x, y), ImVec2(byte_x + 2 * char_width, y + line_height), IM_COL32(255, 96, 0, 90));
+            }
+            char text[3];
+            snprintf(text, sizeof(text), "%02X", bytes[i]);
+            draw_list->AddText(ImVec2(byte_x, y), differs ? IM_COL32(255, 140, 60, 255) : text_color, text, text + 2);
+        }
+    }
+
+    // Address, then the bytes of both sides
+    void draw_line(ImDrawList* draw_list, size_t line, float char_width)
+    {
+        ImVec2 pos = ImGui::GetCursorScreenPos();
+        size_t addr = line * columns;
+        char text[16];
+        snprintf(text, sizeof(text), "%08zX:", addr);
+        draw_list->AddText(pos, ImGui::GetColorU32(ImGuiCol_Text), text);
+        float a_x = pos.x + 10 * char_width;
+        float b_x = a_x + (columns * 3 + 2) * char_width;
+        draw_side(draw_list, a_x, pos.y, char_width, a_, a_size_, b_, b_size_, addr);
+        draw_side(draw_list, b_x, pos.y, char_width, b_, b_size_, a_, a_size_, addr);
+        ImGui::Dummy(ImVec2(b_x - pos.x + columns * 3 * char_width, ImGui::GetTextLineHeight()));
+    }
+
+    // Marks where differences are along the right edge, two pixels per step. Clicking jumps there.
+    void draw_ruler()
+    {
+        ImDrawList* draw_list = ImGui::GetWindowDrawList();
+        ImVec2 window_pos = ImGui::GetWindowPos();
+        float x1 = window_pos.x + ImGui::GetWindowContentRegionMax().x;
+        float x0 = x1 - ruler_width;
+        float y0 = window_pos.y;
+        float height = ImGui::GetWindowHeight();
+        size_t size = index_.size();
+        if (size == 0 || height <= 0.0f) {
+            return;
+        }
+        for (float y = 0.0f; y < height; y += 2.0f) {
+            size_t begin = static_cast<size_t>(static_cast<double>(y) / height * size);
+            size_t end = std::max(begin + 1, static_cast<size_t>(static_cast<double>(y + 2.0f) / height * size));
+            if (index_.any(begin, end)) {
+                draw_list->AddRectFilled(ImVec2(x0, y0 + y), ImVec2(x1, y0 + y + 2.0f), IM_COL32(255, 96, 0, 220));
+            }
+        }
+        if (ImGui::IsWindowHovered() && ImGui::IsMouseClicked(0) && ImGui::IsMouseHoveringRect(ImVec2(x0, y0), ImVec2(x1, y0 + height))) {
+            target_ = std::min(size - 1, static_cast<size_t>(static_cast<double>(ImGui::GetMousePos().y - y0) / height * size));
+        }
+    }
+
+    void draw()
+    {
+        ImGui::SetNextWindowSize(ImVec2(size_.width, size_.height), ImGuiCond_FirstUseEver);
+        ImGui::SetNextWindowPos(ImVec2(position_.x, position_.y), ImGuiCond_FirstUseEver);
+        if (path_ != nullptr && !file_.is_open()) {
+            ImGui::Begin(text_);
+            ImGui::Text("Cannot open %s", path_);
+            ImGui::End();
+            return;
+        }
+        update_index();
+        ImGui::Begin(text_);
+        draw_toolbar();
+        ImGui::Separator();
+
+        ImGui::BeginChild("##diff", ImVec2(0, 0), false, ImGuiWindowFlags_NoMove);
+        const float line_height = ImGui::GetTextLineHeight();
+        const float char_width = ImGui::CalcTextSize("F").x;
+        const size_t lines = line_count();
+        // The scroll target for a moved region was set last frame and has been applied by BeginChild() above
+        if (pending_view_line_base_ != none) {
+            view_line_base_ = pending_view_line_base_;
+            pending_view_line_base_ = none;
+        }
+        view_line_base_ = clamp_base(view_line_base_, lines);
+        const size_t view_lines = std::min(lines - view_line_base_, view_max_lines);
+
+        ImDrawList* draw_list = ImGui::GetWindowDrawList();
+        ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(0, 0));
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(view_lines), line_height);
+        int display_start = static_cast<int>(view_lines);
+        int display_end = 0;
+        while (clipper.Step()) {
+            display_start = std::min(display_start, clipper.DisplayStart);
+            display_end = std::max(display_end, clipper.DisplayEnd);
+            for (int line = clipper.DisplayStart; line < clipper.DisplayEnd; line++) {
+                draw_line(draw_list, view_line_base_ + line, char_width);
+            }
+        }
+        clipper.End();
+        ImGui::PopStyleVar();
+        top_ = (view_line_base_ + std::min<size_t>(display_start, view_lines)) * columns;
+        visible_lines_ = static_cast<size_t>(ImGui::GetWindowHeight() / line_height) + 1;
+        if (lines > view_max_lines) {
+            // Move the scrolling region before the user reaches its edges, compensating the scroll position next frame
+            const size_t margin = view_max_lines / 4;
+            size_t base = view_line_base_;
+            if (static_cast<size_t>(display_start) < margin && base > 0) {
+                base = base > margin ? base - margin : 0;
+            } else if (static_cast<size_t>(display_end) > view_max_lines - margin) {
+                base = clamp_base(base + margin, lines);
+            }
+            if (base != view_line_base_) {
+                const float shift_lines = base > view_line_base_ ? -static_cast<float>(base - view_line_base_) : static_cast<float>(view_line_base_ - base);
+                ImGui::SetScrollY(ImGui::GetScrollY() + shift_lines * line_height);
+                pending_view_line_base_ = base;
+            }
+        }
+        draw_ruler();
+        ImGui::EndChild();
+
+        if (target_ != none) {
+            // Differences are shown a third down the view, with some context above
+            const size_t context = visible_lines_ / 3;
+            goto_line_ = target_ / columns > context ? target_ / columns - context : 0;
+            target_ = none;
+        }
+        if (goto_line_ != none) {
+            const size_t base = clamp_base(goto_line_ > view_max_lines / 2 ? goto_line_ - view_max_lines / 2 : 0, lines);
+            pending_view_line_base_ = base;
+            ImGui::BeginChild("##diff");
+            ImGui::SetScrollY(static_cast<float>(goto_line_ - base) * line_height);
+            ImGui::EndChild();
+            goto_line_ = none;
+        }
+        ImGui::End();
+    }
+
+private:
+    MappedFile file_;
+    DiffIndex index_;
+    bool built_ = false;
+    double last_update_ = 0.0;
+    size_t top_ = 0;
+    size_t visible_lines_ = 0;
+    size_t view_line_base_ = 0;
+    size_t pending_view_line_base_ = none;
+    size_t goto_line_ = none;
+    size_t cursor_ = none;
+    size_t target_ = none;
+};
+
+MemoryDiffWindow::MemoryDiffWindow(const char* text, const uint8_t *a, size_t a_size, const uint8_t *b, size_t b_size, Size size, Position position) :
+    pimpl_{std::make_unique<impl>(text, a, a_size, b, b_size, size, position)}
+{}
+
+MemoryDiffWindow::MemoryDiffWindow(const char* text, const uint8_t *bytes, size_t bytes_size, const char *path, Size size, Position position) :
+    pimpl_{std::make_unique<impl>(text, bytes, bytes_size, path, size, position)}
+{}
+
+MemoryDiffWindow::~MemoryDiffWindow() = default;
+
+MemoryDiffWindow::MemoryDiffWindow(MemoryDiffWindow const& rhs)
+{
+    auto const& r = *rhs.pimpl_;
+    if (r.path_ != nullptr) {
+        pimpl_ = std::make_unique<impl>(r.text_, r.a_, r.a_size_, r.path_, r.size_, r.position_);
+    } else {
+        pimpl_ = std::make_unique<impl>(r.text_, r.a_, r.a_size_, r.b_, r.b_size_, r.size_, r.position_);
+    }
+    pimpl_->interval(r.interval_);
+    pimpl_->marks_ = r.marks_;
+}
+
+void MemoryDiffWindow::draw() const
+{
+    pimpl_->draw();
+}
+
+MemoryDiffWindow& MemoryDiffWindow::interval(double seconds)
+{
+    pimpl_->interval(seconds);
+    return *this;
+}
+
+MemoryDiffWindow& MemoryDiffWindow::mark_changed(size_t begin, size_t end)
+{
+    pimpl_->mark_changed(begin, end);
+    return *this;
+}
+
+}
@@ -0,0 +1,790 @@
+#include <gui/gui.h>
+#include "imgui.h"
+#include "imgui_memory_editor.h"
+#include "change_tracker.h"
+#include "bitmap_view.h"
+#include "checksum.h"
+#include "hex_file.h"
+#include "memory_minimap.h"
+#include "memory_search.h"
+#include "snapshot_history.h"
+#include "struct_overlay.h"
+#include "symbol_table.h"
+#include "mapped_file.h"
+#include "paged_memory.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace guicpp
+{
+
+struct MemoryEditorWindow::impl
+{
+    // Edits to a mapped file are written back in batches, so typing into a multi-GB file
+    // never waits on the disk.
+    static constexpr uint64_t sync_page_size = 4096;
+    static constexpr auto sync_interval = std::chrono::milliseconds(250);
+    // Bigger memories are not shadowed for the heatmap and watches
+    static constexpr size_t max_tracked_size = 256 << 20;
+
+    const char *text_;
+    const char *path_ = nullptr;
+    std::shared_ptr<MemoryProvider> provider_;
+    uint8_t *bytes_;
+    size_t bytes_size_;
+    Size size_;
+    Position position_;
+    MemoryEditor memory_editor;
+
+    impl(const char* text, uint8_t *bytes, size_t bytes_size, Size size = {}, Position position = {}) :
+        text_{text},
+        bytes_{bytes},
+        bytes_size_{bytes_size},
+        size_{size},
+        position_{position}
+    {}
+
+    impl(const char* text, const char *path, Size size = {}, Position position = {}) :
+        text_{text},
+        path_{path},
+        bytes_{nullptr},
+        bytes_size_{0},
+        size_{size},
+        position_{position}
+    {
+        if (!file_.open(path_, true)) {
+            if (!file_.open(path_, false)) {
+                return;
+            }
+            memory_editor.ReadOnly = true;
+        }
+        bytes_ = file_.data();
+        bytes_size_ = static_cast<size_t>(file_.size());
+        set_on_write();
+    }
+
+    impl(const char* text, std::shared_ptr<MemoryProvider> provider, Size size = {}, Position position = {}) :
+        text_{text},
+        provider_{std::move(provider)},
+        bytes_{nullptr},
+        bytes_size_{0},
+        size_{size},
+        position_{position}
+    {
+        memory_editor.ReadRangeFn = [](void *user_data, size_t off, ImU8 *out, size_t size) {
+            static_cast<impl*>(user_data)->provider_->read(off, out, size);
+        };
+        memory_editor.WriteRangeFn = [](void *user_data, size_t off, const ImU8 *in, size_t size) {
+            static_cast<impl*>(user_data)->provider_->write(off, in, size);
+        };
+        memory_editor.HighlightRangeFn = [](void *user_data, size_t off, bool *out, size_t size) {
+            std::fill(out, out + size, false);
+            static_cast<impl*>(user_data)->provider_->highlight(off, out, size);
+        };
+        memory_editor.PendingRangeFn = [](void *user_data, size_t off, bool *out, size_t size) {
+            static_cast<impl*>(user_data)->provider_->pending(off, out, size);
+        };
+        memory_editor.UserData = this;
+        piece_table_ = std::dynamic_pointer_cast<PieceTable>(provider_);
+        if (piece_table_) {
+            memory_editor.InsertRangeFn = [](void *user_data, size_t off, const ImU8 *in, size_t size) {
+                static_cast<impl*>(user_data)->piece_table_->insert(off, in, size);
+            };
+            memory_editor.EraseRangeFn = [](void *user_data, size_t off, size_t size) {
+                static_cast<impl*>(user_data)->piece_table_->erase(off, size);
+            };
+        }
+    }
+
+    impl(const char* text, std::shared_ptr<PageSource> source, Size size = {}, Position position = {}) :
+        impl(text, std::static_pointer_cast<MemoryProvider>(std::make_shared<PagedMemory>(std::move(source))), size, position)
+    {}
+
+    ~impl()
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            stop_ = true;
+        }
+        cv_.notify_one();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    void set_on_write()
+    {
+        memory_editor.OnWriteFn = [](void *user_data, size_t off, size_t size) {
+            static_cast<impl*>(user_data)->on_write(off, size);
+        };
+        memory_editor.UserData = this;
+    }
+
+    void on_write(size_t off, size_t size)
+    {
+        if (path_ != nullptr) {
+            mark_dirty(off, size);
+        }
+        if (persist_ != nullptr) {
+            persist_->mark_dirty(off, size);
+        }
+    }
+
+    void persist(PersistentMemory &memory)
+    {
+        persist_ = &memory;
+        set_on_write();
+    }
+
+    void mark_dirty(size_t off, size_t size)
+    {
+        if (size == 0) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            for (uint64_t page = off / sync_page_size; page <= (off + size - 1) / sync_page_size; page++) {
+                dirty_.insert(page);
+            }
+        }
+        if (!thread_.joinable()) {
+            thread_ = std::thread([this]() { run(); });
+        }
+        cv_.notify_one();
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        while (!stop_) {
+            cv_.wait(lock, [this]() { return stop_ || !dirty_.empty(); });
+            cv_.wait_for(lock, sync_interval, [this]() { return stop_; });
+            sync(lock);
+        }
+    }
+
+    // Flushes the collected pages as contiguous ranges, without holding the lock.
+    void sync(std::unique_lock<std::mutex> &lock)
+    {
+        std::set<uint64_t> pages;
+        pages.swap(dirty_);
+        lock.unlock();
+        auto it = pages.begin();
+        while (it != pages.end()) {
+            uint64_t first = *it;
+            uint64_t last = first;
+            while (++it != pages.end() && *it == last + 1) {
+                last = *it;
+            }
+            file_.flush(first * sync_page_size, (last - first + 1) * sync_page_size);
+        }
+        lock.lock();
+    }
+
+    void draw() {
+        ImGui::SetNextWindowSize(ImVec2(size_.width, size_.height), ImGuiCond_FirstUseEver);
+        ImGui::SetNextWindowPos(ImVec2(position_.x, position_.y), ImGuiCond_FirstUseEver);
+        if (path_ != nullptr && !file_.is_open()) {
+            ImGui::Begin(text_);
+            ImGui::Text("Cannot open %s", path_);
+            ImGui::End();
+            return;
+        }
+        track();
+        draw_overlays();
+        draw_bitmaps();
+        take_snapshot(snapshot_requested_);
+        snapshot_requested_ = false;
+        memory_editor.OptFooterExtraHeight = SearchPanel::height() + (history_ ? ImGui::GetFrameHeightWithSpacing() : 0.0f) +
+            (checksums_ ? ChecksumPanel::height() : 0.0f) + (piece_table_ ? ImGui::GetFrameHeightWithSpacing() : 0.0f) +
+            (hex_files_ ? HexFilePanel::height() : 0.0f) + (minimap_ ? MemoryMinimap::height() : 0.0f);
+        memory_editor.DrawFooterFn = [](void *user_data) {
+            static_cast<impl*>(user_data)->draw_footer();
+        };
+        memory_editor.UserData = this;
+        if (history_ && history_position_ < snapshots_.count()) {
+            draw_snapshot();
+            return;
+        }
+        memory_editor.DrawWindow(text_, bytes_, memory_size(), static_cast<size_t>(labels_.base()));
+    }
+
+    size_t memory_size() const
+    {
+        return provider_ ? provider_->size() : bytes_size_;
+    }
+
+    // Past snapshots are drawn from the history with the handlers of the live memory put aside
+    void draw_snapshot()
+    {
+        auto const& bytes = snapshots_.get(history_position_);
+        auto read = memory_editor.ReadRangeFn;
+        auto write = memory_editor.WriteRangeFn;
+        auto highlight = memory_editor.HighlightRangeFn;
+        auto pending = memory_editor.PendingRangeFn;
+        auto heat = memory_editor.HeatRangeFn;
+        auto side = memory_editor.DrawSideFn;
+        bool read_only = memory_editor.ReadOnly;
+        memory_editor.ReadRangeFn = nullptr;
+        memory_editor.WriteRangeFn = nullptr;
+        memory_editor.HighlightRangeFn = nullptr;
+        memory_editor.PendingRangeFn = nullptr;
+        memory_editor.HeatRangeFn = nullptr;
+        memory_editor.DrawSideFn = nullptr;
+        memory_editor.ReadOnly = true;
+        memory_editor.DrawWindow(text_, const_cast<uint8_t*>(bytes.data()), bytes.size(), static_cast<size_t>(labels_.base()));
+        memory_editor.ReadRangeFn = read;
+        memory_editor.WriteRangeFn = write;
+        memory_editor.HighlightRangeFn = highlight;
+        memory_editor.PendingRangeFn = pending;
+        memory_editor.HeatRangeFn = heat;
+        memory_editor.DrawSideFn = side;
+        memory_editor.ReadOnly = read_only;
+    }
+
+    void draw_footer()
+    {
+        ImGui::Separator();
+        if (piece_table_) {
+            draw_edits();
+        }
+        if (history_) {
+            draw_timeline();
+        }
+        draw_search();
+        if (checksums_) {
+            checksum_panel_.draw([this](size_t &size) { return checksum_memory(size); }, memory_editor.HighlightMin, memory_editor.HighlightMax);
+        }
+        if (hex_files_) {
+            draw_hex_files();
+        }
+        if (minimap_) {
+            minimap_panel_.draw_line(memory_editor.HighlightMin, memory_editor.HighlightMax);
+        }
+    }
+
+    // Imports go through the provider, or into the bytes with the pages marked dirty like edits
+    void draw_hex_files()
+    {
+        auto read = [this](size_t offset, uint8_t *out, size_t size) {
+            if (provider_) {
+                provider_->read(offset, out, size);
+            } else {
+                std::copy(bytes_ + offset, bytes_ + offset + size, out);
+            }
+        };
+        HexFilePanel::WriteFn write;
+        if (!memory_editor.ReadOnly) {
+            write = [this](size_t offset, const uint8_t *in, size_t size) {
+                if (provider_) {
+                    provider_->write(offset, in, size);
+                    return;
+                }
+                std::copy(in, in + size, bytes_ + offset);
+                if (memory_editor.OnWriteFn != nullptr) {
+                    memory_editor.OnWriteFn(memory_editor.UserData, offset, size);
+                }
+            };
+        }
+        hex_panel_.draw(hex_base_, memory_size(), read, write, memory_editor.HighlightMin, memory_editor.HighlightMax);
+    }
+
+    // Undo, redo and save of a piece table, with Ctrl+Z and Ctrl+Y anywhere in the window
+    void draw_edits()
+    {
+        auto &table = *piece_table_;
+        auto const& io = ImGui::GetIO();
+        const bool shortcut = io.KeyCtrl && ImGui::IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows);
+        if (ImGui::Button("Undo") || (shortcut && ImGui::IsKeyPressed(ImGui::GetKeyIndex(ImGuiKey_Z)))) {
+            table.undo();
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Redo") || (shortcut && ImGui::IsKeyPressed(ImGui::GetKeyIndex(ImGuiKey_Y)))) {
+            table.redo();
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Save")) {
+            save_failed_ = !table.save();
+        }
+        ImGui::SameLine();
+        if (save_failed_) {
+            ImGui::Text("Cannot save %s", table.path());
+        } else {
+            ImGui::Text("%s%s, %d pieces", table.path(), table.modified() ? " (modified)" : "", static_cast<int>(table.piece_count()));
+        }
+    }
+
+    // The last slider position shows the live memory
+    void draw_timeline()
+    {
+        // Taken on the next frame, the bytes being drawn may belong to the history
+        if (ImGui::Button("Snapshot")) {
+            snapshot_requested_ = true;
+        }
+        ImGui::SameLine();
+        size_t count = snapshots_.count();
+        bool live = history_position_ >= count;
+        char label[64];
+        if (live) {
+            snprintf(label, sizeof(label), "Live (%d snapshots, %d KB)", static_cast<int>(count), static_cast<int>(snapshots_.memory() >> 10));
+        } else {
+            snprintf(label, sizeof(label), "#%d, %.0f s ago", static_cast<int>(history_position_), ImGui::GetTime() - snapshots_.time(history_position_));
+        }
+        int position = static_cast<int>(live ? count : history_position_);
+        ImGui::SetNextItemWidth(-1.0f);
+        if (ImGui::SliderInt("##timeline", &position, 0, static_cast<int>(count), label)) {
+            history_position_ = static_cast<size_t>(position);
+        }
+        // Stay live while new snapshots come in
+        history_live_ = history_position_ >= count;
+    }
+
+    void draw_search()
+    {
+        MemorySearch::Match match;
+        size_t match_size;
+        if (search_.draw([this](SearchPattern const&) { return search_regions(); }, match, match_size)) {
+            memory_editor.GotoAddrAndHighlight(match.offset, match.offset + match_size);
+        }
+    }
+
+    // Providers are searched in a copy, paged sources not at all
+    std::vector<MemorySearch::Region> search_regions()
+    {
+        if (provider_) {
+            if (dynamic_cast<PagedMemory*>(provider_.get()) != nullptr) {
+                return {};
+            }
+            search_bytes_.resize(provider_->size());
+            provider_->read(0, search_bytes_.data(), search_bytes_.size());
+            return {MemorySearch::Region{search_bytes_.data(), search_bytes_.size()}};
+        }
+        if (bytes_ == nullptr) {
+            return {};
+        }
+        return {MemorySearch::Region{bytes_, bytes_size_}};
+    }
+
+    void heatmap(double decay, double interval)
+    {
+        tracking_ = heatmap_ = true;
+        heatmap_decay_ = decay;
+        heatmap_interval_ = interval;
+        tracker_.set_decay(decay);
+        tracker_.set_interval(interval);
+        memory_editor.HeatRangeFn = [](void *user_data, size_t off, float *out, size_t size) {
+            static_cast<impl*>(user_data)->tracker_.heat(off, out, size, ImGui::GetTime());
+        };
+        memory_editor.UserData = this;
+    }
+
+    void watch(size_t offset, size_t size, MemoryWatchFn f)
+    {
+        tracking_ = true;
+        tracker_.add_watch(offset, size, std::move(f));
+    }
+
+    void history(double interval, size_t max_bytes)
+    {
+        history_ = true;
+        history_interval_ = interval;
+        history_max_bytes_ = max_bytes;
+        snapshots_.set_max_bytes(max_bytes);
+    }
+
+    void take_snapshot(bool now)
+    {
+        double time = ImGui::GetTime();
+        if (!history_ || (!now && (history_interval_ <= 0.0 || time - history_taken_ < history_interval_))) {
+            return;
+        }
+        size_t size;
+        const uint8_t *bytes = whole_memory(size);
+        if (bytes == nullptr) {
+            return;
+        }
+        size_t count = snapshots_.count();
+        snapshots_.take(bytes, size, time);
+        history_taken_ = time;
+        // Old snapshots may have been dropped, keep showing the same one
+        if (history_live_) {
+            history_position_ = snapshots_.count();
+        } else if (history_position_ + snapshots_.count() >= count + 1) {
+            history_position_ -= count + 1 - snapshots_.count();
+        } else {
+            history_position_ = 0;
+        }
+    }
+
+    void checksums()
+    {
+        checksums_ = true;
+    }
+
+    void overlay(const char *text, StructLayout layout, size_t offset, Size size, Position position)
+    {
+        overlays_.push_back(Overlay{text, StructOverlay{std::move(layout), offset}, size, position});
+    }
+
+    void symbols(SymbolTable const& table, uint64_t base)
+    {
+        labels_ = SymbolLabels{&table, base};
+        memory_editor.LineLabelFn = [](void *user_data, size_t off, size_t size, bool *dim) {
+            auto self = static_cast<impl*>(user_data);
+            return self->labels_.label(self->labels_.base() + off, size, *dim);
+        };
+        memory_editor.GotoNameFn = [](void *user_data, const char *name, size_t *off) {
+            auto self = static_cast<impl*>(user_data);
+            uint64_t address;
+            if (!self->labels_.resolve(name, address) || address < self->labels_.base() || address - self->labels_.base() >= self->memory_size()) {
+                return false;
+            }
+            *off = static_cast<size_t>(address - self->labels_.base());
+            return true;
+        };
+        memory_editor.UserData = this;
+    }
+
+    // Each overlay reads only its own bytes, and clicking a row highlights them in the editor
+    void draw_overlays()
+    {
+        const double now = ImGui::GetTime();
+        const size_t size_of_memory = memory_size();
+        for (auto &o : overlays_) {
+            size_t offset = o.overlay.offset();
+            size_t size = offset < size_of_memory ? std::min(o.overlay.layout().size(), size_of_memory - offset) : 0;
+            const uint8_t *bytes = overlay_bytes_.data();
+            if (provider_) {
+                overlay_bytes_.resize(size);
+                provider_->read(offset, overlay_bytes_.data(), size);
+                bytes = overlay_bytes_.data();
+            } else if (size > 0) {
+                bytes = bytes_ + offset;
+            }
+            o.overlay.update(bytes, size, now);
+
+            ImGui::SetNextWindowSize(ImVec2(o.size.width, o.size.height), ImGuiCond_FirstUseEver);
+            ImGui::SetNextWindowPos(ImVec2(o.position.x, o.position.y), ImGuiCond_FirstUseEver);
+            ImGui::Begin(o.text);
+            ImGui::Text("%s at %zX", o.overlay.layout().name().c_str(), offset);
+            size_t begin, end;
+            if (o.overlay.draw(now, begin, end)) {
+                memory_editor.GotoAddrAndHighlight(begin, end);
+            }
+            ImGui::End();
+        }
+    }
+
+    void bitmap(const char *text, PixelFormat format, size_t offset, int width, int height, Size size, Position position)
+    {
+        bitmaps_.push_back(Bitmap{text, BitmapView{format, offset, width, height}, size, position});
+    }
+
+    // Like the overlays, each bitmap reads only its own bytes
+    void draw_bitmaps()
+    {
+        const size_t size_of_memory = memory_size();
+        for (auto &b : bitmaps_) {
+            size_t offset = b.view.offset();
+            size_t size = offset < size_of_memory ? std::min(b.view.size(), size_of_memory - offset) : 0;
+            const uint8_t *bytes = bitmap_bytes_.data();
+            if (provider_) {
+                bitmap_bytes_.resize(size);
+                provider_->read(offset, bitmap_bytes_.data(), size);
+                bytes = bitmap_bytes_.data();
+            } else if (size > 0) {
+                bytes = bytes_ + offset;
+            }
+            b.view.update(bytes, size);
+
+            ImGui::SetNextWindowSize(ImVec2(b.size.width, b.size.height), ImGuiCond_FirstUseEver);
+            ImGui::SetNextWindowPos(ImVec2(b.position.x, b.position.y), ImGuiCond_FirstUseEver);
+            ImGui::Begin(b.text);
+            size_t begin, end;
+            if (b.view.draw(begin, end)) {
+                memory_editor.GotoAddrAndHighlight(begin, end);
+            }
+            ImGui::End();
+        }
+    }
+
+    void hex_files(uint64_t base)
+    {
+        hex_files_ = true;
+        hex_base_ = base;
+    }
+
+    // The column goes beside the rows, clicking or dragging in it scrolls the editor there
+    void minimap(double interval)
+    {
+        minimap_ = true;
+        minimap_interval_ = interval;
+        minimap_panel_.set_interval(interval);
+        memory_editor.OptSideExtraWidth = MemoryMinimap::width();
+        memory_editor.DrawSideFn = [](void *user_data, size_t visible_begin, size_t visible_end) {
+            auto self = static_cast<impl*>(user_data);
+            size_t offset;
+            if (self->minimap_panel_.draw_map([self](size_t &size) { return self->minimap_memory(size); }, visible_begin, visible_end, offset)) {
+                self->memory_editor.GotoAddr = offset;
+            }
+        };
+        memory_editor.UserData = this;
+    }
+
+    void copy_tracking(impl const& rhs)
+    {
+        checksums_ = rhs.checksums_;
+        if (rhs.minimap_) {
+            minimap(rhs.minimap_interval_);
+        }
+        hex_files_ = rhs.hex_files_;
+        hex_base_ = rhs.hex_base_;
+        overlays_ = rhs.overlays_;
+        for (auto const& b : rhs.bitmaps_) {
+            bitmaps_.push_back(b);
+        }
+        if (rhs.labels_.enabled()) {
+            symbols(*rhs.labels_.table(), rhs.labels_.base());
+        }
+        if (rhs.history_) {
+            history(rhs.history_interval_, rhs.history_max_bytes_);
+        }
+        if (rhs.persist_ != nullptr) {
+            persist(*rhs.persist_);
+        }
+        tracker_ = rhs.tracker_;
+        tracking_ = rhs.tracking_;
+        if (rhs.heatmap_) {
+            heatmap(rhs.heatmap_decay_, rhs.heatmap_interval_);
+        }
+    }
+
+    // All bytes for tracking and snapshots, providers are read into a copy. Paged sources are not
+    // read, that would fetch every page.
+    const uint8_t* whole_memory(size_t &size)
+    {
+        if (provider_) {
+            size = provider_->size();
+            if (dynamic_cast<PagedMemory*>(provider_.get()) != nullptr || size > max_tracked_size) {
+                return nullptr;
+            }
+            provider_bytes_.resize(size);
+            provider_->read(0, provider_bytes_.data(), size);
+            return provider_bytes_.data();
+        }
+        size = bytes_size_;
+        return bytes_size_ <= max_tracked_size ? bytes_ : nullptr;
+    }
+
+    // Like whole_memory, with providers read into a copy of its own that the checksum worker can
+    // keep reading while the window copies the memory again
+    const uint8_t* checksum_memory(size_t &size)
+    {
+        if (!provider_) {
+            return whole_memory(size);
+        }
+        size = provider_->size();
+        if (dynamic_cast<PagedMemory*>(provider_.get()) != nullptr || size > max_tracked_size) {
+            return nullptr;
+        }
+        checksum_bytes_.resize(size);
+        provider_->read(0, checksum_bytes_.data(), size);
+        return checksum_bytes_.data();
+    }
+
+    // Bytes of any size are read in place, the worker only hashing most blocks of a pass.
+    // Providers are copied like for checksums, into a buffer of the minimap's own.
+    const uint8_t* minimap_memory(size_t &size)
+    {
+        if (!provider_) {
+            size = bytes_size_;
+            return bytes_;
+        }
+        size = provider_->size();
+        if (dynamic_cast<PagedMemory*>(provider_.get()) != nullptr || size > max_tracked_size) {
+            return nullptr;
+        }
+        minimap_bytes_.resize(size);
+        provider_->read(0, minimap_bytes_.data(), size);
+        return minimap_bytes_.data();
+    }
+
+    void track()
+    {
+        double now = ImGui::GetTime();
+        if (!tracking_ || !tracker_.due(now)) {
+            return;
+        }
+        size_t size;
+        if (const uint8_t *bytes = whole_memory(size)) {
+            tracker_.update(bytes, size, now);
+        }
+    }
+
+private:
+    struct Overlay
+    {
+        const char *text;
+        StructOverlay overlay;
+        Size size;
+        Position position;
+    };
+
+    struct Bitmap
+    {
+        const char *text;
+        BitmapView view;
+        Size size;
+        Position position;
+    };
+
+    PersistentMemory *persist_ = nullptr;
+    ChangeTracker tracker_;
+    bool tracking_ = false;
+    bool heatmap_ = false;
+    double heatmap_decay_ = 0.0;
+    double heatmap_interval_ = 0.0;
+    std::vector<uint8_t> provider_bytes_;
+    SnapshotHistory snapshots_;
+    bool history_ = false;
+    bool history_live_ = true;
+    bool snapshot_requested_ = false;
+    size_t history_position_ = 0;
+    double history_interval_ = 0.0;
+    double history_taken_ = 0.0;
+    size_t history_max_bytes_ = 0;
+    SearchPanel search_;
+    std::vector<uint8_t> search_bytes_;
+    std::vector<Overlay> overlays_;
+    std::vector<uint8_t> overlay_bytes_;
+    std::vector<Bitmap> bitmaps_;
+    std::vector<uint8_t> bitmap_bytes_;
+    SymbolLabels labels_;
+    std::shared_ptr<PieceTable> piece_table_;
+    bool hex_files_ = false;
+    uint64_t hex_base_ = 0;
+    HexFilePanel hex_panel_;
+    bool save_failed_ = false;
+    MappedFile file_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::set<uint64_t> dirty_;
+    bool stop_ = false;
+    // Last, so that the checksum and minimap workers stop before the memory they read goes away
+    bool checksums_ = false;
+    std::vector<uint8_t> checksum_bytes_;
+    ChecksumPanel checksum_panel_;
+    bool minimap_ = false;
+    double minimap_interval_ = 1.0;
+    std::vector<uint8_t> minimap_bytes_;
+    MemoryMinimap minimap_panel_;
+};
+
+MemoryEditorWindow::MemoryEditorWindow(const char* text, uint8_t *bytes, size_t bytes_size, Size size, Position position) :
+    pimpl_{std::make_unique<impl>(text, bytes, bytes_size, size, position)}
+{}
+
+MemoryEditorWindow::MemoryEditorWindow(const char* text, const char *path, Size size, Position position) :
+    pimpl_{std::make_unique<impl>(text, path, size, position)}
+{}
+
+MemoryEditorWindow::MemoryEditorWindow(const char* text, std::shared_ptr<MemoryProvider> provider, Size size, Position position) :
+    pimpl_{std::make_unique<impl>(text, std::move(provider), size, position)}
+{}
+
+MemoryEditorWindow::MemoryEditorWindow(const char* text, std::shared_ptr<PageSource> source, Size size, Position position) :
+    pimpl_{std::make_unique<impl>(text, std::move(source), size, position)}
+{}
+
+MemoryEditorWindow::~MemoryEditorWindow() = default;
+
+MemoryEditorWindow::MemoryEditorWindow(MemoryEditorWindow const& rhs)
+{
+    auto const& r = *rhs.pimpl_;
+    if (r.path_ != nullptr) {
+        pimpl_ = std::make_unique<impl>(r.text_, r.path_, r.size_, r.position_);
+    } else if (r.provider_) {
+        pimpl_ = std::make_unique<impl>(r.text_, r.provider_, r.size_, r.position_);
+    } else {
+        pimpl_ = std::make_unique<impl>(r.text_, r.bytes_, r.bytes_size_, r.size_, r.position_);
+    }
+    pimpl_->copy_tracking(r);
+}
+
+void MemoryEditorWindow::draw() const
+{
+    pimpl_->draw();
+}
+
+MemoryEditorWindow& MemoryEditorWindow::heatmap(double decay, double interval)
+{
+    pimpl_->heatmap(decay, interval);
+    return *this;
+}
+
+MemoryEditorWindow& MemoryEditorWindow::watch(size_t offset, size_t size, MemoryWatchFn f)
+{
+    pimpl_->watch(offset, size, std::move(f));
+    return *this;
+}
+
+MemoryEditorWindow& MemoryEditorWindow::history(double interval, size_t max_bytes)
+{
+    pimpl_->history(interval, max_bytes);
+    return *this;
+}
+
+MemoryEditorWindow& MemoryEditorWindow::persist(PersistentMemory &memory)
+{
+    pimpl_->persist(memory);
+    return *this;
+}
+
+MemoryEditorWindow& MemoryEditorWindow::overlay(const char *text, StructLayout layout, size_t offset, Size size, Position position)
+{
+    pimpl_->overlay(text, std::move(layout), offset, size, position);
+    return *this;
+}
+
+MemoryEditorWindow& MemoryEditorWindow::bitmap(const char *text, PixelFormat format, size_t offset, int width, int height, Size size, Position position)
+{
+    pimpl_->bitmap(text, format, offset, width, height, size, position);
+    return *this;
+}
+
+MemoryEditorWindow& MemoryEditorWindow::symbols(SymbolTable const& table, uint64_t base)
+{
+    pimpl_->symbols(table, base);
+    return *this;
+}
+
+MemoryEditorWindow& MemoryEditorWindow::hex_files(uint64_t base)
+{
+    pimpl_->hex_files(base);
+    return *this;
+}
+
+MemoryEditorWindow& MemoryEditorWindow::minimap(double interval)
+{
+    pimpl_->minimap(interval);
+    return *this;
+}
+
+MemoryEditorWindow& MemoryEditorWindow::checksums()
+{
+    pimpl_->checksums();
+    return *this;
+}
+
+MemoryEditorWindow& MemoryEditorWindow::watch(const char *name, size_t offset, size_t size, LogChannel channel)
+{
+    pimpl_->watch(offset, size, log_watch(name, std::move(channel)));
+    return *this;
+}
+
+}
@@ -0,0 +1,384 @@
+#include "memory_minimap.h"
+#include "sector_overview.h"
+#include "imgui.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GUICPP_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace guicpp
+{
+
+namespace
+{
+
+int popcount8(uint8_t b)
+{
+    int n = 0;
+    for (; b != 0; b &= b - 1) {
+        n++;
+    }
+    return n;
+}
+
+ImU32 lerp_color(ImVec4 const& a, ImVec4 const& b, float t)
+{
+    t = std::min(1.0f, std::max(0.0f, t));
+    return ImGui::ColorConvertFloat4ToU32(ImVec4(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t, 1.0f));
+}
+
+}
+
+ByteAggregate aggregate_bytes(const uint8_t *data, size_t size)
+{
+    ByteAggregate result{0xFF, 0, 0, 0, size};
+    size_t i = 0;
+#ifdef GUICPP_SSE2
+    if (size >= 16) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i m1 = _mm_set1_epi8(0x55);
+        const __m128i m2 = _mm_set1_epi8(0x33);
+        const __m128i m4 = _mm_set1_epi8(0x0F);
+        __m128i min = _mm_set1_epi8(static_cast<char>(0xFF));
+        __m128i max = zero;
+        __m128i sum = zero;
+        __m128i bits = zero;
+        for (; i + 16 <= size; i += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            min = _mm_min_epu8(min, v);
+            max = _mm_max_epu8(max, v);
+            sum = _mm_add_epi64(sum, _mm_sad_epu8(v, zero));
+            // Bits set per byte, by pairs, nibbles and bytes
+            __m128i c = _mm_sub_epi8(v, _mm_and_si128(_mm_srli_epi16(v, 1), m1));
+            c = _mm_add_epi8(_mm_and_si128(c, m2), _mm_and_si128(_mm_srli_epi16(c, 2), m2));
+            c = _mm_and_si128(_mm_add_epi8(c, _mm_srli_epi16(c, 4)), m4);
+            bits = _mm_add_epi64(bits, _mm_sad_epu8(c, zero));
+        }
+        uint8_t lanes8[16];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes8), min);
+        result.min = *std::min_element(lanes8, lanes8 + 16);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes8), max);
+        result.max = *std::max_element(lanes8, lanes8 + 16);
+        uint64_t lanes[2];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), sum);
+        result.sum = lanes[0] + lanes[1];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), bits);
+        result.popcount = lanes[0] + lanes[1];
+    }
+#endif
+    for (; i < size; i++) {
+        result.min = std::min(result.min, data[i]);
+        result.max = std::max(result.max, data[i]);
+        result.sum += data[i];
+        result.popcount += popcount8(data[i]);
+    }
+    return result;
+}
+
+ByteAggregate aggregate_join(ByteAggregate const& first, ByteAggregate const& second)
+{
+    if (first.size == 0) {
+        return second;
+    }
+    if (second.size == 0) {
+        return first;
+    }
+    return ByteAggregate{std::min(first.min, second.min), std::max(first.max, second.max), first.sum + second.sum,
+                         first.popcount + second.popcount, first.size + second.size};
+}
+
+// Four histograms take turns so that runs of equal bytes do not wait on the same counter.
+// Blocks of one value, erased or zeroed memory, skip the histogram.
+BlockStats block_stats(const uint8_t *data, size_t size)
+{
+    BlockStats stats{};
+    stats.aggregate = aggregate_bytes(data, size);
+    uint32_t counts[256] = {};
+    if (size == 0) {
+        return stats;
+    }
+    if (stats.aggregate.min == stats.aggregate.max) {
+        counts[stats.aggregate.min] = static_cast<uint32_t>(size);
+    } else {
+        uint32_t histograms[4][256] = {};
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, data + i, sizeof(word));
+            histograms[0][word & 0xFF]++;
+            histograms[1][word >> 8 & 0xFF]++;
+            histograms[2][word >> 16 & 0xFF]++;
+            histograms[3][word >> 24 & 0xFF]++;
+            histograms[0][word >> 32 & 0xFF]++;
+            histograms[1][word >> 40 & 0xFF]++;
+            histograms[2][word >> 48 & 0xFF]++;
+            histograms[3][word >> 56]++;
+        }
+        for (; i < size; i++) {
+            histograms[0][data[i]]++;
+        }
+        for (int b = 0; b < 256; b++) {
+            counts[b] = histograms[0][b] + histograms[1][b] + histograms[2][b] + histograms[3][b];
+        }
+    }
+    // H = log2(n) - sum(c log2 c) / n
+    double weighted = 0.0;
+    for (int b = 0; b < 256; b++) {
+        if (counts[b] > 1) {
+            weighted += counts[b] * std::log2(static_cast<double>(counts[b]));
+        }
+        if (b >= 32 && b < 127) {
+            stats.printable += counts[b];
+        }
+    }
+    const double n = static_cast<double>(size);
+    stats.entropy = static_cast<float>(std::max(0.0, std::log2(n) - weighted / n));
+    stats.zeros = counts[0];
+    stats.ones = counts[255];
+    return stats;
+}
+
+MemoryMinimap::~MemoryMinimap()
+{
+    stop_ = true;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+float MemoryMinimap::width()
+{
+    return ImGui::GetFontSize() * 2.0f;
+}
+
+float MemoryMinimap::height()
+{
+    return ImGui::GetFrameHeightWithSpacing();
+}
+
+bool MemoryMinimap::draw_map(BytesFn const& bytes, size_t visible_begin, size_t visible_end, size_t &offset)
+{
+    const double now = ImGui::GetTime();
+    if (!running_ && thread_.joinable()) {
+        thread_.join();
+        shown_blocks_ = blocks_;
+        shown_block_size_ = block_size_;
+        shown_size_ = size_;
+        shown_selection_ = selection_;
+        shown_selection_begin_ = job_begin_;
+        shown_selection_end_ = job_end_;
+    }
+    if (!running_ && (selection_changed_ || now - started_ >= interval_)) {
+        size_t size = 0;
+        const uint8_t *data = bytes(size);
+        unavailable_ = data == nullptr;
+        started_ = now;
+        if (!unavailable_) {
+            start(data, size);
+        }
+    }
+
+    const ImVec2 pos = ImGui::GetCursorScreenPos();
+    const ImVec2 area = ImGui::GetContentRegionAvail();
+    const float height = std::max(area.y, 1.0f);
+    ImGui::InvisibleButton("##minimap", ImVec2(std::max(area.x, 1.0f), height));
+    ImDrawList *draw_list = ImGui::GetWindowDrawList();
+    const ImVec2 end{pos.x + area.x, pos.y + height};
+    draw_list->AddRectFilled(pos, end, ImGui::GetColorU32(ImGuiCol_FrameBg));
+    const size_t count = shown_blocks_.size();
+    if (count == 0 || shown_size_ == 0) {
+        return false;
+    }
+
+    // Two pixels per step, each showing all the blocks it covers
+    for (float y = 0.0f; y < height; y += 2.0f) {
+        const size_t begin = std::min(count - 1, static_cast<size_t>(static_cast<double>(y) / height * count));
+        const size_t stop = std::max(begin + 1, static_cast<size_t>(static_cast<double>(y + 2.0f) / height * count));
+        draw_list->AddRectFilled(ImVec2(pos.x, pos.y + y), ImVec2(end.x, std::min(end.y, pos.y + y + 2.0f)), color(begin, std::min(stop, count)));
+    }
+    const float top = static_cast<float>(static_cast<double>(std::min(visible_begin, shown_size_)) / shown_size_ * height);
+    const float bottom = std::max(top + 2.0f, static_cast<float>(static_cast<double>(std::min(visible_end, shown_size_)) / shown_size_ * height));
+    draw_list->AddRect(ImVec2(pos.x, pos.y + top), ImVec2(end.x, pos.y + bottom), IM_COL32(255, 255, 255, 220));
+
+    const float mouse_y = std::min(height - 1.0f, std::max(0.0f, ImGui::GetMousePos().y - pos.y));
+    const size_t block = std::min(count - 1, static_cast<size_t>(static_cast<double>(mouse_y) / height * count));
+    if (ImGui::IsItemHovered() && !ImGui::IsItemActive()) {
+        const size_t stop = std::max(block + 1, static_cast<size_t>(static_cast<double>(mouse_y + 1.0f) / height * count));
+        tooltip(block, std::min(stop, count));
+    }
+    if (ImGui::IsItemActive()) {
+        offset = std::min(block * shown_block_size_, shown_size_ - 1);
+        return true;
+    }
+    return false;
+}
+
+void MemoryMinimap::draw_line(size_t highlight_begin, size_t highlight_end)
+{
+    static const char *modes[] = {"Entropy", "Fill", "Text"};
+    int mode = static_cast<int>(mode_);
+    ImGui::SetNextItemWidth(ImGui::CalcTextSize("Entropy").x + ImGui::GetFrameHeight() + ImGui::GetStyle().FramePadding.x * 2.0f);
+    if (ImGui::Combo("##minimap", &mode, modes, IM_ARRAYSIZE(modes))) {
+        mode_ = static_cast<Mode>(mode);
+    }
+    ImGui::SameLine();
+
+    const bool selected = highlight_end != static_cast<size_t>(-1) && highlight_begin < highlight_end;
+    const size_t begin = selected ? highlight_begin : 0;
+    const size_t end = selected ? highlight_end : 0;
+    if (begin != selection_begin_ || end != selection_end_) {
+        selection_begin_ = begin;
+        selection_end_ = end;
+        selection_changed_ = true;
+    }
+    if (unavailable_) {
+        ImGui::TextDisabled("Memory too large for statistics");
+    } else if (!selected) {
+        ImGui::TextDisabled("Select bytes for their min, max and sum");
+    } else if (selection_changed_ || running_ || begin != shown_selection_begin_ || std::min(end, shown_size_) != shown_selection_end_) {
+        const size_t total = std::max<size_t>(1, job_blocks_);
+        ImGui::TextDisabled("%.0f%%", 100.0 * std::min(done_blocks_.load(), total) / total);
+    } else {
+        auto const& a = shown_selection_;
+        ImGui::Text("Min %02X  Max %02X  Sum %llu  Mean %.2f  Bits set %llu (%.1f%%)", a.min, a.max,
+            static_cast<unsigned long long>(a.sum), a.size > 0 ? static_cast<double>(a.sum) / a.size : 0.0,
+            static_cast<unsigned long long>(a.popcount), a.size > 0 ? 100.0 * a.popcount / (8.0 * a.size) : 0.0);
+    }
+}
+
+size_t MemoryMinimap::block_size_for(size_t size)
+{
+    size_t block_size = min_block_size;
+    while (block_size * target_blocks < size) {
+        block_size *= 2;
+    }
+    return block_size;
+}
+
+void MemoryMinimap::start(const uint8_t *bytes, size_t size)
+{
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    job_begin_ = std::min(selection_begin_, size);
+    job_end_ = std::min(std::max(selection_end_, job_begin_), size);
+    job_blocks_ = (size + block_size_for(size) - 1) / block_size_for(size);
+    selection_changed_ = false;
+    done_blocks_ = 0;
+    running_ = true;
+    thread_ = std::thread([this, bytes, size]() { work(bytes, size); });
+}
+
+// A pass hashes every block with summarize_sector, which runs at memory speed, and counts the
+// bytes of the blocks whose hash changed. The selection joins the blocks it covers whole.
+void MemoryMinimap::work(const uint8_t *bytes, size_t size)
+{
+    const size_t block_size = block_size_for(size);
+    const size_t count = (size + block_size - 1) / block_size;
+    const bool fresh = block_size != block_size_ || size != size_ || blocks_.size() != count;
+    if (fresh) {
+        blocks_.assign(count, BlockStats{});
+        block_size_ = block_size;
+        size_ = size;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (stop_) {
+            running_ = false;
+            return;
+        }
+        const uint8_t *data = bytes + i * block_size;
+        const size_t n = std::min(block_size, size - i * block_size);
+        const uint64_t hash = summarize_sector(data, n, 0).hash;
+        if (fresh || hash != blocks_[i].hash) {
+            blocks_[i] = block_stats(data, n);
+            blocks_[i].hash = hash;
+        }
+        done_blocks_++;
+    }
+
+    ByteAggregate whole{0xFF, 0, 0, 0, 0};
+    for (size_t i = job_begin_; i < job_end_;) {
+        const size_t block = i / block_size;
+        const size_t block_begin = block * block_size;
+        const size_t block_end = std::min(block_begin + block_size, size);
+        const size_t piece_end = std::min(job_end_, block_end);
+        const ByteAggregate part = i == block_begin && piece_end == block_end ? blocks_[block].aggregate : aggregate_bytes(bytes + i, piece_end - i);
+        whole = aggregate_join(whole, part);
+        i = piece_end;
+    }
+    selection_ = whole;
+    running_ = false;
+}
+
+uint32_t MemoryMinimap::color(size_t begin, size_t end) const
+{
+    double entropy = 0.0;
+    double zeros = 0.0;
+    double ones = 0.0;
+    double printable = 0.0;
+    double total = 0.0;
+    for (size_t i = begin; i < end; i++) {
+        auto const& b = shown_blocks_[i];
+        const double n = static_cast<double>(b.aggregate.size);
+        entropy += b.entropy * n;
+        zeros += b.zeros;
+        ones += b.ones;
+        printable += b.printable;
+        total += n;
+    }
+    if (total <= 0.0) {
+        return ImGui::GetColorU32(ImGuiCol_FrameBg);
+    }
+    switch (mode_) {
+    case Mode::entropy: {
+        // Dark blue for uniform bytes, through teal for code and text, to orange for compressed or random data
+        const float t = static_cast<float>(entropy / total / 8.0);
+        const ImVec4 low{0.06f, 0.09f, 0.25f, 1.0f};
+        const ImVec4 middle{0.0f, 0.65f, 0.65f, 1.0f};
+        const ImVec4 high{1.0f, 0.5f, 0.0f, 1.0f};
+        return t < 0.5f ? lerp_color(low, middle, t * 2.0f) : lerp_color(middle, high, t * 2.0f - 1.0f);
+    }
+    case Mode::fill: {
+        // Zeros black, 0xFF white, other bytes orange, mixed by their share
+        const float z = static_cast<float>(zeros / total);
+        const float f = static_cast<float>(ones / total);
+        const float o = 1.0f - z - f;
+        return ImGui::ColorConvertFloat4ToU32(ImVec4(0.04f * z + 0.92f * f + 0.85f * o, 0.04f * z + 0.92f * f + 0.45f * o,
+                                                     0.04f * z + 0.92f * f + 0.15f * o, 1.0f));
+    }
+    case Mode::text:
+        return lerp_color(ImVec4(0.1f, 0.1f, 0.1f, 1.0f), ImVec4(0.2f, 0.85f, 0.3f, 1.0f), static_cast<float>(printable / total));
+    }
+    return ImGui::GetColorU32(ImGuiCol_FrameBg);
+}
+
+void MemoryMinimap::tooltip(size_t begin, size_t end) const
+{
+    double entropy = 0.0;
+    double zeros = 0.0;
+    double ones = 0.0;
+    double printable = 0.0;
+    double total = 0.0;
+    for (size_t i = begin; i < end; i++) {
+        auto const& b = shown_blocks_[i];
+        entropy += b.entropy * static_cast<double>(b.aggregate.size);
+        zeros += b.zeros;
+        ones += b.ones;
+        printable += b.printable;
+        total += static_cast<double>(b.aggregate.size);
+    }
+    if (total <= 0.0) {
+        return;
+    }
+    ImGui::BeginTooltip();
+    ImGui::Text("%zX-%zX", begin * shown_block_size_, std::min(end * shown_block_size_, shown_size_) - 1);
+    ImGui::Text("Entropy %.2f bits/byte", entropy / total);
+    ImGui::Text("Zeros %.0f%%, FF %.0f%%, text %.0f%%", 100.0 * zeros / total, 100.0 * ones / total, 100.0 * printable / total);
+    ImGui::EndTooltip();
+}
+
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <gui/gui.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace guicpp
+{
+
+struct ByteAggregate
+{
+    uint8_t min;
+    uint8_t max;
+    uint64_t sum;
+    uint64_t popcount; // set bits
+    uint64_t size;
+};
+
+// Aggregates 16 bytes per step, the scalar version gives the same results
+ByteAggregate aggregate_bytes(const uint8_t *data, size_t size);
+ByteAggregate aggregate_join(ByteAggregate const& first, ByteAggregate const& second);
+
+// Byte counts of a block and its entropy, 0 to 8 bits per byte
+struct BlockStats
+{
+    uint64_t hash; // from summarize_sector, only used to notice changes
+    ByteAggregate aggregate;
+    uint32_t zeros;
+    uint32_t ones; // 0xFF bytes
+    uint32_t printable;
+    float entropy;
+};
+
+BlockStats block_stats(const uint8_t *data, size_t size);
+
+// Column beside a memory editor with a cell per block colored by entropy, zero/0xFF fill or the
+// share of printable ASCII, and a footer line with the min, max, sum and set bits of the selection.
+// Passes run on a worker that only counts the blocks whose hash changed again, and join the
+// selection from the blocks it covers and the bytes at its edges.
+class MemoryMinimap
+{
+public:
+    using BytesFn = std::function<const uint8_t*(size_t &size)>;
+
+    enum class Mode { entropy, fill, text };
+
+    MemoryMinimap() = default;
+    ~MemoryMinimap();
+    MemoryMinimap(MemoryMinimap const&) = delete;
+    MemoryMinimap& operator=(MemoryMinimap const&) = delete;
+
+    static float width();
+    static float height();
+
+    void set_interval(double seconds) { interval_ = seconds; }
+
+    // Draws the column in the current window, with the visible rows outlined. Returns true with the
+    // offset of the block clicked or dragged to. bytes is called when a pass starts, and returns null
+    // when the memory cannot be read whole; what it returns must stay valid until the next call.
+    bool draw_map(BytesFn const& bytes, size_t visible_begin, size_t visible_end, size_t &offset);
+    // Mode and the aggregates of the selection, highlight_end is -1 when there is none
+    void draw_line(size_t highlight_begin, size_t highlight_end);
+
+private:
+    // About this many blocks, of a power of two bytes and at least min_block_size
+    static constexpr size_t target_blocks = 16384;
+    static constexpr size_t min_block_size = 4096;
+
+    static size_t block_size_for(size_t size);
+    void start(const uint8_t *bytes, size_t size);
+    void work(const uint8_t *bytes, size_t size);
+    uint32_t color(size_t begin, size_t end) const;
+    void tooltip(size_t begin, size_t end) const;
+
+    double interval_ = 1.0;
+    Mode mode_ = Mode::entropy;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> stop_{false};
+    std::atomic<size_t> done_blocks_{0};
+    double started_ = -1e30;
+    bool unavailable_ = false;
+    // Selection of the pass running and of the next one
+    size_t job_begin_ = 0;
+    size_t job_end_ = 0;
+    size_t job_blocks_ = 0;
+    size_t selection_begin_ = 0;
+    size_t selection_end_ = 0;
+    bool selection_changed_ = false;
+    // Worker side, kept between passes
+    std::vector<BlockStats> blocks_;
+    size_t block_size_ = min_block_size;
+    size_t size_ = 0;
+    ByteAggregate selection_{};
+    // Copies shown until the next pass completes
+    std::vector<BlockStats> shown_blocks_;
+    size_t shown_block_size_ = min_block_size;
+    size_t shown_size_ = 0;
+    ByteAggregate shown_selection_{};
+    size_t shown_selection_begin_ = 0;
+    size_t shown_selection_end_ = 0;
+};
+
+}
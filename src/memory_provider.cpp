@@ -0,0 +1,43 @@
+#include <gui/gui.h>
+#include <cstring>
+#include <thread>
+
+namespace guicpp
+{
+
+void SeqLockMemory::begin_write()
+{
+    seq_.store(seq_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void SeqLockMemory::end_write()
+{
+    seq_.store(seq_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void SeqLockMemory::read(size_t offset, uint8_t *out, size_t size)
+{
+    for (int attempt = 0;; attempt++) {
+        uint64_t before = seq_.load(std::memory_order_acquire);
+        if ((before & 1) == 0) {
+            std::memcpy(out, bytes_ + offset, size);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq_.load(std::memory_order_relaxed) == before) {
+                return;
+            }
+        }
+        if (attempt >= 64) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void SeqLockMemory::write(size_t offset, const uint8_t *in, size_t size)
+{
+    modify([&](uint8_t *bytes) {
+        std::memcpy(bytes + offset, in, size);
+    });
+}
+
+}
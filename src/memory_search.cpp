@@ -0,0 +1,380 @@
+#include "memory_search.h"
+#include "imgui.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GUICPP_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace guicpp
+{
+
+static int hex_digit(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    return c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+}
+
+static bool parse_hex(const char *text, SearchPattern &out)
+{
+    int nibble = 0;
+    uint8_t byte = 0, mask = 0;
+    for (const char *p = text; *p; p++) {
+        if (std::isspace(static_cast<unsigned char>(*p))) {
+            continue;
+        }
+        int digit = hex_digit(*p);
+        if (digit < 0 && *p != '?') {
+            return false;
+        }
+        byte = static_cast<uint8_t>(byte << 4 | (digit < 0 ? 0 : digit));
+        mask = static_cast<uint8_t>(mask << 4 | (digit < 0 ? 0 : 0xF));
+        if (++nibble == 2) {
+            out.bytes.push_back(byte);
+            out.mask.push_back(mask);
+            nibble = 0;
+        }
+    }
+    return nibble == 0;
+}
+
+template <typename T>
+static void put_value(T value, bool big_endian, SearchPattern &out)
+{
+    uint8_t bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    uint16_t probe = 1;
+    bool host_big_endian = *reinterpret_cast<uint8_t*>(&probe) == 0;
+    if (big_endian != host_big_endian) {
+        std::reverse(bytes, bytes + sizeof(T));
+    }
+    out.bytes.assign(bytes, bytes + sizeof(T));
+    out.mask.assign(sizeof(T), 0xFF);
+}
+
+// Integers accept 0x prefixes and negative values, stored as two's complement
+static bool parse_integer(const char *text, long long min, unsigned long long max, unsigned long long &value)
+{
+    char *end;
+    if (std::strchr(text, '-') != nullptr) {
+        long long v = std::strtoll(text, &end, 0);
+        if (*end != 0 || v < min) {
+            return false;
+        }
+        value = static_cast<unsigned long long>(v);
+        return true;
+    }
+    value = std::strtoull(text, &end, 0);
+    return *end == 0 && end != text && value <= max;
+}
+
+bool parse_search_pattern(const char *text, SearchKind kind, bool big_endian, SearchPattern &out)
+{
+    out.bytes.clear();
+    out.mask.clear();
+    unsigned long long value;
+    switch (kind) {
+    case SearchKind::hex:
+        if (!parse_hex(text, out)) {
+            return false;
+        }
+        break;
+    case SearchKind::ascii:
+        out.bytes.assign(text, text + std::strlen(text));
+        out.mask.assign(out.bytes.size(), 0xFF);
+        break;
+    case SearchKind::u16:
+        if (!parse_integer(text, INT16_MIN, UINT16_MAX, value)) {
+            return false;
+        }
+        put_value(static_cast<uint16_t>(value), big_endian, out);
+        break;
+    case SearchKind::u32:
+        if (!parse_integer(text, INT32_MIN, UINT32_MAX, value)) {
+            return false;
+        }
+        put_value(static_cast<uint32_t>(value), big_endian, out);
+        break;
+    case SearchKind::f32: {
+        char *end;
+        float f = std::strtof(text, &end);
+        if (*end != 0 || end == text) {
+            return false;
+        }
+        put_value(f, big_endian, out);
+        break;
+    }
+    }
+    // A pattern of wildcards only would match everywhere
+    return std::any_of(out.mask.begin(), out.mask.end(), [](uint8_t m) { return m != 0; });
+}
+
+static bool matches_at(const uint8_t *p, SearchPattern const& pattern)
+{
+    for (size_t i = 0; i < pattern.bytes.size(); i++) {
+        if ((p[i] & pattern.mask[i]) != pattern.bytes[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void find_pattern(const uint8_t *data, size_t size, size_t begin, size_t end, SearchPattern const& pattern, std::function<void(size_t)> const& f)
+{
+    size_t length = pattern.bytes.size();
+    if (length == 0 || size < length) {
+        return;
+    }
+    end = std::min(end, size - length + 1);
+
+    auto anchor_it = std::find(pattern.mask.begin(), pattern.mask.end(), 0xFF);
+    if (anchor_it == pattern.mask.end()) {
+        for (size_t i = begin; i < end; i++) {
+            if (matches_at(data + i, pattern)) {
+                f(i);
+            }
+        }
+        return;
+    }
+    size_t anchor = static_cast<size_t>(anchor_it - pattern.mask.begin());
+    uint8_t anchor_byte = pattern.bytes[anchor];
+    size_t i = begin;
+#ifdef GUICPP_SSE2
+    const __m128i needle = _mm_set1_epi8(static_cast<char>(anchor_byte));
+    for (; i + 16 <= end; i += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + anchor));
+        unsigned bits = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+        while (bits != 0) {
+            unsigned bit = 0;
+            while ((bits & (1u << bit)) == 0) {
+                bit++;
+            }
+            bits &= bits - 1;
+            if (matches_at(data + i + bit, pattern)) {
+                f(i + bit);
+            }
+        }
+    }
+#endif
+    for (; i < end; i++) {
+        const uint8_t *p = static_cast<const uint8_t*>(std::memchr(data + i + anchor, anchor_byte, end - i));
+        if (p == nullptr) {
+            break;
+        }
+        i = static_cast<size_t>(p - data) - anchor;
+        if (matches_at(data + i, pattern)) {
+            f(i);
+        }
+    }
+}
+
+MemorySearch::~MemorySearch()
+{
+    cancel();
+}
+
+void MemorySearch::cancel()
+{
+    cancel_ = true;
+    for (auto &t : threads_) {
+        t.join();
+    }
+    threads_.clear();
+    cancel_ = false;
+    done_tasks_ = tasks_.size();
+}
+
+void MemorySearch::start(std::vector<Region> regions, SearchPattern pattern)
+{
+    cancel();
+    regions_ = std::move(regions);
+    pattern_ = std::move(pattern);
+    tasks_.clear();
+    for (size_t r = 0; r < regions_.size(); r++) {
+        for (size_t begin = 0; begin < regions_[r].size; begin += task_size) {
+            tasks_.push_back(Task{r, begin, std::min(regions_[r].size, begin + task_size)});
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        matches_.clear();
+        sorted_ = true;
+    }
+    next_task_ = 0;
+    done_tasks_ = 0;
+    if (tasks_.empty()) {
+        return;
+    }
+    size_t workers = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), tasks_.size());
+    for (size_t i = 0; i < workers; i++) {
+        threads_.emplace_back([this]() { work(); });
+    }
+}
+
+void MemorySearch::work()
+{
+    std::vector<Match> found;
+    size_t task;
+    while (!cancel_ && (task = next_task_++) < tasks_.size()) {
+        auto const& t = tasks_[task];
+        auto const& region = regions_[t.region];
+        find_pattern(region.data, region.size, t.begin, t.end, pattern_, [&](size_t offset) {
+            found.push_back(Match{t.region, offset});
+        });
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            size_t room = max_matches - std::min(max_matches, matches_.size());
+            matches_.insert(matches_.end(), found.begin(), found.begin() + std::min(room, found.size()));
+            sorted_ = false;
+            if (done_tasks_ + 1 == tasks_.size()) {
+                std::sort(matches_.begin(), matches_.end());
+                sorted_ = true;
+            }
+            done_tasks_++;
+        }
+        found.clear();
+    }
+}
+
+size_t MemorySearch::match_count() const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    return matches_.size();
+}
+
+size_t MemorySearch::index(Match m) const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    return static_cast<size_t>(std::lower_bound(matches_.begin(), matches_.end(), m) - matches_.begin());
+}
+
+// Matches are unsorted while the search runs, so both fall back to a linear scan then
+bool MemorySearch::next(Match m, Match &out) const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    if (matches_.empty()) {
+        return false;
+    }
+    if (sorted_) {
+        auto it = std::upper_bound(matches_.begin(), matches_.end(), m);
+        out = it != matches_.end() ? *it : matches_.front();
+        return true;
+    }
+    const Match *after = nullptr, *first = &matches_.front();
+    for (auto const& candidate : matches_) {
+        if (m < candidate && (after == nullptr || candidate < *after)) {
+            after = &candidate;
+        }
+        if (candidate < *first) {
+            first = &candidate;
+        }
+    }
+    out = after != nullptr ? *after : *first;
+    return true;
+}
+
+bool MemorySearch::previous(Match m, Match &out) const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    if (matches_.empty()) {
+        return false;
+    }
+    if (sorted_) {
+        auto it = std::lower_bound(matches_.begin(), matches_.end(), m);
+        out = it != matches_.begin() ? *(it - 1) : matches_.back();
+        return true;
+    }
+    const Match *before = nullptr, *last = &matches_.front();
+    for (auto const& candidate : matches_) {
+        if (candidate < m && (before == nullptr || *before < candidate)) {
+            before = &candidate;
+        }
+        if (*last < candidate) {
+            last = &candidate;
+        }
+    }
+    out = before != nullptr ? *before : *last;
+    return true;
+}
+
+float SearchPanel::height()
+{
+    return ImGui::GetStyle().ItemSpacing.y + ImGui::GetFrameHeightWithSpacing();
+}
+
+bool SearchPanel::draw(RegionsFn const& regions, MemorySearch::Match &match, size_t &match_size)
+{
+    static const char *kinds[] = {"Hex", "ASCII", "u16", "u32", "float"};
+    ImGui::SetNextItemWidth(ImGui::CalcTextSize("float").x + ImGui::GetFrameHeight() + ImGui::GetStyle().FramePadding.x * 2.0f);
+    ImGui::Combo("##kind", &kind_, kinds, IM_ARRAYSIZE(kinds));
+    ImGui::SameLine();
+    const SearchKind kind = static_cast<SearchKind>(kind_);
+    if (kind == SearchKind::u16 || kind == SearchKind::u32 || kind == SearchKind::f32) {
+        ImGui::Checkbox("BE", &big_endian_);
+        ImGui::SameLine();
+    }
+    ImGui::SetNextItemWidth(ImGui::CalcTextSize("0").x * 24);
+    bool start = ImGui::InputText("##find", text_, sizeof(text_), ImGuiInputTextFlags_EnterReturnsTrue);
+    ImGui::SameLine();
+    start |= ImGui::Button("Find");
+
+    if (start) {
+        SearchPattern pattern;
+        invalid_ = !parse_search_pattern(text_, kind, big_endian_, pattern);
+        search_.cancel();
+        auto searched = invalid_ ? std::vector<MemorySearch::Region>{} : regions(pattern);
+        unavailable_ = !invalid_ && searched.empty();
+        if (!invalid_ && !unavailable_) {
+            search_.start(std::move(searched), std::move(pattern));
+            jump_to_first_ = true;
+        }
+    }
+
+    bool jump = false;
+    size_t count = search_.match_count();
+    ImGui::SameLine();
+    if (ImGui::ArrowButton("##prev", ImGuiDir_Left)) {
+        jump = search_.previous(current_, current_);
+    }
+    ImGui::SameLine();
+    if (ImGui::ArrowButton("##next", ImGuiDir_Right)) {
+        jump = search_.next(current_, current_);
+    }
+    if (jump_to_first_ && count > 0) {
+        // The lowest match found so far, which may not be the first one until the search completes
+        search_.previous(MemorySearch::Match{0, 0}, current_);
+        search_.next(current_, current_);
+        jump_to_first_ = false;
+        jump = true;
+    }
+
+    ImGui::SameLine();
+    if (invalid_) {
+        ImGui::TextDisabled("Invalid pattern");
+    } else if (unavailable_) {
+        ImGui::TextDisabled("Cannot search this memory");
+    } else if (search_.running()) {
+        ImGui::Text("%zu matches, %.0f%%", count, search_.progress() * 100.0f);
+    } else if (count > 0) {
+        const char *more = count >= MemorySearch::max_matches ? "+" : "";
+        ImGui::Text("%zu of %zu%s matches", search_.index(current_) + 1, count, more);
+    } else if (search_.pattern_size() > 0) {
+        ImGui::TextDisabled("No matches");
+    }
+
+    if (jump) {
+        match = current_;
+        match_size = search_.pattern_size();
+        return true;
+    }
+    return false;
+}
+
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace guicpp
+{
+
+enum class SearchKind
+{
+    hex,
+    ascii,
+    u16,
+    u32,
+    f32,
+};
+
+struct SearchPattern
+{
+    std::vector<uint8_t> bytes;
+    std::vector<uint8_t> mask; // bits that have to match, 0x00 for a wildcard byte
+};
+
+// Parses "DE AD ?? E?" (wildcard bytes and nibbles), plain text, or a number stored in the given byte order
+bool parse_search_pattern(const char *text, SearchKind kind, bool big_endian, SearchPattern &out);
+
+// Calls f for every offset in [begin, end) where pattern matches data, which is valid up to size.
+// Candidates are found by comparing the first fully specified byte 16 at a time, then verified.
+void find_pattern(const uint8_t *data, size_t size, size_t begin, size_t end, SearchPattern const& pattern, std::function<void(size_t)> const& f);
+
+// Searches a set of memory regions on worker threads. Matches are available while the search
+// runs and are sorted once it completes.
+class MemorySearch
+{
+public:
+    struct Region
+    {
+        const uint8_t *data;
+        size_t size;
+    };
+
+    struct Match
+    {
+        size_t region;
+        size_t offset;
+
+        bool operator<(Match const& rhs) const
+        {
+            return region < rhs.region || (region == rhs.region && offset < rhs.offset);
+        }
+    };
+
+    static constexpr size_t max_matches = 1 << 20;
+
+    MemorySearch() = default;
+    ~MemorySearch();
+    MemorySearch(MemorySearch const&) = delete;
+    MemorySearch& operator=(MemorySearch const&) = delete;
+
+    // The regions must stay valid until the search completes or is cancelled
+    void start(std::vector<Region> regions, SearchPattern pattern);
+    void cancel();
+
+    bool running() const { return done_tasks_ < tasks_.size(); }
+    float progress() const { return tasks_.empty() ? 1.0f : static_cast<float>(done_tasks_) / tasks_.size(); }
+    size_t pattern_size() const { return pattern_.bytes.size(); }
+    size_t match_count() const;
+    // Index of the first match at or after m, only meaningful once the search completed
+    size_t index(Match m) const;
+    // Closest match after or before m, wrapping around. False when there are no matches yet.
+    bool next(Match m, Match &out) const;
+    bool previous(Match m, Match &out) const;
+
+private:
+    // Regions are split so that big ones are searched by all workers
+    static constexpr size_t task_size = 1 << 20;
+
+    struct Task
+    {
+        size_t region;
+        size_t begin;
+        size_t end;
+    };
+
+    void work();
+
+    std::vector<Region> regions_;
+    SearchPattern pattern_;
+    std::vector<Task> tasks_;
+    std::atomic<size_t> next_task_{0};
+    std::atomic<size_t> done_tasks_{0};
+    std::atomic<bool> cancel_{false};
+    std::vector<std::thread> threads_;
+    mutable std::mutex mutex_;
+    std::vector<Match> matches_;
+    bool sorted_ = true;
+};
+
+// Search bar drawn below a memory editor, on one line after a separator drawn by the caller
+class SearchPanel
+{
+public:
+    using RegionsFn = std::function<std::vector<MemorySearch::Region>(SearchPattern const& pattern)>;
+
+    static float height();
+
+    // regions is called with the pattern when a search starts, and returns nothing when the memory
+    // cannot be searched.
+    // Returns true when the user picked a match, stored in match.
+    bool draw(RegionsFn const& regions, MemorySearch::Match &match, size_t &match_size);
+
+private:
+    MemorySearch search_;
+    int kind_ = 0;
+    bool big_endian_ = false;
+    bool unavailable_ = false;
+    bool invalid_ = false;
+    bool jump_to_first_ = false;
+    MemorySearch::Match current_{0, 0};
+    char text_[128] = {};
+};
+
+}
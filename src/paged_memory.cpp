@@ -0,0 +1,174 @@
+#include "paged_memory.h"
+#include <algorithm>
+#include <cstring>
+
+namespace guicpp
+{
+
+PagedMemory::PagedMemory(std::shared_ptr<PageSource> source, size_t cache_pages) :
+    source_{std::move(source)},
+    size_{source_->size()},
+    page_size_{std::max<size_t>(source_->page_size(), 1)},
+    page_count_{(size_ + page_size_ - 1) / page_size_},
+    cache_pages_{std::max<size_t>(cache_pages, 16)},
+    thread_{[this]() { run(); }}
+{}
+
+PagedMemory::~PagedMemory()
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        stop_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+}
+
+const PagedMemory::Page* PagedMemory::cached(size_t index)
+{
+    auto it = pages_.find(index);
+    if (it == pages_.end()) {
+        return nullptr;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return &*it->second;
+}
+
+void PagedMemory::insert(size_t index, std::vector<uint8_t> bytes)
+{
+    if (pages_.count(index) != 0) {
+        return;
+    }
+    if (pages_.size() >= cache_pages_) {
+        pages_.erase(lru_.back().index);
+        lru_.pop_back();
+    }
+    lru_.push_front(Page{index, std::move(bytes)});
+    pages_.emplace(index, lru_.begin());
+}
+
+void PagedMemory::want(size_t index)
+{
+    if (index < page_count_ && index != fetching_ && pages_.count(index) == 0) {
+        queue_.push_back(index);
+    }
+}
+
+// Called once per frame with the visible range. The fetch queue is rebuilt every time,
+// so pages that scrolled out of view before being fetched are simply dropped.
+void PagedMemory::read(size_t offset, uint8_t *out, size_t size)
+{
+    if (size == 0) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock{mutex_};
+    if (offset != last_offset_) {
+        direction_ = offset > last_offset_ ? 1 : -1;
+        last_offset_ = offset;
+    }
+    size_t first = offset / page_size_;
+    size_t last = (offset + size - 1) / page_size_;
+    queue_.clear();
+    missing_.clear();
+    for (size_t index = first; index <= last; index++) {
+        size_t begin = std::max(offset, index * page_size_);
+        size_t end = std::min(offset + size, (index + 1) * page_size_);
+        if (auto page = cached(index)) {
+            std::memcpy(out + (begin - offset), page->bytes.data() + (begin - index * page_size_), end - begin);
+        } else {
+            std::memset(out + (begin - offset), 0, end - begin);
+            missing_.push_back(index);
+            want(index);
+        }
+    }
+
+    size_t ahead = std::min((last - first + 1) * prefetch_factor, cache_pages_ / 2);
+    for (size_t i = 1; i <= ahead; i++) {
+        if (direction_ > 0) {
+            want(last + i);
+        } else if (first >= i) {
+            want(first - i);
+        }
+    }
+    // One page the other way, for small moves back
+    if (direction_ > 0 && first > 0) {
+        want(first - 1);
+    } else if (direction_ < 0) {
+        want(last + 1);
+    }
+    bool notify = !queue_.empty();
+    lock.unlock();
+    if (notify) {
+        cv_.notify_one();
+    }
+}
+
+void PagedMemory::pending(size_t offset, bool *out, size_t size)
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    for (size_t index : missing_) {
+        size_t begin = std::max(offset, index * page_size_);
+        size_t end = std::min(offset + size, (index + 1) * page_size_);
+        if (begin < end) {
+            std::fill(out + (begin - offset), out + (end - offset), true);
+        }
+    }
+}
+
+void PagedMemory::write(size_t offset, const uint8_t *in, size_t size)
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        for (size_t index = offset / page_size_; index * page_size_ < offset + size; index++) {
+            auto it = pages_.find(index);
+            if (it != pages_.end()) {
+                size_t begin = std::max(offset, index * page_size_);
+                size_t end = std::min(offset + size, (index + 1) * page_size_);
+                std::memcpy(it->second->bytes.data() + (begin - index * page_size_), in + (begin - offset), end - begin);
+            }
+            if (index == fetching_) {
+                fetch_stale_ = true;
+            }
+        }
+        stores_.push_back(Store{offset, std::vector<uint8_t>(in, in + size)});
+    }
+    cv_.notify_one();
+}
+
+// Stores go before fetches, so a page fetched after a write always sees it
+void PagedMemory::run()
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+    while (true) {
+        cv_.wait(lock, [this]() { return stop_ || !queue_.empty() || !stores_.empty(); });
+        if (!stores_.empty()) {
+            Store store = std::move(stores_.front());
+            stores_.pop_front();
+            lock.unlock();
+            source_->store(store.offset, store.bytes.data(), store.bytes.size());
+            lock.lock();
+            continue;
+        }
+        if (stop_) {
+            return;
+        }
+        size_t index = queue_.front();
+        queue_.pop_front();
+        if (pages_.count(index) != 0) {
+            continue;
+        }
+        fetching_ = index;
+        fetch_stale_ = false;
+        lock.unlock();
+        std::vector<uint8_t> bytes(page_size_);
+        size_t begin = index * page_size_;
+        bool ok = source_->fetch(begin, bytes.data(), std::min(page_size_, size_ - begin));
+        lock.lock();
+        fetching_ = static_cast<size_t>(-1);
+        if (ok && !fetch_stale_) {
+            insert(index, std::move(bytes));
+        }
+    }
+}
+
+}
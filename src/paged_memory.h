@@ -0,0 +1,71 @@
+#pragma once
+#include <gui/gui.h>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace guicpp
+{
+
+// MemoryProvider over a PageSource. Reads never wait for the source: pages missing from the
+// LRU cache are reported as pending and fetched by a worker thread, the visible ones first,
+// then the ones further in the direction the view is moving.
+class PagedMemory : public MemoryProvider
+{
+public:
+    explicit PagedMemory(std::shared_ptr<PageSource> source, size_t cache_pages = 1024);
+    ~PagedMemory() override;
+    PagedMemory(PagedMemory const&) = delete;
+    PagedMemory& operator=(PagedMemory const&) = delete;
+
+    size_t size() const override { return size_; }
+    void read(size_t offset, uint8_t *out, size_t size) override;
+    void write(size_t offset, const uint8_t *in, size_t size) override;
+    void pending(size_t offset, bool *out, size_t size) override;
+
+private:
+    // Pages requested ahead of the view, per visible page
+    static constexpr size_t prefetch_factor = 4;
+
+    struct Page
+    {
+        size_t index;
+        std::vector<uint8_t> bytes;
+    };
+
+    struct Store
+    {
+        size_t offset;
+        std::vector<uint8_t> bytes;
+    };
+
+    void run();
+    const Page* cached(size_t index);
+    void insert(size_t index, std::vector<uint8_t> bytes);
+    void want(size_t index);
+
+    std::shared_ptr<PageSource> source_;
+    size_t size_;
+    size_t page_size_;
+    size_t page_count_;
+    size_t cache_pages_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+    std::list<Page> lru_;
+    std::unordered_map<size_t, std::list<Page>::iterator> pages_;
+    std::deque<size_t> queue_;
+    std::deque<Store> stores_;
+    size_t fetching_ = static_cast<size_t>(-1);
+    bool fetch_stale_ = false;
+    size_t last_offset_ = 0;
+    int direction_ = 1;
+    std::vector<size_t> missing_;
+    std::thread thread_;
+};
+
+}
@@ -0,0 +1,456 @@
+#include <gui/gui.h>
+#include "file_io.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <thread>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace guicpp
+{
+
+namespace
+{
+
+constexpr uint32_t journal_magic = 0x4A504347; // "GCPJ"
+constexpr uint32_t journal_version = 1;
+
+struct JournalHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t page_size;
+    uint64_t size;
+    uint64_t page_count;
+};
+
+// FNV-1a, only to recognize a journal that was not completely written
+uint64_t checksum(uint64_t h, const void *data, size_t size)
+{
+    const uint8_t *p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+        h = (h ^ p[i]) * 0x100000001B3ull;
+    }
+    return h;
+}
+
+constexpr uint64_t checksum_seed = 0xCBF29CE484222325ull;
+
+// Flushes the C buffers and waits for the data to reach the disk
+bool sync(std::FILE *f)
+{
+    if (std::fflush(f) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+
+}
+
+struct PersistentMemory::impl
+{
+    struct Region
+    {
+        uint8_t *data;
+        size_t size;
+        size_t offset;
+    };
+
+    // Dirty pages copied by save(), in the order of pages
+    struct Batch
+    {
+        std::vector<uint64_t> pages;
+        std::vector<uint8_t> bytes;
+    };
+
+    static constexpr size_t bits = 64;
+
+    impl(const char *path, std::vector<Region> regions, size_t page_size) :
+        path_{path},
+        journal_path_{std::string{path} + ".journal"},
+        regions_{std::move(regions)},
+        page_size_{std::max<size_t>(page_size, 1)}
+    {
+        size_ = regions_.empty() ? 0 : regions_.back().offset + regions_.back().size;
+        page_count_ = (size_ + page_size_ - 1) / page_size_;
+        words_ = (page_count_ + bits - 1) / bits;
+        dirty_ = std::make_unique<std::atomic<uint64_t>[]>(words_);
+        // Nothing is known to be on disk until load() succeeds
+        for (size_t page = 0; page < page_count_; page++) {
+            dirty_[page / bits] |= uint64_t{1} << (page % bits);
+        }
+        thread_ = std::thread([this]() { run(); });
+    }
+
+    ~impl()
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            stop_ = true;
+        }
+        cv_.notify_all();
+        thread_.join();
+    }
+
+    size_t page_bytes(uint64_t page) const
+    {
+        return std::min(page_size_, size_ - static_cast<size_t>(page) * page_size_);
+    }
+
+    // Copies between the regions and a linear buffer, in either direction
+    template <typename F>
+    void for_each_region(size_t offset, size_t size, F&& f)
+    {
+        if (regions_.empty()) {
+            return;
+        }
+        auto it = std::upper_bound(regions_.begin(), regions_.end(), offset, [](size_t o, Region const& r) { return o < r.offset; });
+        for (--it; size > 0 && it != regions_.end(); ++it) {
+            size_t begin = offset - it->offset;
+            size_t count = std::min(size, it->size - begin);
+            f(it->data + begin, count);
+            offset += count;
+            size -= count;
+        }
+    }
+
+    void copy_out(size_t offset, uint8_t *out, size_t size)
+    {
+        for_each_region(offset, size, [&out](uint8_t *data, size_t count) {
+            std::memcpy(out, data, count);
+            out += count;
+        });
+    }
+
+    void copy_in(size_t offset, const uint8_t *in, size_t size)
+    {
+        for_each_region(offset, size, [&in](uint8_t *data, size_t count) {
+            std::memcpy(data, in, count);
+            in += count;
+        });
+    }
+
+    void mark_dirty(size_t offset, size_t size)
+    {
+        if (size == 0 || offset >= size_) {
+            return;
+        }
+        size_t last = (std::min(offset + size, size_) - 1) / page_size_;
+        for (size_t page = offset / page_size_; page <= last; page++) {
+            dirty_[page / bits].fetch_or(uint64_t{1} << (page % bits), std::memory_order_relaxed);
+        }
+    }
+
+    // Bits are cleared before the pages are copied, so a write racing with the copy marks its page again
+    void save()
+    {
+        Batch batch;
+        for (size_t word = 0; word < words_; word++) {
+            if (dirty_[word].load(std::memory_order_relaxed) == 0) {
+                continue;
+            }
+            uint64_t set = dirty_[word].exchange(0, std::memory_order_acquire);
+            while (set != 0) {
+                size_t bit = 0;
+                while ((set & (uint64_t{1} << bit)) == 0) {
+                    bit++;
+                }
+                set &= set - 1;
+                uint64_t page = word * bits + bit;
+                size_t offset = batch.bytes.size();
+                batch.pages.push_back(page);
+                batch.bytes.resize(offset + page_bytes(page));
+                copy_out(static_cast<size_t>(page) * page_size_, batch.bytes.data() + offset, page_bytes(page));
+            }
+        }
+        if (batch.pages.empty()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            batches_.push_back(std::move(batch));
+        }
+        cv_.notify_all();
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        for (;;) {
+            cv_.wait(lock, [this]() { return stop_ || !batches_.empty(); });
+            if (batches_.empty()) {
+                return;
+            }
+            writing_ = true;
+            Batch batch = std::move(batches_.front());
+            batches_.pop_front();
+            lock.unlock();
+            bool ok = commit(batch);
+            if (!ok) {
+                for (uint64_t page : batch.pages) {
+                    mark_dirty(static_cast<size_t>(page) * page_size_, 1);
+                }
+            }
+            lock.lock();
+            failed_ = !ok;
+            writing_ = false;
+            cv_.notify_all();
+        }
+    }
+
+    bool write_journal(Batch const& batch)
+    {
+        std::FILE *f = std::fopen(journal_path_.c_str(), "wb");
+        if (f == nullptr) {
+            return false;
+        }
+        JournalHeader header{journal_magic, journal_version, page_size_, size_, batch.pages.size()};
+        uint64_t sum = checksum(checksum_seed, &header, sizeof(header));
+        bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1;
+        size_t offset = 0;
+        for (uint64_t page : batch.pages) {
+            size_t count = page_bytes(page);
+            sum = checksum(checksum(sum, &page, sizeof(page)), batch.bytes.data() + offset, count);
+            ok = ok && std::fwrite(&page, sizeof(page), 1, f) == 1 && std::fwrite(batch.bytes.data() + offset, 1, count, f) == count;
+            offset += count;
+        }
+        ok = ok && std::fwrite(&sum, sizeof(sum), 1, f) == 1 && sync(f);
+        return std::fclose(f) == 0 && ok;
+    }
+
+    bool write_pages(Batch const& batch)
+    {
+        std::FILE *f = std::fopen(path_.c_str(), "r+b");
+        if (f == nullptr) {
+            f = std::fopen(path_.c_str(), "w+b");
+        }
+        if (f == nullptr) {
+            return false;
+        }
+        bool ok = true;
+        size_t offset = 0;
+        for (uint64_t page : batch.pages) {
+            size_t count = page_bytes(page);
+            ok = ok && file_seek(f, page * page_size_) && std::fwrite(batch.bytes.data() + offset, 1, count, f) == count;
+            offset += count;
+        }
+        // A file left by a memory of another size would never load again
+        ok = ok && (file_size(f) == size_ || file_resize(f, size_)) && sync(f);
+        return std::fclose(f) == 0 && ok;
+    }
+
+    // The journal is complete before the file is touched, and removed once the file is
+    bool commit(Batch const& batch)
+    {
+        if (!write_journal(batch) || !write_pages(batch)) {
+            return false;
+        }
+        std::remove(journal_path_.c_str());
+        return true;
+    }
+
+    // Reads a complete journal written for this memory, false if there is none
+    bool read_journal(Batch &batch)
+    {
+        std::FILE *f = std::fopen(journal_path_.c_str(), "rb");
+        if (f == nullptr) {
+            return false;
+        }
+        JournalHeader header;
+        bool ok = std::fread(&header, sizeof(header), 1, f) == 1 && header.magic == journal_magic &&
+            header.version == journal_version && header.page_size == page_size_ && header.size == size_ &&
+            header.page_count <= page_count_;
+        uint64_t sum = checksum(checksum_seed, &header, sizeof(header));
+        for (uint64_t i = 0; ok && i < header.page_count; i++) {
+            uint64_t page;
+            ok = std::fread(&page, sizeof(page), 1, f) == 1 && page < page_count_;
+            if (!ok) {
+                break;
+            }
+            size_t count = page_bytes(page);
+            size_t offset = batch.bytes.size();
+            batch.pages.push_back(page);
+            batch.bytes.resize(offset + count);
+            ok = std::fread(batch.bytes.data() + offset, 1, count, f) == count;
+            sum = checksum(checksum(sum, &page, sizeof(page)), batch.bytes.data() + offset, count);
+        }
+        uint64_t stored;
+        ok = ok && std::fread(&stored, sizeof(stored), 1, f) == 1 && stored == sum;
+        std::fclose(f);
+        return ok;
+    }
+
+    LoadResult load()
+    {
+        wait();
+        Batch journal;
+        if (read_journal(journal)) {
+            // The last save was interrupted after its journal was complete
+            if (!write_pages(journal)) {
+                return LoadResult::failed;
+            }
+        }
+        std::remove(journal_path_.c_str());
+        std::FILE *f = std::fopen(path_.c_str(), "rb");
+        if (f == nullptr) {
+            return LoadResult::missing;
+        }
+        if (file_size(f) != size_) {
+            std::fclose(f);
+            return LoadResult::wrong_size;
+        }
+        bool ok = file_seek(f, 0);
+        std::vector<uint8_t> page(page_size_);
+        for (uint64_t i = 0; ok && i < page_count_; i++) {
+            size_t count = page_bytes(i);
+            ok = std::fread(page.data(), 1, count, f) == count;
+            if (ok) {
+                copy_in(static_cast<size_t>(i) * page_size_, page.data(), count);
+            }
+        }
+        std::fclose(f);
+        if (!ok) {
+            return LoadResult::failed;
+        }
+        for (size_t word = 0; word < words_; word++) {
+            dirty_[word] = 0;
+        }
+        return LoadResult::loaded;
+    }
+
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        cv_.wait(lock, [this]() { return batches_.empty() && !writing_; });
+    }
+
+    bool saving() const
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        return !batches_.empty() || writing_;
+    }
+
+    bool failed() const
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        return failed_;
+    }
+
+    size_t dirty_pages() const
+    {
+        size_t count = 0;
+        for (size_t word = 0; word < words_; word++) {
+            for (uint64_t set = dirty_[word].load(std::memory_order_relaxed); set != 0; set &= set - 1) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    std::string path_;
+    std::string journal_path_;
+    std::vector<Region> regions_;
+    size_t page_size_;
+    size_t size_;
+    size_t page_count_;
+    size_t words_;
+    std::unique_ptr<std::atomic<uint64_t>[]> dirty_;
+
+private:
+    std::thread thread_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Batch> batches_;
+    bool writing_ = false;
+    bool failed_ = false;
+    bool stop_ = false;
+};
+
+PersistentMemory::PersistentMemory(const char *path, uint8_t *bytes, size_t size, size_t page_size) :
+    pimpl_{std::make_unique<impl>(path, std::vector<impl::Region>{impl::Region{bytes, size, 0}}, page_size)}
+{}
+
+PersistentMemory::PersistentMemory(const char *path, std::vector<std::vector<uint8_t>> &sectors, size_t page_size)
+{
+    std::vector<impl::Region> regions;
+    size_t offset = 0;
+    for (auto &sector : sectors) {
+        regions.push_back(impl::Region{sector.data(), sector.size(), offset});
+        offset += sector.size();
+    }
+    pimpl_ = std::make_unique<impl>(path, std::move(regions), page_size);
+}
+
+PersistentMemory::PersistentMemory(const char *path, SectorStore &store, size_t page_size) :
+    PersistentMemory(path, store.bytes().data(), store.size(), page_size)
+{}
+
+PersistentMemory::~PersistentMemory() = default;
+
+LoadResult PersistentMemory::load()
+{
+    return pimpl_->load();
+}
+
+void PersistentMemory::mark_dirty(size_t offset, size_t size)
+{
+    pimpl_->mark_dirty(offset, size);
+}
+
+void PersistentMemory::mark_dirty(size_t region, size_t offset, size_t size)
+{
+    auto const& regions = pimpl_->regions_;
+    if (region >= regions.size() || offset >= regions[region].size) {
+        return;
+    }
+    pimpl_->mark_dirty(regions[region].offset + offset, std::min(size, regions[region].size - offset));
+}
+
+void PersistentMemory::save()
+{
+    pimpl_->save();
+}
+
+void PersistentMemory::wait()
+{
+    pimpl_->wait();
+}
+
+bool PersistentMemory::saving() const
+{
+    return pimpl_->saving();
+}
+
+bool PersistentMemory::failed() const
+{
+    return pimpl_->failed();
+}
+
+size_t PersistentMemory::dirty_pages() const
+{
+    return pimpl_->dirty_pages();
+}
+
+size_t PersistentMemory::size() const
+{
+    return pimpl_->size_;
+}
+
+size_t PersistentMemory::page_size() const
+{
+    return pimpl_->page_size_;
+}
+
+}
@@ -0,0 +1,465 @@
+#include <gui/gui.h>
+#include "mapped_file.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace guicpp
+{
+
+namespace
+{
+
+enum class Source : uint8_t { file, added };
+
+struct Piece
+{
+    Source source;
+    uint64_t start;
+    uint64_t length;
+};
+
+bool follows(Piece const& a, Piece const& b)
+{
+    return a.source == b.source && a.start + a.length == b.start;
+}
+
+// Appends a piece, extending the last one when b continues it
+void append(std::vector<Piece> &pieces, Piece const& piece)
+{
+    if (!pieces.empty() && follows(pieces.back(), piece)) {
+        pieces.back().length += piece.length;
+    } else {
+        pieces.push_back(piece);
+    }
+}
+
+// Flushes the C buffers and waits for the data to reach the disk
+bool sync(std::FILE *f)
+{
+    if (std::fflush(f) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+
+bool replace_file(const char *from, const char *to)
+{
+#ifdef _WIN32
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return std::rename(from, to) == 0;
+#endif
+}
+
+}
+
+// The pieces are the nodes of a treap ordered by offset, each node knowing the length of its subtree.
+// Splitting at an offset cuts at most one piece in two, so an edit is two splits and two merges.
+struct PieceTable::impl
+{
+    static constexpr int none = -1;
+
+    struct Node
+    {
+        Piece piece;
+        uint64_t total;
+        uint32_t priority;
+        int left;
+        int right;
+    };
+
+    // An edit replaced the removed pieces at offset with inserted. Undo and redo swap them.
+    struct Edit
+    {
+        uint64_t offset;
+        std::vector<Piece> removed;
+        Piece inserted;
+        // Single byte overwrites, merged with the next one at the following offset
+        bool typing;
+    };
+
+    std::string path;
+    MappedFile file;
+    std::vector<uint8_t> added;
+    std::vector<Node> nodes;
+    std::vector<int> free_nodes;
+    int root = none;
+    size_t pieces = 0;
+    uint32_t seed = 0x9E3779B9u;
+    std::vector<Edit> undo;
+    std::vector<Edit> redo;
+    // Undo depth of the contents on disk, or -1 once they cannot be reached again
+    size_t saved_depth = 0;
+
+    void reset()
+    {
+        added.clear();
+        nodes.clear();
+        free_nodes.clear();
+        undo.clear();
+        redo.clear();
+        pieces = 0;
+        saved_depth = 0;
+        root = file.size() > 0 ? make(Piece{Source::file, 0, file.size()}) : none;
+    }
+
+    uint32_t random()
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed;
+    }
+
+    int make(Piece const& piece)
+    {
+        int n;
+        if (!free_nodes.empty()) {
+            n = free_nodes.back();
+            free_nodes.pop_back();
+        } else {
+            n = static_cast<int>(nodes.size());
+            nodes.emplace_back();
+        }
+        nodes[n] = Node{piece, piece.length, random(), none, none};
+        pieces++;
+        return n;
+    }
+
+    void release(int n)
+    {
+        free_nodes.push_back(n);
+        pieces--;
+    }
+
+    uint64_t total(int n) const
+    {
+        return n == none ? 0 : nodes[n].total;
+    }
+
+    void update(int n)
+    {
+        nodes[n].total = total(nodes[n].left) + nodes[n].piece.length + total(nodes[n].right);
+    }
+
+    // l gets the first offset bytes of t, r the rest
+    void split(int t, uint64_t offset, int &l, int &r)
+    {
+        if (t == none) {
+            l = r = none;
+            return;
+        }
+        Node &node = nodes[t];
+        const uint64_t left = total(node.left);
+        const uint64_t length = node.piece.length;
+        if (offset <= left) {
+            int rl;
+            split(node.left, offset, l, rl);
+            nodes[t].left = rl;
+            update(t);
+            r = t;
+        } else if (offset >= left + length) {
+            int lr;
+            split(node.right, offset - left - length, lr, r);
+            nodes[t].right = lr;
+            update(t);
+            l = t;
+        } else {
+            // The tail takes the priority of the node, which is at least that of the right subtree
+            const uint64_t cut = offset - left;
+            Piece piece = node.piece;
+            int tail = make(Piece{piece.source, piece.start + cut, length - cut});
+            nodes[tail].priority = nodes[t].priority;
+            nodes[tail].right = nodes[t].right;
+            update(tail);
+            nodes[t].piece.length = cut;
+            nodes[t].right = none;
+            update(t);
+            l = t;
+            r = tail;
+        }
+    }
+
+    int merge(int a, int b)
+    {
+        if (a == none) {
+            return b;
+        }
+        if (b == none) {
+            return a;
+        }
+        if (nodes[a].priority >= nodes[b].priority) {
+            nodes[a].right = merge(nodes[a].right, b);
+            update(a);
+            return a;
+        }
+        nodes[b].left = merge(a, nodes[b].left);
+        update(b);
+        return b;
+    }
+
+    // Grows the last piece of t when piece continues it, so that typing does not add a piece per byte
+    bool extend_last(int t, Piece const& piece)
+    {
+        if (t == none) {
+            return false;
+        }
+        if (nodes[t].right != none) {
+            if (!extend_last(nodes[t].right, piece)) {
+                return false;
+            }
+        } else if (follows(nodes[t].piece, piece)) {
+            nodes[t].piece.length += piece.length;
+        } else {
+            return false;
+        }
+        update(t);
+        return true;
+    }
+
+    void collect(int t, std::vector<Piece> &out)
+    {
+        if (t == none) {
+            return;
+        }
+        collect(nodes[t].left, out);
+        append(out, nodes[t].piece);
+        collect(nodes[t].right, out);
+        release(t);
+    }
+
+    // Replaces length bytes at offset with the pieces, returning the pieces that were there
+    std::vector<Piece> replace(uint64_t offset, uint64_t length, Piece const *in, size_t count)
+    {
+        int l, middle, r;
+        split(root, offset, l, r);
+        split(r, length, middle, r);
+        std::vector<Piece> removed;
+        collect(middle, removed);
+        for (size_t i = 0; i < count; i++) {
+            if (in[i].length > 0 && !extend_last(l, in[i])) {
+                l = merge(l, make(in[i]));
+            }
+        }
+        root = merge(l, r);
+        return removed;
+    }
+
+    void edit(uint64_t offset, uint64_t length, const uint8_t *in, size_t size, bool typing)
+    {
+        const uint64_t end = total(root);
+        offset = std::min(offset, end);
+        length = std::min(length, end - offset);
+        if (length == 0 && size == 0) {
+            return;
+        }
+        Piece inserted{Source::added, added.size(), size};
+        added.insert(added.end(), in, in + size);
+        std::vector<Piece> removed = replace(offset, length, &inserted, 1);
+        redo.clear();
+        if (saved_depth > undo.size()) {
+            saved_depth = static_cast<size_t>(-1);
+        }
+        if (typing && !undo.empty()) {
+            Edit &last = undo.back();
+            if (last.typing && offset == last.offset + last.inserted.length && follows(last.inserted, inserted)) {
+                last.inserted.length += inserted.length;
+                for (auto const& piece : removed) {
+                    append(last.removed, piece);
+                }
+                if (saved_depth == undo.size()) {
+                    saved_depth = static_cast<size_t>(-1);
+                }
+                return;
+            }
+        }
+        undo.push_back(Edit{offset, std::move(removed), inserted, typing});
+    }
+
+    const uint8_t* bytes(Piece const& piece) const
+    {
+        return (piece.source == Source::file ? file.data() : added.data()) + piece.start;
+    }
+
+    // Copies [begin, end) of the subtree starting at base
+    void read(int t, uint64_t base, uint64_t begin, uint64_t end, uint8_t *out) const
+    {
+        if (t == none || begin >= end) {
+            return;
+        }
+        Node const& node = nodes[t];
+        const uint64_t start = base + total(node.left);
+        const uint64_t stop = start + node.piece.length;
+        if (begin < start) {
+            read(node.left, base, begin, std::min(end, start), out);
+        }
+        if (begin < stop && end > start) {
+            const uint64_t from = std::max(begin, start);
+            const uint64_t to = std::min(end, stop);
+            std::memcpy(out + (from - begin), bytes(node.piece) + (from - start), static_cast<size_t>(to - from));
+        }
+        if (end > stop) {
+            const uint64_t from = std::max(begin, stop);
+            read(node.right, stop, from, end, out + (from - begin));
+        }
+    }
+
+    bool write_pieces(int t, std::FILE *f) const
+    {
+        if (t == none) {
+            return true;
+        }
+        Node const& node = nodes[t];
+        return write_pieces(node.left, f) &&
+            std::fwrite(bytes(node.piece), 1, static_cast<size_t>(node.piece.length), f) == node.piece.length &&
+            write_pieces(node.right, f);
+    }
+
+    bool write_file(const char *to) const
+    {
+        std::FILE *f = std::fopen(to, "wb");
+        if (f == nullptr) {
+            return false;
+        }
+        bool ok = write_pieces(root, f) && sync(f);
+        ok = std::fclose(f) == 0 && ok;
+        if (!ok) {
+            std::remove(to);
+        }
+        return ok;
+    }
+};
+
+PieceTable::PieceTable(const char *path) :
+    pimpl_{std::make_unique<impl>()}
+{
+    pimpl_->path = path;
+    if (!pimpl_->file.open(path)) {
+        throw -1;
+    }
+    pimpl_->reset();
+}
+
+PieceTable::~PieceTable() = default;
+
+size_t PieceTable::size() const
+{
+    return static_cast<size_t>(pimpl_->total(pimpl_->root));
+}
+
+void PieceTable::read(size_t offset, uint8_t *out, size_t size)
+{
+    pimpl_->read(pimpl_->root, 0, offset, offset + size, out);
+}
+
+void PieceTable::write(size_t offset, const uint8_t *in, size_t size)
+{
+    pimpl_->edit(offset, size, in, size, size == 1);
+}
+
+void PieceTable::insert(size_t offset, const uint8_t *in, size_t size)
+{
+    pimpl_->edit(offset, 0, in, size, false);
+}
+
+void PieceTable::erase(size_t offset, size_t size)
+{
+    pimpl_->edit(offset, size, nullptr, 0, false);
+}
+
+bool PieceTable::undo()
+{
+    auto &p = *pimpl_;
+    if (p.undo.empty()) {
+        return false;
+    }
+    impl::Edit e = std::move(p.undo.back());
+    p.undo.pop_back();
+    p.replace(e.offset, e.inserted.length, e.removed.data(), e.removed.size());
+    p.redo.push_back(std::move(e));
+    return true;
+}
+
+bool PieceTable::redo()
+{
+    auto &p = *pimpl_;
+    if (p.redo.empty()) {
+        return false;
+    }
+    impl::Edit e = std::move(p.redo.back());
+    p.redo.pop_back();
+    uint64_t length = 0;
+    for (auto const& piece : e.removed) {
+        length += piece.length;
+    }
+    p.replace(e.offset, length, &e.inserted, 1);
+    p.undo.push_back(std::move(e));
+    return true;
+}
+
+bool PieceTable::can_undo() const
+{
+    return !pimpl_->undo.empty();
+}
+
+bool PieceTable::can_redo() const
+{
+    return !pimpl_->redo.empty();
+}
+
+bool PieceTable::modified() const
+{
+    return pimpl_->undo.size() != pimpl_->saved_depth;
+}
+
+size_t PieceTable::piece_count() const
+{
+    return pimpl_->pieces;
+}
+
+const char* PieceTable::path() const
+{
+    return pimpl_->path.c_str();
+}
+
+// The mapping is closed before the rename, which Windows refuses for mapped files
+bool PieceTable::save()
+{
+    auto &p = *pimpl_;
+    std::string temp = p.path + ".tmp";
+    if (!p.write_file(temp.c_str())) {
+        return false;
+    }
+    p.file.close();
+    bool ok = replace_file(temp.c_str(), p.path.c_str());
+    if (!ok) {
+        std::remove(temp.c_str());
+    }
+    if (!p.file.open(p.path.c_str())) {
+        throw -1;
+    }
+    if (ok) {
+        p.reset();
+    }
+    return ok;
+}
+
+bool PieceTable::save(const char *path) const
+{
+    return pimpl_->write_file(path);
+}
+
+}
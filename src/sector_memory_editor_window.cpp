@@ -0,0 +1,891 @@
+#include <gui/gui.h>
+#include "imgui.h"
+#include "imgui_memory_editor.h"
+#include "change_tracker.h"
+#include "checksum.h"
+#include "hex_file.h"
+#include "memory_search.h"
+#include "sector_overview.h"
+#include "symbol_table.h"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+
+namespace guicpp
+{
+
+struct SectorMemoryEditorWindow::impl
+{
+    // Shared with copies, the window drawn is usually a copy of the one marked
+    struct Marks
+    {
+        std::mutex mutex;
+        std::vector<size_t> sectors;
+        bool used = false;
+    };
+
+    const char *text_;
+    std::vector<std::vector<uint8_t>> *sectors_ = nullptr;
+    SectorStore *store_ = nullptr;
+    SparseSectorStore *sparse_ = nullptr;
+    int &current_sector_;
+    Size size_;
+    Position position_;
+    MemoryEditor memory_editor;
+    bool linear_ = false;
+    std::shared_ptr<Marks> marks_ = std::make_shared<Marks>();
+
+    impl(const char* text, std::vector<std::vector<uint8_t>> &sectors, int &current_sector, Size size = {}, Position position = {}) :
+        text_{text},
+        sectors_{&sectors},
+        current_sector_{current_sector},
+        size_{size},
+        position_{position}
+    {}
+
+    impl(const char* text, SectorStore &store, int &current_sector, Size size = {}, Position position = {}) :
+        text_{text},
+        store_{&store},
+        current_sector_{current_sector},
+        size_{size},
+        position_{position}
+    {}
+
+    // Sparse stores are not addressable memory, the editor reads and writes them through its range handlers
+    impl(const char* text, SparseSectorStore &store, int &current_sector, Size size = {}, Position position = {}) :
+        text_{text},
+        sparse_{&store},
+        current_sector_{current_sector},
+        size_{size},
+        position_{position}
+    {
+        memory_editor.ReadRangeFn = [](void *user_data, size_t off, ImU8 *out, size_t size) {
+            auto self = static_cast<impl*>(user_data);
+            self->sparse_->read(self->view_base() + off, out, size);
+        };
+        memory_editor.WriteRangeFn = [](void *user_data, size_t off, const ImU8 *in, size_t size) {
+            auto self = static_cast<impl*>(user_data);
+            self->sparse_->write(self->view_base() + off, in, size);
+        };
+        memory_editor.UserData = this;
+    }
+
+    size_t sector_count() const
+    {
+        if (store_ != nullptr) {
+            return store_->sector_count();
+        }
+        return sparse_ != nullptr ? sparse_->sector_count() : sectors_->size();
+    }
+
+    // Stores have equally sized sectors and can be shown as one linear device
+    bool is_device() const
+    {
+        return store_ != nullptr || sparse_ != nullptr;
+    }
+
+    size_t device_sector_size() const
+    {
+        return store_ != nullptr ? store_->sector_size() : sparse_->sector_size();
+    }
+
+    size_t view_base() const
+    {
+        return linear() ? 0 : current_sector_ * device_sector_size();
+    }
+
+    Span<uint8_t> sector(size_t index)
+    {
+        if (store_ != nullptr) {
+            return store_->sector(index);
+        }
+        auto &bytes = (*sectors_)[index];
+        return Span<uint8_t>{bytes.data(), bytes.size()};
+    }
+
+    bool linear() const
+    {
+        return is_device() && linear_;
+    }
+
+    void draw() {
+        track();
+        draw_overview();
+        const bool valid_sector = current_sector_ >= 0 && static_cast<size_t>(current_sector_) < sector_count();
+        if (!linear() && !valid_sector) {
+            return;
+        }
+        ImGui::SetNextWindowSize(ImVec2(size_.width, size_.height), ImGuiCond_FirstUseEver);
+        ImGui::SetNextWindowPos(ImVec2(position_.x, position_.y), ImGuiCond_FirstUseEver);
+        memory_editor.OptFooterExtraHeight = SearchPanel::height() + (checksums_ ? ChecksumPanel::height() : 0.0f) +
+            (hex_files_ ? HexFilePanel::height() : 0.0f);
+        memory_editor.DrawFooterFn = [](void *user_data) {
+            static_cast<impl*>(user_data)->draw_footer();
+        };
+        memory_editor.OnWriteFn = [](void *user_data, size_t off, size_t size) {
+            static_cast<impl*>(user_data)->on_write(off, size);
+        };
+        memory_editor.UserData = this;
+        if (linear()) {
+            // The sector picked by the application is followed, scrolling does not change it
+            if (valid_sector && current_sector_ != linear_sector_) {
+                memory_editor.GotoAddr = current_sector_ * device_sector_size();
+            }
+            linear_sector_ = current_sector_;
+        }
+        const size_t base = static_cast<size_t>(view_address(0));
+        if (sparse_ != nullptr) {
+            memory_editor.DrawWindow(text_, nullptr, linear() ? sparse_->size() : sparse_->sector_size(), base);
+        } else if (linear()) {
+            memory_editor.DrawWindow(text_, store_->bytes().data(), store_->size(), base);
+        } else {
+            auto bytes = sector(current_sector_);
+            memory_editor.DrawWindow(text_, bytes.data(), bytes.size(), base);
+        }
+    }
+
+    // Address of an offset in the editor, stores are addressed as a whole and vectors by sector
+    uint64_t view_address(size_t off) const
+    {
+        if (!labels_.enabled()) {
+            return off;
+        }
+        return labels_.base() + (is_device() ? view_base() : 0) + off;
+    }
+
+    void symbols(SymbolTable const& table, uint64_t base)
+    {
+        labels_ = SymbolLabels{&table, base};
+        memory_editor.LineLabelFn = [](void *user_data, size_t off, size_t size, bool *dim) {
+            auto self = static_cast<impl*>(user_data);
+            return self->labels_.label(self->view_address(off), size, *dim);
+        };
+        memory_editor.GotoNameFn = [](void *user_data, const char *name, size_t *off) {
+            auto self = static_cast<impl*>(user_data);
+            uint64_t address;
+            if (!self->labels_.resolve(name, address) || address < self->labels_.base()) {
+                return false;
+            }
+            return self->goto_offset(address - self->labels_.base(), *off);
+        };
+        memory_editor.UserData = this;
+    }
+
+    // Offset from the base to an offset in the view, switching to its sector when sectors are shown one at a time
+    bool goto_offset(uint64_t offset, size_t &off)
+    {
+        if (!is_device()) {
+            const bool valid_sector = current_sector_ >= 0 && static_cast<size_t>(current_sector_) < sector_count();
+            if (!valid_sector || offset >= (*sectors_)[current_sector_].size()) {
+                return false;
+            }
+            off = static_cast<size_t>(offset);
+            return true;
+        }
+        const size_t device_size = device_sector_size() * sector_count();
+        if (offset >= device_size) {
+            return false;
+        }
+        if (linear()) {
+            off = static_cast<size_t>(offset);
+            return true;
+        }
+        current_sector_ = linear_sector_ = static_cast<int>(offset / device_sector_size());
+        off = static_cast<size_t>(offset % device_sector_size());
+        return true;
+    }
+
+    void draw_footer()
+    {
+        ImGui::Separator();
+        if (is_device()) {
+            if (ImGui::Checkbox("Whole device", &linear_)) {
+                // Keep the top of the view in place
+                size_t sector_size = device_sector_size();
+                size_t addr = memory_editor.VisibleStartAddr;
+                if (linear_) {
+                    memory_editor.GotoAddr = current_sector_ * sector_size + addr;
+                    linear_sector_ = current_sector_;
+                } else {
+                    current_sector_ = static_cast<int>(addr / sector_size);
+                    memory_editor.GotoAddr = addr % sector_size;
+                }
+            }
+            ImGui::SameLine();
+        }
+        draw_search();
+        if (checksums_) {
+            if (sparse_ != nullptr) {
+                checksum_panel_.draw(checksum_reader(), memory_editor.HighlightMin, memory_editor.HighlightMax);
+            } else {
+                checksum_panel_.draw([this](size_t &size) { return checksum_memory(size); }, memory_editor.HighlightMin, memory_editor.HighlightMax);
+            }
+        }
+        if (hex_files_) {
+            draw_hex_files();
+        }
+    }
+
+    // Files hold the whole device of a store, whatever the view, or the sector shown. The selection
+    // is moved to device offsets.
+    void draw_hex_files()
+    {
+        size_t size;
+        size_t highlight_begin = memory_editor.HighlightMin;
+        size_t highlight_end = memory_editor.HighlightMax;
+        if (is_device()) {
+            size = device_sector_size() * sector_count();
+            if (highlight_end != static_cast<size_t>(-1)) {
+                highlight_begin += view_base();
+                highlight_end += view_base();
+            }
+        } else {
+            size = (*sectors_)[current_sector_].size();
+        }
+        auto read = [this](size_t offset, uint8_t *out, size_t count) {
+            if (sparse_ != nullptr) {
+                sparse_->read(offset, out, count);
+            } else {
+                const uint8_t *bytes = store_ != nullptr ? store_->bytes().data() : (*sectors_)[current_sector_].data();
+                std::copy(bytes + offset, bytes + offset + count, out);
+            }
+        };
+        auto write = [this](size_t offset, const uint8_t *in, size_t count) {
+            if (sparse_ != nullptr) {
+                sparse_->write(offset, in, count);
+                return;
+            }
+            uint8_t *bytes = store_ != nullptr ? store_->bytes().data() : (*sectors_)[current_sector_].data();
+            std::copy(in, in + count, bytes + offset);
+            if (persist_ == nullptr) {
+                return;
+            }
+            if (store_ != nullptr) {
+                persist_->mark_dirty(offset, count);
+            } else {
+                persist_->mark_dirty(current_sector_, offset, count);
+            }
+        };
+        hex_panel_.draw(hex_base_, size, read, write, highlight_begin, highlight_end, is_device() ? erased_value() : -1);
+    }
+
+    // The sparse store shown, read block by block. The sectors whose write count moved since the
+    // last frame are marked changed, pages never written are known to be erased.
+    ChecksumPanel::Reader checksum_reader()
+    {
+        ChecksumPanel::Reader reader{0, nullptr, nullptr};
+        const bool valid_sector = current_sector_ >= 0 && static_cast<size_t>(current_sector_) < sector_count();
+        if (!linear() && !valid_sector) {
+            return reader;
+        }
+        const size_t base = view_base();
+        const size_t sector_size = sparse_->sector_size();
+        reader.size = linear() ? sparse_->size() : sector_size;
+        if (base != checksum_base_ || reader.size != checksum_size_ || checksum_counts_.size() != sparse_->sector_count()) {
+            checksum_base_ = base;
+            checksum_size_ = reader.size;
+            checksum_counts_.assign(sparse_->sector_count(), 0);
+            for (size_t i = 0; i < checksum_counts_.size(); i++) {
+                checksum_counts_[i] = sparse_->write_count(i);
+            }
+            checksum_panel_.mark_changed(0, reader.size);
+        }
+        const size_t first = base / sector_size;
+        const size_t last = linear() ? sparse_->sector_count() : first + 1;
+        for (size_t i = first; i < last; i++) {
+            if (sparse_->write_count(i) != checksum_counts_[i]) {
+                checksum_counts_[i] = sparse_->write_count(i);
+                checksum_panel_.mark_changed(i * sector_size - base, (i + 1) * sector_size - base);
+            }
+        }
+        reader.read = [this, base](size_t offset, uint8_t *out, size_t size) {
+            sparse_->read(base + offset, out, size);
+        };
+        reader.filled = [this, base](size_t offset, size_t size, uint8_t &value) {
+            const size_t page_size = sparse_->page_size();
+            for (size_t page = (base + offset) / page_size; page * page_size < base + offset + size; page++) {
+                if (sparse_->is_allocated(page)) {
+                    return false;
+                }
+            }
+            value = sparse_->erased_value();
+            return true;
+        };
+        return reader;
+    }
+
+    // The bytes shown in the editor
+    const uint8_t* checksum_memory(size_t &size)
+    {
+        const bool valid_sector = current_sector_ >= 0 && static_cast<size_t>(current_sector_) < sector_count();
+        if (!linear() && !valid_sector) {
+            return nullptr;
+        }
+        if (linear()) {
+            size = store_->size();
+            return store_->bytes().data();
+        }
+        auto bytes = sector(current_sector_);
+        size = bytes.size();
+        return bytes.data();
+    }
+
+    // Sparse stores are searched as a sequence of regions in store order, each one owning the match
+    // starts in its range and holding pattern size - 1 extra bytes so that matches can run into the
+    // next range. Written pages are copied along with the erased bytes just before them; the rest of
+    // an erased run can only match a pattern made of the erased value, and then every start in it
+    // does, so it is fed in chunks that all point to one shared buffer of erased bytes.
+    std::vector<MemorySearch::Region> sparse_regions(SearchPattern const& pattern)
+    {
+        std::vector<MemorySearch::Region> regions;
+        search_bytes_.clear();
+        search_bases_.clear();
+        const size_t page_size = sparse_->page_size();
+        const size_t size = sparse_->size();
+        const size_t extra = pattern.bytes.empty() ? 0 : pattern.bytes.size() - 1;
+        if (pattern.bytes.empty() || size <= extra) {
+            return regions;
+        }
+        const uint8_t erased = sparse_->erased_value();
+        bool fill = true;
+        for (size_t i = 0; i < pattern.bytes.size(); i++) {
+            fill &= ((erased ^ pattern.bytes[i]) & pattern.mask[i]) == 0;
+        }
+
+        // Match starts [begin, end) of written runs, widened back into the erased bytes before them
+        std::vector<std::pair<size_t, size_t>> runs;
+        for (size_t page = 0; page < sparse_->page_count(); page++) {
+            if (!sparse_->is_allocated(page)) {
+                continue;
+            }
+            size_t begin = page * page_size;
+            size_t end = std::min(begin + page_size, size);
+            if (!runs.empty() && runs.back().second + extra >= begin) {
+                runs.back().second = end;
+            } else {
+                runs.emplace_back(begin > extra ? begin - extra : 0, end);
+            }
+        }
+        size_t copied = 0;
+        for (auto const& run : runs) {
+            copied += std::min(run.second + extra, size) - run.first;
+        }
+        search_bytes_.resize(copied);
+
+        const size_t chunk = 1 << 20;
+        if (fill) {
+            search_erased_.assign(chunk + extra, erased);
+        }
+        auto add_erased = [&](size_t begin, size_t end) {
+            end = std::min(end, size - extra);
+            for (; fill && begin < end; begin += chunk) {
+                size_t starts = std::min(chunk, end - begin);
+                regions.push_back(MemorySearch::Region{search_erased_.data(), starts + extra});
+                search_bases_.push_back(begin);
+            }
+        };
+        size_t offset = 0;
+        size_t starts_end = 0;
+        for (auto const& run : runs) {
+            add_erased(starts_end, run.first);
+            size_t bytes = std::min(run.second + extra, size) - run.first;
+            sparse_->read(run.first, search_bytes_.data() + offset, bytes);
+            regions.push_back(MemorySearch::Region{search_bytes_.data() + offset, bytes});
+            search_bases_.push_back(run.first);
+            offset += bytes;
+            starts_end = run.second;
+        }
+        add_erased(starts_end, size);
+        return regions;
+    }
+
+    // Searches all sectors, a match switches to its sector. Stores are searched as a whole.
+    void draw_search()
+    {
+        MemorySearch::Match match;
+        size_t match_size;
+        auto regions = [this](SearchPattern const& pattern) {
+            std::vector<MemorySearch::Region> regions;
+            if (sparse_ != nullptr) {
+                return sparse_regions(pattern);
+            }
+            if (store_ != nullptr) {
+                regions.push_back(MemorySearch::Region{store_->bytes().data(), store_->size()});
+                return regions;
+            }
+            for (auto const& sector : *sectors_) {
+                regions.push_back(MemorySearch::Region{sector.data(), sector.size()});
+            }
+            return regions;
+        };
+        if (!search_.draw(regions, match, match_size)) {
+            return;
+        }
+        size_t sector = match.region;
+        size_t offset = match.offset;
+        if (is_device()) {
+            if (sparse_ != nullptr) {
+                offset += search_bases_[match.region];
+            }
+            sector = offset / device_sector_size();
+            if (!linear()) {
+                offset %= device_sector_size();
+            }
+        }
+        current_sector_ = linear_sector_ = static_cast<int>(sector);
+        memory_editor.GotoAddrAndHighlight(offset, offset + match_size);
+    }
+
+    // The store is tracked as one buffer, vectors sector by sector. Sparse stores are not tracked,
+    // a shadow copy would make them dense.
+    ChangeTracker& tracker(size_t sector)
+    {
+        size_t index = store_ != nullptr ? 0 : sector;
+        if (trackers_.size() <= index) {
+            trackers_.resize(index + 1);
+            for (auto &t : trackers_) {
+                t.set_decay(heatmap_decay_);
+                t.set_interval(heatmap_interval_);
+            }
+        }
+        return trackers_[index];
+    }
+
+    size_t tracked_offset(size_t sector, size_t offset) const
+    {
+        return store_ != nullptr ? sector * store_->sector_size() + offset : offset;
+    }
+
+    void heatmap(double decay, double interval)
+    {
+        heatmap_decay_ = decay;
+        heatmap_interval_ = interval;
+        for (auto &t : trackers_) {
+            t.set_decay(decay);
+            t.set_interval(interval);
+        }
+        tracking_ = true;
+        memory_editor.HeatRangeFn = [](void *user_data, size_t off, float *out, size_t size) {
+            auto self = static_cast<impl*>(user_data);
+            size_t sector = self->linear() ? 0 : self->current_sector_;
+            size_t offset = self->linear() ? off : self->tracked_offset(sector, off);
+            self->tracker(sector).heat(offset, out, size, ImGui::GetTime());
+        };
+        memory_editor.UserData = this;
+    }
+
+    void watch(int sector, size_t offset, size_t size, MemoryWatchFn f)
+    {
+        tracking_ = true;
+        tracker(sector).add_watch(tracked_offset(sector, offset), size, std::move(f));
+    }
+
+    uint8_t erased_value() const
+    {
+        if (store_ != nullptr) {
+            return store_->erased_value();
+        }
+        return sparse_ != nullptr ? sparse_->erased_value() : 0xFF;
+    }
+
+    // Sectors changed since the last pass: those of a sparse store whose write count moved, else
+    // those marked, or all of them until the application marks one. Sparse sectors with written
+    // pages are copied, the others are known to be erased.
+    std::vector<SectorOverview::Sector> overview_sectors()
+    {
+        const bool first = !overview_started_;
+        overview_started_ = true;
+        std::vector<size_t> changed;
+        std::vector<size_t> marked;
+        bool marking;
+        {
+            std::lock_guard<std::mutex> lock{marks_->mutex};
+            marked.swap(marks_->sectors);
+            marking = marks_->used;
+        }
+        if (sparse_ != nullptr) {
+            overview_counts_.resize(sparse_->sector_count());
+            for (size_t i = 0; i < sparse_->sector_count(); i++) {
+                if (first || sparse_->write_count(i) != overview_counts_[i]) {
+                    overview_counts_[i] = sparse_->write_count(i);
+                    changed.push_back(i);
+                }
+            }
+        } else if (marking && !first) {
+            std::sort(marked.begin(), marked.end());
+            marked.erase(std::unique(marked.begin(), marked.end()), marked.end());
+            for (size_t i : marked) {
+                if (i < sector_count()) {
+                    changed.push_back(i);
+                }
+            }
+        } else {
+            for (size_t i = 0; i < sector_count(); i++) {
+                changed.push_back(i);
+            }
+        }
+
+        std::vector<SectorOverview::Sector> sectors;
+        if (sparse_ == nullptr) {
+            for (size_t i : changed) {
+                auto bytes = sector(i);
+                sectors.push_back(SectorOverview::Sector{i, Span<const uint8_t>{bytes.data(), bytes.size()}});
+            }
+            return sectors;
+        }
+        size_t sector_size = sparse_->sector_size();
+        size_t pages_per_sector = sector_size / sparse_->page_size();
+        std::vector<size_t> written;
+        for (size_t i : changed) {
+            bool allocated = false;
+            for (size_t page = i * pages_per_sector; page < (i + 1) * pages_per_sector && !allocated; page++) {
+                allocated = sparse_->is_allocated(page);
+            }
+            if (allocated) {
+                written.push_back(i);
+            } else {
+                sectors.push_back(SectorOverview::Sector{i, Span<const uint8_t>{nullptr, sector_size}});
+            }
+        }
+        overview_bytes_.resize(written.size() * sector_size);
+        for (size_t i = 0; i < written.size(); i++) {
+            uint8_t *bytes = overview_bytes_.data() + i * sector_size;
+            sparse_->read(written[i] * sector_size, bytes, sector_size);
+            sectors.push_back(SectorOverview::Sector{written[i], Span<const uint8_t>{bytes, sector_size}});
+        }
+        return sectors;
+    }
+
+    // Only marks from the application stop the passes over all sectors
+    void mark_changed(int sector, bool by_application = true)
+    {
+        if (overview_text_ == nullptr) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock{marks_->mutex};
+        marks_->sectors.push_back(static_cast<size_t>(sector));
+        marks_->used |= by_application;
+    }
+
+    // Edits in the window mark their sectors, and the pages dirty when persisting
+    void on_write(size_t off, size_t size)
+    {
+        if (!is_device()) {
+            mark_changed(current_sector_, false);
+        } else if (size > 0) {
+            size_t begin = view_base() + off;
+            for (size_t i = begin / device_sector_size(); i <= (begin + size - 1) / device_sector_size(); i++) {
+                mark_changed(static_cast<int>(i), false);
+            }
+        }
+        if (persist_ == nullptr) {
+            return;
+        }
+        if (store_ != nullptr) {
+            persist_->mark_dirty(view_base() + off, size);
+        } else if (sectors_ != nullptr) {
+            persist_->mark_dirty(current_sector_, off, size);
+        }
+    }
+
+    void overview(const char *text, double interval, Size size, Position position)
+    {
+        overview_text_ = text;
+        overview_interval_ = interval;
+        overview_size_ = size;
+        overview_position_ = position;
+    }
+
+    void draw_overview()
+    {
+        if (overview_text_ == nullptr) {
+            return;
+        }
+        double now = ImGui::GetTime();
+        if (!overview_.running() && now - overview_refreshed_ >= overview_interval_) {
+            auto sectors = overview_sectors();
+            if (!sectors.empty()) {
+                overview_.refresh(sector_count(), std::move(sectors), erased_value());
+            }
+            overview_refreshed_ = now;
+        }
+        overview_.cells(overview_cells_);
+
+        ImGui::SetNextWindowSize(ImVec2(overview_size_.width, overview_size_.height), ImGuiCond_FirstUseEver);
+        ImGui::SetNextWindowPos(ImVec2(overview_position_.x, overview_position_.y), ImGuiCond_FirstUseEver);
+        ImGui::Begin(overview_text_);
+        if (ImGui::Button("Snapshot")) {
+            overview_.snapshot();
+        }
+        size_t erased = 0;
+        size_t changed = 0;
+        for (auto const& cell : overview_cells_) {
+            erased += cell.valid && cell.summary.erased();
+            changed += cell.changed;
+        }
+        ImGui::SameLine();
+        ImGui::Text("%d sectors, %d erased, %d changed", static_cast<int>(overview_cells_.size()), static_cast<int>(erased), static_cast<int>(changed));
+        ImGui::Separator();
+
+        ImGui::BeginChild("cells");
+        const float cell_size = ImGui::GetTextLineHeight();
+        const float spacing = 2.0f;
+        const int columns = std::max(1, static_cast<int>((ImGui::GetContentRegionAvail().x + spacing) / (cell_size + spacing)));
+        const int rows = (static_cast<int>(overview_cells_.size()) + columns - 1) / columns;
+        ImDrawList* draw_list = ImGui::GetWindowDrawList();
+        ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(spacing, spacing));
+        ImGuiListClipper clipper;
+        clipper.Begin(rows, cell_size + spacing);
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+                ImVec2 pos = ImGui::GetCursorScreenPos();
+                ImGui::PushID(row);
+                ImGui::InvisibleButton("##row", ImVec2(columns * (cell_size + spacing), cell_size));
+                ImGui::PopID();
+                int hovered = -1;
+                if (ImGui::IsItemHovered()) {
+                    hovered = row * columns + static_cast<int>((ImGui::GetMousePos().x - pos.x) / (cell_size + spacing));
+                    if (ImGui::IsItemClicked() && hovered < static_cast<int>(overview_cells_.size())) {
+                        current_sector_ = hovered;
+                    }
+                }
+                for (int column = 0; column < columns; column++) {
+                    size_t index = row * columns + column;
+                    if (index >= overview_cells_.size()) {
+                        break;
+                    }
+                    ImVec2 min(pos.x + column * (cell_size + spacing), pos.y);
+                    ImVec2 max(min.x + cell_size, min.y + cell_size);
+                    draw_cell(draw_list, index, min, max);
+                    if (static_cast<int>(index) == hovered) {
+                        draw_cell_tooltip(index);
+                    }
+                }
+            }
+        }
+        clipper.End();
+        ImGui::PopStyleVar();
+        ImGui::EndChild();
+        ImGui::End();
+    }
+
+    // Erased sectors are gray, used ones get brighter with their fill. Changed sectors have an
+    // orange frame and the current sector a white one.
+    void draw_cell(ImDrawList* draw_list, size_t index, ImVec2 min, ImVec2 max)
+    {
+        auto const& cell = overview_cells_[index];
+        if (!cell.valid) {
+            draw_list->AddRect(min, max, IM_COL32(90, 90, 90, 255));
+        } else if (cell.summary.erased()) {
+            draw_list->AddRectFilled(min, max, IM_COL32(60, 60, 60, 255));
+        } else {
+            float fill = static_cast<float>(cell.summary.used) / cell.summary.size;
+            draw_list->AddRectFilled(min, max, IM_COL32(40, 90 + static_cast<int>(165 * fill), 60, 255));
+        }
+        if (cell.changed) {
+            draw_list->AddRect(min, max, IM_COL32(255, 96, 0, 255), 0.0f, 0, 2.0f);
+        }
+        if (static_cast<int>(index) == current_sector_) {
+            draw_list->AddRect(ImVec2(min.x - 1, min.y - 1), ImVec2(max.x + 1, max.y + 1), IM_COL32_WHITE);
+        }
+    }
+
+    void draw_cell_tooltip(size_t index)
+    {
+        auto const& cell = overview_cells_[index];
+        ImGui::BeginTooltip();
+        ImGui::Text("Sector %d", static_cast<int>(index));
+        if (!cell.valid) {
+            ImGui::TextUnformatted("Not summarized yet");
+        } else if (cell.summary.erased()) {
+            ImGui::TextUnformatted("Erased");
+        } else {
+            ImGui::Text("%u of %u bytes used (%.1f%%)", static_cast<unsigned>(cell.summary.used), static_cast<unsigned>(cell.summary.size),
+                100.0 * cell.summary.used / cell.summary.size);
+        }
+        if (cell.valid) {
+            ImGui::Text("Sum %08X", cell.summary.sum);
+        }
+        if (cell.changed) {
+            ImGui::TextUnformatted("Changed since the snapshot");
+        }
+        ImGui::EndTooltip();
+    }
+
+    // Vectors are the regions of the persistent memory, stores are one region.
+    // Sparse stores cannot be persisted.
+    void persist(PersistentMemory &memory)
+    {
+        persist_ = &memory;
+    }
+
+    void checksums()
+    {
+        checksums_ = true;
+    }
+
+    void hex_files(uint64_t base)
+    {
+        hex_files_ = true;
+        hex_base_ = base;
+    }
+
+    void copy_state(impl const& rhs)
+    {
+        linear_ = rhs.linear_;
+        checksums_ = rhs.checksums_;
+        hex_files_ = rhs.hex_files_;
+        hex_base_ = rhs.hex_base_;
+        if (rhs.labels_.enabled()) {
+            symbols(*rhs.labels_.table(), rhs.labels_.base());
+        }
+        if (rhs.persist_ != nullptr) {
+            persist(*rhs.persist_);
+        }
+        overview(rhs.overview_text_, rhs.overview_interval_, rhs.overview_size_, rhs.overview_position_);
+        trackers_ = rhs.trackers_;
+        tracking_ = rhs.tracking_;
+        heatmap_decay_ = rhs.heatmap_decay_;
+        heatmap_interval_ = rhs.heatmap_interval_;
+        if (rhs.memory_editor.HeatRangeFn != nullptr) {
+            heatmap(heatmap_decay_, heatmap_interval_);
+        }
+    }
+
+    void track()
+    {
+        if (!tracking_ || sparse_ != nullptr) {
+            return;
+        }
+        double now = ImGui::GetTime();
+        if (store_ != nullptr) {
+            tracker(0).update(store_->bytes().data(), store_->size(), now);
+            return;
+        }
+        for (size_t i = 0; i < sectors_->size(); i++) {
+            auto bytes = sector(i);
+            tracker(i).update(bytes.data(), bytes.size(), now);
+        }
+    }
+
+private:
+    int linear_sector_ = -1;
+    SymbolLabels labels_;
+    SearchPanel search_;
+    std::vector<uint8_t> search_bytes_;
+    std::vector<uint8_t> search_erased_;
+    std::vector<size_t> search_bases_;
+    PersistentMemory *persist_ = nullptr;
+    bool hex_files_ = false;
+    uint64_t hex_base_ = 0;
+    HexFilePanel hex_panel_;
+    const char *overview_text_ = nullptr;
+    double overview_interval_ = 0.5;
+    double overview_refreshed_ = -1e30;
+    Size overview_size_;
+    Position overview_position_;
+    std::vector<SectorOverview::Cell> overview_cells_;
+    std::vector<uint8_t> overview_bytes_;
+    std::vector<uint32_t> overview_counts_; // write counts of a sparse store at the last pass
+    bool overview_started_ = false;
+    // Declared after the buffer it reads so that its worker stops first
+    SectorOverview overview_;
+    std::vector<ChangeTracker> trackers_;
+    bool tracking_ = false;
+    double heatmap_decay_ = 0.0;
+    double heatmap_interval_ = 0.0;
+    bool checksums_ = false;
+    size_t checksum_base_ = 0;
+    size_t checksum_size_ = 0;
+    std::vector<uint32_t> checksum_counts_; // write counts of a sparse store as last marked
+    ChecksumPanel checksum_panel_;
+};
+
+SectorMemoryEditorWindow::SectorMemoryEditorWindow(const char* text, std::vector<std::vector<uint8_t>> &sectors, int &current_sector, Size size, Position position) :
+    pimpl_{std::make_unique<impl>(text, sectors, current_sector, size, position)}
+{}
+
+SectorMemoryEditorWindow::SectorMemoryEditorWindow(const char* text, SectorStore &store, int &current_sector, Size size, Position position) :
+    pimpl_{std::make_unique<impl>(text, store, current_sector, size, position)}
+{}
+
+SectorMemoryEditorWindow::SectorMemoryEditorWindow(const char* text, SparseSectorStore &store, int &current_sector, Size size, Position position) :
+    pimpl_{std::make_unique<impl>(text, store, current_sector, size, position)}
+{}
+
+SectorMemoryEditorWindow::~SectorMemoryEditorWindow() = default;
+
+SectorMemoryEditorWindow::SectorMemoryEditorWindow(SectorMemoryEditorWindow const& rhs)
+{
+    auto const& r = *rhs.pimpl_;
+    if (r.store_ != nullptr) {
+        pimpl_ = std::make_unique<impl>(r.text_, *r.store_, r.current_sector_, r.size_, r.position_);
+    } else if (r.sparse_ != nullptr) {
+        pimpl_ = std::make_unique<impl>(r.text_, *r.sparse_, r.current_sector_, r.size_, r.position_);
+    } else {
+        pimpl_ = std::make_unique<impl>(r.text_, *r.sectors_, r.current_sector_, r.size_, r.position_);
+    }
+    pimpl_->copy_state(r);
+    pimpl_->marks_ = r.marks_;
+}
+
+void SectorMemoryEditorWindow::draw() const
+{
+    pimpl_->draw();
+}
+
+SectorMemoryEditorWindow& SectorMemoryEditorWindow::heatmap(double decay, double interval)
+{
+    pimpl_->heatmap(decay, interval);
+    return *this;
+}
+
+SectorMemoryEditorWindow& SectorMemoryEditorWindow::watch(int sector, size_t offset, size_t size, MemoryWatchFn f)
+{
+    pimpl_->watch(sector, offset, size, std::move(f));
+    return *this;
+}
+
+SectorMemoryEditorWindow& SectorMemoryEditorWindow::overview(const char *text, double interval, Size size, Position position)
+{
+    pimpl_->overview(text, interval, size, position);
+    return *this;
+}
+
+SectorMemoryEditorWindow& SectorMemoryEditorWindow::mark_changed(int sector)
+{
+    pimpl_->mark_changed(sector);
+    return *this;
+}
+
+SectorMemoryEditorWindow& SectorMemoryEditorWindow::persist(PersistentMemory &memory)
+{
+    pimpl_->persist(memory);
+    return *this;
+}
+
+SectorMemoryEditorWindow& SectorMemoryEditorWindow::symbols(SymbolTable const& table, uint64_t base)
+{
+    pimpl_->symbols(table, base);
+    return *this;
+}
+
+SectorMemoryEditorWindow& SectorMemoryEditorWindow::hex_files(uint64_t base)
+{
+    pimpl_->hex_files(base);
+    return *this;
+}
+
+SectorMemoryEditorWindow& SectorMemoryEditorWindow::checksums()
+{
+    pimpl_->checksums();
+    return *this;
+}
+
+SectorMemoryEditorWindow& SectorMemoryEditorWindow::watch(const char *name, int sector, size_t offset, size_t size, LogChannel channel)
+{
+    pimpl_->watch(sector, offset, size, log_watch(name, std::move(channel)));
+    return *this;
+}
+
+}
@@ -0,0 +1,178 @@
+#include "sector_overview.h"
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GUICPP_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace guicpp
+{
+
+namespace
+{
+
+// a sums the bytes, b sums a after every block and w weights the bytes of a block by their position,
+// so that moved bytes change the hash
+struct Sums
+{
+    uint64_t a = 0;
+    uint64_t b = 0;
+    uint32_t w = 0;
+};
+
+void sum_block(const uint8_t *p, Sums &sums)
+{
+    for (uint32_t i = 0; i < 16; i++) {
+        sums.a += p[i];
+        sums.w += (i + 1) * p[i];
+    }
+    sums.b += sums.a;
+}
+
+uint64_t mix(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+}
+
+SectorSummary summarize_sector(const uint8_t *data, size_t size, uint8_t erased_value)
+{
+    Sums sums;
+    size_t equal = 0;
+    size_t i = 0;
+#ifdef GUICPP_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i erased = _mm_set1_epi8(static_cast<char>(erased_value));
+    const __m128i weights_lo = _mm_setr_epi16(1, 2, 3, 4, 5, 6, 7, 8);
+    const __m128i weights_hi = _mm_setr_epi16(9, 10, 11, 12, 13, 14, 15, 16);
+    __m128i a = zero;
+    __m128i b = zero;
+    __m128i w = zero;
+    __m128i eq = zero;
+    while (i + 16 <= size) {
+        // The byte counters of eq overflow after 255 blocks
+        __m128i eq8 = zero;
+        for (size_t blocks = 0; blocks < 255 && i + 16 <= size; blocks++, i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            a = _mm_add_epi64(a, _mm_sad_epu8(v, zero));
+            b = _mm_add_epi64(b, a);
+            w = _mm_add_epi32(w, _mm_madd_epi16(_mm_unpacklo_epi8(v, zero), weights_lo));
+            w = _mm_add_epi32(w, _mm_madd_epi16(_mm_unpackhi_epi8(v, zero), weights_hi));
+            eq8 = _mm_sub_epi8(eq8, _mm_cmpeq_epi8(v, erased));
+        }
+        eq = _mm_add_epi64(eq, _mm_sad_epu8(eq8, zero));
+    }
+    uint64_t lanes[2];
+    uint32_t w_lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), a);
+    sums.a = lanes[0] + lanes[1];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), b);
+    sums.b = lanes[0] + lanes[1];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(w_lanes), w);
+    sums.w = w_lanes[0] + w_lanes[1] + w_lanes[2] + w_lanes[3];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), eq);
+    equal = lanes[0] + lanes[1];
+#endif
+    for (; i + 16 <= size; i += 16) {
+        sum_block(data + i, sums);
+        for (size_t j = i; j < i + 16; j++) {
+            equal += data[j] == erased_value;
+        }
+    }
+    if (i < size) {
+        uint8_t tail[16] = {};
+        std::memcpy(tail, data + i, size - i);
+        sum_block(tail, sums);
+        for (size_t j = i; j < size; j++) {
+            equal += data[j] == erased_value;
+        }
+    }
+    SectorSummary summary;
+    summary.sum = static_cast<uint32_t>(sums.a);
+    summary.hash = mix(sums.a ^ mix(sums.b ^ (static_cast<uint64_t>(sums.w) << 32) ^ size));
+    summary.used = size - equal;
+    summary.size = size;
+    return summary;
+}
+
+SectorOverview::~SectorOverview()
+{
+    stop_ = true;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+bool SectorOverview::refresh(size_t count, std::vector<Sector> sectors, uint8_t erased_value)
+{
+    if (running_) {
+        return false;
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    sectors_ = std::move(sectors);
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        cells_.resize(count, Cell{});
+    }
+    running_ = true;
+    thread_ = std::thread([this, erased_value]() { work(erased_value); });
+    return true;
+}
+
+void SectorOverview::work(uint8_t erased_value)
+{
+    // All erased sectors have the same summary, computed once per pass
+    std::vector<uint8_t> erased;
+    SectorSummary erased_summary{};
+    bool have_erased_summary = false;
+    for (size_t i = 0; i < sectors_.size() && !stop_; i++) {
+        auto sector = sectors_[i].bytes;
+        SectorSummary summary;
+        if (sector.data() != nullptr) {
+            summary = summarize_sector(sector.data(), sector.size(), erased_value);
+        } else {
+            if (!have_erased_summary || erased.size() != sector.size()) {
+                erased.assign(sector.size(), erased_value);
+                erased_summary = summarize_sector(erased.data(), erased.size(), erased_value);
+                have_erased_summary = true;
+            }
+            summary = erased_summary;
+        }
+        std::lock_guard<std::mutex> lock{mutex_};
+        cells_[sectors_[i].index].summary = summary;
+        cells_[sectors_[i].index].valid = true;
+    }
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        if (snapshot_.empty() && !stop_) {
+            snapshot_ = cells_;
+        }
+    }
+    running_ = false;
+}
+
+void SectorOverview::snapshot()
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    snapshot_ = cells_;
+}
+
+void SectorOverview::cells(std::vector<Cell> &out) const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    out = cells_;
+    for (size_t i = 0; i < out.size() && i < snapshot_.size(); i++) {
+        out[i].changed = out[i].valid && snapshot_[i].valid && out[i].summary.hash != snapshot_[i].summary.hash;
+    }
+}
+
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <gui/gui.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace guicpp
+{
+
+struct SectorSummary
+{
+    uint32_t sum;  // additive checksum of all bytes
+    uint64_t hash; // position dependent, only used to notice changes
+    size_t used;   // bytes that differ from the erased value
+    size_t size;
+
+    bool erased() const { return used == 0; }
+};
+
+// Summarizes 16 bytes per step, the scalar version gives the same results
+SectorSummary summarize_sector(const uint8_t *data, size_t size, uint8_t erased_value);
+
+// Summarizes a set of sectors on a worker thread. Results are published sector by sector while a
+// pass runs, and compared against the hashes of the last snapshot. A pass only summarizes the
+// sectors it is given, the other cells keep their summaries.
+class SectorOverview
+{
+public:
+    struct Sector
+    {
+        size_t index;
+        Span<const uint8_t> bytes; // no data when the sector holds only erased bytes
+    };
+
+    struct Cell
+    {
+        SectorSummary summary;
+        bool valid;   // summarized at least once
+        bool changed; // differs from the snapshot
+    };
+
+    SectorOverview() = default;
+    ~SectorOverview();
+    SectorOverview(SectorOverview const&) = delete;
+    SectorOverview& operator=(SectorOverview const&) = delete;
+
+    bool running() const { return running_; }
+    // Starts a pass over the sectors given unless one is running, count is the number of cells.
+    // The sectors must stay valid until the pass completes.
+    bool refresh(size_t count, std::vector<Sector> sectors, uint8_t erased_value);
+    // Takes the current hashes as the reference for changed, done automatically after the first pass
+    void snapshot();
+    // Copies the cells, cheap enough to do every frame
+    void cells(std::vector<Cell> &out) const;
+
+private:
+    void work(uint8_t erased_value);
+
+    std::vector<Sector> sectors_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> stop_{false};
+    mutable std::mutex mutex_;
+    std::vector<Cell> cells_;
+    std::vector<Cell> snapshot_;
+};
+
+}
@@ -0,0 +1,35 @@
+#include <gui/gui.h>
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace guicpp
+{
+
+static constexpr std::align_val_t slab_alignment{64};
+
+SectorStore::SectorStore(size_t sector_count, size_t sector_size, uint8_t erased_value) :
+    data_{static_cast<uint8_t*>(::operator new(std::max<size_t>(sector_count * sector_size, 1), slab_alignment))},
+    sector_count_{sector_count},
+    sector_size_{sector_size},
+    erased_value_{erased_value}
+{
+    erase_all();
+}
+
+SectorStore::~SectorStore()
+{
+    ::operator delete(data_, slab_alignment);
+}
+
+void SectorStore::erase(size_t sector)
+{
+    std::memset(data_ + sector * sector_size_, erased_value_, sector_size_);
+}
+
+void SectorStore::erase_all()
+{
+    std::memset(data_, erased_value_, size());
+}
+
+}
@@ -0,0 +1,203 @@
+#include "snapshot_history.h"
+#include "lz.h"
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GUICPP_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace guicpp
+{
+
+namespace
+{
+
+// Changed runs end at this many unchanged bytes, shorter gaps cost less as part of the run
+constexpr size_t min_gap = 8;
+
+void put_varint(std::vector<uint8_t> &out, size_t value)
+{
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+bool get_varint(const uint8_t *&p, const uint8_t *end, size_t &value)
+{
+    value = 0;
+    for (unsigned shift = 0; p < end && shift < 64; shift += 7) {
+        uint8_t b = *p++;
+        value |= static_cast<size_t>(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// First offset from i on where a and b differ, 16 bytes per step
+size_t next_difference(const uint8_t *a, const uint8_t *b, size_t i, size_t size)
+{
+#ifdef GUICPP_SSE2
+    for (; i + 16 <= size; i += 16) {
+        __m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        int mask = ~_mm_movemask_epi8(eq) & 0xFFFF;
+        if (mask != 0) {
+            while ((mask & 1) == 0) {
+                mask >>= 1;
+                i++;
+            }
+            return i;
+        }
+    }
+#endif
+    while (i < size && a[i] == b[i]) {
+        i++;
+    }
+    return i;
+}
+
+// End of the changed run starting at i
+size_t run_end(const uint8_t *a, const uint8_t *b, size_t i, size_t size)
+{
+    size_t equal = 0;
+    for (; i < size; i++) {
+        if (a[i] != b[i]) {
+            equal = 0;
+        } else if (++equal == min_gap) {
+            return i + 1 - min_gap;
+        }
+    }
+    return size - equal;
+}
+
+}
+
+void encode_delta(const uint8_t *before, const uint8_t *after, size_t size, std::vector<uint8_t> &out)
+{
+    size_t i = 0;
+    size_t last = 0;
+    while ((i = next_difference(before, after, i, size)) < size) {
+        size_t end = run_end(before, after, i, size);
+        put_varint(out, i - last);
+        put_varint(out, end - i);
+        for (; i < end; i++) {
+            out.push_back(before[i] ^ after[i]);
+        }
+        last = end;
+    }
+}
+
+bool apply_delta(const uint8_t *delta, size_t delta_size, uint8_t *bytes, size_t size)
+{
+    const uint8_t *p = delta;
+    const uint8_t *end = delta + delta_size;
+    size_t offset = 0;
+    while (p < end) {
+        size_t skip, count;
+        if (!get_varint(p, end, skip) || !get_varint(p, end, count) || skip > size - offset ||
+            count > size - offset - skip || count > static_cast<size_t>(end - p)) {
+            return false;
+        }
+        offset += skip;
+        for (size_t i = 0; i < count; i++) {
+            bytes[offset + i] ^= p[i];
+        }
+        offset += count;
+        p += count;
+    }
+    return true;
+}
+
+void SnapshotHistory::clear()
+{
+    entries_.clear();
+    last_.clear();
+    cursor_valid_ = false;
+    since_keyframe_ = 0;
+    memory_ = 0;
+}
+
+void SnapshotHistory::take(const uint8_t *bytes, size_t size, double time)
+{
+    if (!entries_.empty() && size != last_.size()) {
+        clear();
+    }
+    Entry entry{time, {}, {}};
+    if (!entries_.empty()) {
+        encode_delta(last_.data(), bytes, size, entry.delta);
+    }
+    if (entries_.empty() || ++since_keyframe_ >= keyframe_interval_) {
+        lz_compress(bytes, size, entry.keyframe);
+        since_keyframe_ = 0;
+    }
+    last_.assign(bytes, bytes + size);
+    memory_ += entry_memory(entry);
+    entries_.push_back(std::move(entry));
+    while (entries_.size() > 1 && memory_ + last_.size() > max_bytes_) {
+        drop_oldest();
+    }
+}
+
+// The second snapshot becomes the first, and has to be a keyframe
+void SnapshotHistory::drop_oldest()
+{
+    Entry &next = entries_[1];
+    memory_ -= entry_memory(entries_.front()) + entry_memory(next);
+    if (next.keyframe.empty()) {
+        auto const& bytes = get(1);
+        lz_compress(bytes.data(), bytes.size(), next.keyframe);
+    }
+    next.delta.clear();
+    next.delta.shrink_to_fit();
+    memory_ += entry_memory(next);
+    entries_.pop_front();
+    if (cursor_valid_ && cursor_index_ > 0) {
+        cursor_index_--;
+    } else {
+        cursor_valid_ = false;
+    }
+}
+
+std::vector<uint8_t> const& SnapshotHistory::get(size_t index)
+{
+    if (cursor_valid_ && cursor_index_ == index) {
+        return cursor_;
+    }
+    // Closest keyframe on either side, entry 0 always is one
+    size_t before = index;
+    while (entries_[before].keyframe.empty()) {
+        before--;
+    }
+    size_t after = index;
+    while (after < entries_.size() && entries_[after].keyframe.empty()) {
+        after++;
+    }
+    size_t from = before;
+    if (after < entries_.size() && after - index < index - before) {
+        from = after;
+    }
+    size_t distance = from > index ? from - index : index - from;
+    size_t cursor_distance = cursor_index_ > index ? cursor_index_ - index : index - cursor_index_;
+    if (!cursor_valid_ || distance < cursor_distance) {
+        auto const& keyframe = entries_[from].keyframe;
+        cursor_.resize(last_.size());
+        lz_decompress(keyframe.data(), keyframe.size(), cursor_.data(), cursor_.size());
+        cursor_index_ = from;
+        cursor_valid_ = true;
+    }
+    for (; cursor_index_ < index; cursor_index_++) {
+        auto const& delta = entries_[cursor_index_ + 1].delta;
+        apply_delta(delta.data(), delta.size(), cursor_.data(), cursor_.size());
+    }
+    for (; cursor_index_ > index; cursor_index_--) {
+        auto const& delta = entries_[cursor_index_].delta;
+        apply_delta(delta.data(), delta.size(), cursor_.data(), cursor_.size());
+    }
+    return cursor_;
+}
+
+}
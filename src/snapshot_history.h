@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace guicpp
+{
+
+// Snapshots of a memory over time. Each one is stored as the XOR of the previous one, run-length
+// encoded over the unchanged bytes; every Nth is also kept whole, LZ compressed, as a keyframe.
+// XOR deltas apply in both directions, so a snapshot is rebuilt from the closest keyframe or from
+// the last rebuilt one, whichever is fewer deltas away.
+class SnapshotHistory
+{
+public:
+    // Oldest snapshots are dropped when the history needs more than max_bytes
+    void set_max_bytes(size_t max_bytes) { max_bytes_ = max_bytes; }
+    void set_keyframe_interval(size_t interval) { keyframe_interval_ = interval > 0 ? interval : 1; }
+
+    // A different size starts a new history
+    void take(const uint8_t *bytes, size_t size, double time);
+    void clear();
+
+    size_t count() const { return entries_.size(); }
+    double time(size_t index) const { return entries_[index].time; }
+    size_t memory() const { return memory_; }
+    // Bytes of snapshot index, valid until the next call
+    std::vector<uint8_t> const& get(size_t index);
+
+private:
+    struct Entry
+    {
+        double time;
+        std::vector<uint8_t> delta;    // from the previous snapshot, empty for the first one
+        std::vector<uint8_t> keyframe; // compressed snapshot, empty if this is not a keyframe
+    };
+
+    static size_t entry_memory(Entry const& e) { return e.delta.size() + e.keyframe.size() + sizeof(Entry); }
+    void drop_oldest();
+
+    std::deque<Entry> entries_;
+    std::vector<uint8_t> last_;
+    std::vector<uint8_t> cursor_;
+    size_t cursor_index_ = 0;
+    bool cursor_valid_ = false;
+    size_t since_keyframe_ = 0;
+    size_t memory_ = 0;
+    size_t max_bytes_ = 64 << 20;
+    size_t keyframe_interval_ = 64;
+};
+
+// Appends the XOR of after and before as (unchanged count, changed count, changed bytes) records
+void encode_delta(const uint8_t *before, const uint8_t *after, size_t size, std::vector<uint8_t> &out);
+// XORs a delta into bytes, turning either side of it into the other. False if it is malformed.
+bool apply_delta(const uint8_t *delta, size_t delta_size, uint8_t *bytes, size_t size);
+
+}
@@ -0,0 +1,97 @@
+#include <gui/gui.h>
+#include <algorithm>
+#include <cstring>
+
+namespace guicpp
+{
+
+static constexpr size_t default_page_size = 4096;
+
+SparseSectorStore::SparseSectorStore(size_t sector_count, size_t sector_size, uint8_t erased_value) :
+    sector_count_{sector_count},
+    sector_size_{sector_size},
+    page_size_{sector_size > default_page_size && sector_size % default_page_size == 0 ? default_page_size : std::max<size_t>(sector_size, 1)},
+    erased_value_{erased_value},
+    pages_((sector_count * sector_size + page_size_ - 1) / page_size_),
+    erased_page_(page_size_, erased_value),
+    write_counts_(sector_count)
+{}
+
+Span<const uint8_t> SparseSectorStore::page(size_t index) const
+{
+    return Span<const uint8_t>{pages_[index] ? pages_[index].get() : erased_page_.data(), page_size_};
+}
+
+// Copy on write: the first write to a page gives it its own copy of the erased page
+uint8_t* SparseSectorStore::writable_page(size_t index)
+{
+    if (!pages_[index]) {
+        pages_[index] = std::make_unique<uint8_t[]>(page_size_);
+        std::memcpy(pages_[index].get(), erased_page_.data(), page_size_);
+        allocated_pages_++;
+    }
+    return pages_[index].get();
+}
+
+void SparseSectorStore::read(size_t offset, uint8_t *out, size_t size) const
+{
+    while (size > 0) {
+        size_t index = offset / page_size_;
+        size_t in_page = offset % page_size_;
+        size_t count = std::min(size, page_size_ - in_page);
+        std::memcpy(out, page(index).data() + in_page, count);
+        offset += count;
+        out += count;
+        size -= count;
+    }
+}
+
+void SparseSectorStore::write(size_t offset, const uint8_t *in, size_t size)
+{
+    while (size > 0) {
+        size_t index = offset / page_size_;
+        size_t in_page = offset % page_size_;
+        size_t count = std::min(size, page_size_ - in_page);
+        write_counts_[offset / sector_size_]++;
+        // Writing erased bytes into an unallocated page changes nothing
+        if (pages_[index] != nullptr || std::any_of(in, in + count, [this](uint8_t b) { return b != erased_value_; })) {
+            std::memcpy(writable_page(index) + in_page, in, count);
+        }
+        offset += count;
+        in += count;
+        size -= count;
+    }
+}
+
+uint8_t SparseSectorStore::get(size_t sector, size_t offset) const
+{
+    size_t addr = sector * sector_size_ + offset;
+    return page(addr / page_size_)[addr % page_size_];
+}
+
+void SparseSectorStore::set(size_t sector, size_t offset, uint8_t value)
+{
+    write(sector * sector_size_ + offset, &value, 1);
+}
+
+void SparseSectorStore::erase(size_t sector)
+{
+    size_t first = sector * sector_size_ / page_size_;
+    size_t last = ((sector + 1) * sector_size_ + page_size_ - 1) / page_size_;
+    write_counts_[sector]++;
+    for (size_t index = first; index < last && index < pages_.size(); index++) {
+        if (pages_[index]) {
+            pages_[index].reset();
+            allocated_pages_--;
+        }
+    }
+}
+
+void SparseSectorStore::erase_all()
+{
+    for (size_t sector = 0; sector < sector_count_; sector++) {
+        erase(sector);
+    }
+}
+
+}
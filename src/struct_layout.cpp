@@ -0,0 +1,298 @@
+#include <gui/gui.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace guicpp
+{
+
+namespace
+{
+
+struct TypeName
+{
+    const char *name;
+    FieldType type;
+};
+
+const TypeName type_names[] = {
+    {"u8", FieldType::u8}, {"i8", FieldType::i8}, {"u16", FieldType::u16}, {"i16", FieldType::i16},
+    {"u32", FieldType::u32}, {"i32", FieldType::i32}, {"u64", FieldType::u64}, {"i64", FieldType::i64},
+    {"f32", FieldType::f32}, {"f64", FieldType::f64},
+    {"uint8_t", FieldType::u8}, {"int8_t", FieldType::i8}, {"uint16_t", FieldType::u16}, {"int16_t", FieldType::i16},
+    {"uint32_t", FieldType::u32}, {"int32_t", FieldType::i32}, {"uint64_t", FieldType::u64}, {"int64_t", FieldType::i64},
+    {"float", FieldType::f32}, {"double", FieldType::f64},
+};
+
+// Loaders of parsed fields, by type and byte order
+uint64_t (* const loaders[][2])(const uint8_t *bytes) = {
+    {&load_field<uint8_t, Endian::little>, &load_field<uint8_t, Endian::big>},
+    {&load_field<int8_t, Endian::little>, &load_field<int8_t, Endian::big>},
+    {&load_field<uint16_t, Endian::little>, &load_field<uint16_t, Endian::big>},
+    {&load_field<int16_t, Endian::little>, &load_field<int16_t, Endian::big>},
+    {&load_field<uint32_t, Endian::little>, &load_field<uint32_t, Endian::big>},
+    {&load_field<int32_t, Endian::little>, &load_field<int32_t, Endian::big>},
+    {&load_field<uint64_t, Endian::little>, &load_field<uint64_t, Endian::big>},
+    {&load_field<int64_t, Endian::little>, &load_field<int64_t, Endian::big>},
+    {&load_field<float, Endian::little>, &load_field<float, Endian::big>},
+    {&load_field<double, Endian::little>, &load_field<double, Endian::big>},
+};
+
+class Parser
+{
+public:
+    explicit Parser(std::string_view text) : text_{text} {}
+
+    StructLayout parse()
+    {
+        std::string name = "layout";
+        bool braced = false;
+        if (peek_word() == "packed") {
+            word();
+            packed_ = true;
+            if (peek_word() != "struct") {
+                throw -1;
+            }
+        }
+        if (peek_word() == "struct") {
+            word();
+            if (!peek_word().empty()) {
+                name = std::string{word()};
+            }
+            expect('{');
+            braced = true;
+        }
+        StructLayout layout{name};
+        size_t offset = 0;
+        Unit unit;
+        while (!at_end() && !(braced && peek() == '}')) {
+            field(layout, offset, unit);
+        }
+        if (braced) {
+            expect('}');
+            if (peek() == ';') {
+                pos_++;
+                skip();
+            }
+        }
+        if (!at_end()) {
+            throw -1;
+        }
+        return layout;
+    }
+
+private:
+    // Storage unit of consecutive bitfields
+    struct Unit
+    {
+        bool open = false;
+        FieldType type = FieldType::u8;
+        Endian endian = Endian::little;
+        size_t offset = 0;
+        unsigned used = 0;
+    };
+
+    void field(StructLayout &layout, size_t &offset, Unit &unit)
+    {
+        Endian endian = Endian::little;
+        std::string_view type_word = word();
+        if (type_word == "be" || type_word == "le") {
+            endian = type_word == "be" ? Endian::big : Endian::little;
+            type_word = word();
+        }
+        FieldType type = lookup(type_word);
+        size_t size = StructLayout::type_size(type);
+        std::string name{word()};
+        size_t count = 1;
+        unsigned width = 0;
+        bool bitfield = false;
+        if (accept('[')) {
+            count = number();
+            expect(']');
+        }
+        if (accept(':')) {
+            bitfield = true;
+            width = static_cast<unsigned>(number());
+            if (count != 1 || width > 8 * size || type == FieldType::f32 || type == FieldType::f64) {
+                throw -1;
+            }
+        }
+        bool placed = accept('@');
+        size_t at = placed ? number() : 0;
+        expect(';');
+
+        if (unit.open && (!bitfield || placed || width == 0 || unit.type != type || unit.endian != endian || unit.used + width > 8 * size)) {
+            offset = unit.offset + StructLayout::type_size(unit.type);
+            unit.open = false;
+        }
+        if (placed) {
+            offset = at;
+        } else if (!packed_ && !unit.open) {
+            offset = (offset + size - 1) / size * size;
+        }
+        if (!bitfield) {
+            layout.add(LayoutField{name, type, endian, offset, count, 0, 0, loaders[static_cast<int>(type)][static_cast<int>(endian)]});
+            offset += size * count;
+            return;
+        }
+        if (width == 0) {
+            return;
+        }
+        if (!unit.open) {
+            unit = Unit{true, type, endian, offset, 0};
+        }
+        layout.add(LayoutField{name, type, endian, unit.offset, 1, unit.used, width, loaders[static_cast<int>(type)][static_cast<int>(endian)]});
+        unit.used += width;
+    }
+
+    static FieldType lookup(std::string_view name)
+    {
+        for (auto const& t : type_names) {
+            if (name == t.name) {
+                return t.type;
+            }
+        }
+        throw -1;
+    }
+
+    // Skips spaces and // or # comments
+    void skip()
+    {
+        while (pos_ < text_.size()) {
+            char c = text_[pos_];
+            if (std::isspace(static_cast<unsigned char>(c))) {
+                pos_++;
+            } else if (c == '#' || text_.substr(pos_, 2) == "//") {
+                while (pos_ < text_.size() && text_[pos_] != '\n') {
+                    pos_++;
+                }
+            } else {
+                break;
+            }
+        }
+    }
+
+    bool at_end()
+    {
+        skip();
+        return pos_ >= text_.size();
+    }
+
+    char peek()
+    {
+        skip();
+        return pos_ < text_.size() ? text_[pos_] : '\0';
+    }
+
+    bool accept(char c)
+    {
+        if (peek() != c) {
+            return false;
+        }
+        pos_++;
+        return true;
+    }
+
+    void expect(char c)
+    {
+        if (!accept(c)) {
+            throw -1;
+        }
+    }
+
+    // Identifiers may contain dots, for names like "status.ready"
+    std::string_view peek_word()
+    {
+        skip();
+        size_t end = pos_;
+        if (end < text_.size() && (std::isalpha(static_cast<unsigned char>(text_[end])) || text_[end] == '_')) {
+            while (end < text_.size() && (std::isalnum(static_cast<unsigned char>(text_[end])) || text_[end] == '_' || text_[end] == '.')) {
+                end++;
+            }
+        }
+        return text_.substr(pos_, end - pos_);
+    }
+
+    std::string_view word()
+    {
+        std::string_view w = peek_word();
+        if (w.empty()) {
+            throw -1;
+        }
+        pos_ += w.size();
+        return w;
+    }
+
+    // Decimal or 0x hexadecimal
+    size_t number()
+    {
+        skip();
+        std::string digits;
+        while (pos_ < text_.size() && std::isalnum(static_cast<unsigned char>(text_[pos_]))) {
+            digits += text_[pos_++];
+        }
+        char *end = nullptr;
+        unsigned long long value = std::strtoull(digits.c_str(), &end, 0);
+        if (digits.empty() || *end != '\0') {
+            throw -1;
+        }
+        return static_cast<size_t>(value);
+    }
+
+    std::string_view text_;
+    size_t pos_ = 0;
+    bool packed_ = false;
+};
+
+}
+
+size_t StructLayout::type_size(FieldType type)
+{
+    switch (type) {
+    case FieldType::u8:
+    case FieldType::i8:
+        return 1;
+    case FieldType::u16:
+    case FieldType::i16:
+        return 2;
+    case FieldType::u32:
+    case FieldType::i32:
+    case FieldType::f32:
+        return 4;
+    default:
+        return 8;
+    }
+}
+
+StructLayout& StructLayout::add(LayoutField field)
+{
+    size_t size = StructLayout::type_size(field.type);
+    if (field.count == 0 || field.bit_offset + field.bit_width > 8 * size) {
+        throw -1;
+    }
+    size_ = std::max(size_, field.offset + size * field.count);
+    fields_.push_back(std::move(field));
+    // A decoder only covers the fields it was made for
+    decode_ = nullptr;
+    return *this;
+}
+
+StructLayout StructLayout::parse(std::string_view text)
+{
+    return Parser{text}.parse();
+}
+
+StructLayout StructLayout::load(const char *path)
+{
+    std::ifstream file{path};
+    if (!file) {
+        throw -1;
+    }
+    std::stringstream text;
+    text << file.rdbuf();
+    return parse(text.str());
+}
+
+}
@@ -0,0 +1,181 @@
+#include "struct_overlay.h"
+#include "imgui.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace guicpp
+{
+
+namespace
+{
+
+const char *type_names[] = {"u8", "i8", "u16", "i16", "u32", "i32", "u64", "i64", "f32", "f64"};
+
+uint64_t low_bits(unsigned bits)
+{
+    return bits >= 64 ? ~0ull : (1ull << bits) - 1;
+}
+
+}
+
+void format_field(FieldType type, unsigned bits, uint64_t raw, char *value, size_t value_size, char *hex, size_t hex_size)
+{
+    switch (type) {
+    case FieldType::f32: {
+        uint32_t u = static_cast<uint32_t>(raw);
+        float f;
+        std::memcpy(&f, &u, sizeof(f));
+        snprintf(value, value_size, "%g", f);
+        break;
+    }
+    case FieldType::f64: {
+        double d;
+        std::memcpy(&d, &raw, sizeof(d));
+        snprintf(value, value_size, "%g", d);
+        break;
+    }
+    case FieldType::i8:
+    case FieldType::i16:
+    case FieldType::i32:
+    case FieldType::i64: {
+        uint64_t extended = bits < 64 && (raw >> (bits - 1) & 1) != 0 ? raw | ~low_bits(bits) : raw;
+        snprintf(value, value_size, "%lld", static_cast<long long>(extended));
+        break;
+    }
+    default:
+        snprintf(value, value_size, "%llu", static_cast<unsigned long long>(raw));
+        break;
+    }
+    snprintf(hex, hex_size, "0x%0*llX", static_cast<int>((bits + 3) / 4), static_cast<unsigned long long>(raw));
+}
+
+StructOverlay::StructOverlay(StructLayout layout, size_t offset) :
+    layout_{std::move(layout)},
+    offset_{offset}
+{
+    auto const& fields = layout_.fields();
+    for (size_t f = 0; f < fields.size(); f++) {
+        auto const& field = fields[f];
+        size_t size = StructLayout::type_size(field.type);
+        for (size_t i = 0; i < field.count; i++) {
+            Row row{f, field.offset + i * size, size, field.name, 0, -1e30, false, "-", ""};
+            if (field.count > 1) {
+                row.label += "[" + std::to_string(i) + "]";
+            }
+            rows_.push_back(std::move(row));
+        }
+    }
+}
+
+// Unchanged memory, the common case, costs one comparison with the bytes of the last update
+void StructOverlay::update(const uint8_t *bytes, size_t size, double now)
+{
+    size = std::min(size, layout_.size());
+    if (decoded_ && size == previous_.size() && std::memcmp(bytes, previous_.data(), size) == 0) {
+        return;
+    }
+    // A fixed layout has a row per field and decodes them all at once when they are all in memory
+    const bool decoded = layout_.decoder() != nullptr && size == layout_.size();
+    if (decoded) {
+        raws_.resize(rows_.size());
+        layout_.decoder()(bytes, raws_.data());
+    }
+    auto const& fields = layout_.fields();
+    for (size_t i = 0; i < rows_.size(); i++) {
+        auto &row = rows_[i];
+        auto const& field = fields[row.field];
+        if (row.offset + row.size > size) {
+            row.valid = false;
+            snprintf(row.value, sizeof(row.value), "-");
+            row.hex[0] = '\0';
+            continue;
+        }
+        uint64_t raw = decoded ? raws_[i] : field.load(bytes + row.offset);
+        unsigned bits = static_cast<unsigned>(8 * row.size);
+        if (field.bit_width != 0) {
+            raw = raw >> field.bit_offset & low_bits(field.bit_width);
+            bits = field.bit_width;
+        }
+        if (row.valid && raw == row.raw) {
+            continue;
+        }
+        if (row.valid) {
+            row.changed_at = now;
+        }
+        row.raw = raw;
+        row.valid = true;
+        format_field(field.type, bits, raw, row.value, sizeof(row.value), row.hex, sizeof(row.hex));
+    }
+    previous_.assign(bytes, bytes + size);
+    decoded_ = true;
+}
+
+bool StructOverlay::draw(double now, size_t &begin, size_t &end)
+{
+    const ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_ScrollY;
+    if (!ImGui::BeginTable("##fields", 5, flags)) {
+        return false;
+    }
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("Offset", ImGuiTableColumnFlags_WidthFixed);
+    ImGui::TableSetupColumn("Field", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableSetupColumn("Type", ImGuiTableColumnFlags_WidthFixed);
+    ImGui::TableSetupColumn("Value", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableSetupColumn("Hex", ImGuiTableColumnFlags_WidthFixed);
+    ImGui::TableHeadersRow();
+
+    // Changed values fade from orange back to the text color
+    const ImVec4 text = ImGui::GetStyle().Colors[ImGuiCol_Text];
+    const ImVec4 changed{1.0f, 0.55f, 0.25f, 1.0f};
+    auto const& fields = layout_.fields();
+    bool clicked = false;
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(rows_.size()));
+    while (clipper.Step()) {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+            auto const& row = rows_[i];
+            auto const& field = fields[row.field];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            char label[48];
+            if (field.bit_width != 0) {
+                snprintf(label, sizeof(label), "%04zX.%u##%d", offset_ + row.offset, field.bit_offset, i);
+            } else {
+                snprintf(label, sizeof(label), "%04zX##%d", offset_ + row.offset, i);
+            }
+            if (ImGui::Selectable(label, selected_ == i, ImGuiSelectableFlags_SpanAllColumns)) {
+                selected_ = i;
+                begin = offset_ + row.offset;
+                end = begin + row.size;
+                clicked = true;
+            }
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(row.label.c_str());
+            ImGui::TableNextColumn();
+            const char *type = type_names[static_cast<int>(field.type)];
+            if (field.bit_width != 0) {
+                ImGui::Text("%s:%u", type, field.bit_width);
+            } else {
+                ImGui::Text("%s%s", type, row.size > 1 && field.endian == Endian::big ? " be" : "");
+            }
+            ImGui::TableNextColumn();
+            float heat = static_cast<float>(1.0 - (now - row.changed_at) / decay);
+            if (!row.valid) {
+                ImGui::TextDisabled("%s", row.value);
+            } else if (heat > 0.0f) {
+                ImVec4 color{text.x + (changed.x - text.x) * heat, text.y + (changed.y - text.y) * heat,
+                             text.z + (changed.z - text.z) * heat, text.w};
+                ImGui::TextColored(color, "%s", row.value);
+            } else {
+                ImGui::TextUnformatted(row.value);
+            }
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(row.hex);
+        }
+    }
+    ImGui::EndTable();
+    return clicked;
+}
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <gui/gui.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace guicpp
+{
+
+// Formats a loaded field value, bits is the width of the value for sign extension
+void format_field(FieldType type, unsigned bits, uint64_t raw, char *value, size_t value_size, char *hex, size_t hex_size);
+
+// Decoded values of a layout placed on memory, one row per field and array element. Rows are
+// decoded every update but only formatted again when their value changed.
+class StructOverlay
+{
+public:
+    // Seconds a changed value stays marked
+    static constexpr double decay = 1.0;
+
+    StructOverlay(StructLayout layout, size_t offset);
+
+    StructLayout const& layout() const { return layout_; }
+    size_t offset() const { return offset_; }
+
+    // bytes holds the memory from the offset on, size may be short of the layout at the end of memory
+    void update(const uint8_t *bytes, size_t size, double now);
+    // Table of the rows. Returns true with the bytes of the row in [begin, end) when one was clicked.
+    bool draw(double now, size_t &begin, size_t &end);
+
+private:
+    struct Row
+    {
+        size_t field;
+        size_t offset; // from the start of the layout
+        size_t size;
+        std::string label;
+        uint64_t raw;
+        double changed_at;
+        bool valid;
+        char value[32];
+        char hex[24];
+    };
+
+    StructLayout layout_;
+    size_t offset_;
+    std::vector<Row> rows_;
+    std::vector<uint8_t> previous_;
+    std::vector<uint64_t> raws_;
+    bool decoded_ = false;
+    int selected_ = -1;
+};
+
+}
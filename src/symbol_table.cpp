@@ -0,0 +1,439 @@
+#include "symbol_table.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace guicpp
+{
+
+namespace
+{
+
+// A symbol as read, before the table is sorted. limit is the end of its size or section, 0 when unknown.
+struct Entry
+{
+    uint64_t address;
+    uint64_t limit;
+    std::string_view name;
+    // Aliases at one address are shown by their best name, compiler and linker generated ones last
+    int rank;
+};
+
+// Names are sorted by hash, so that sorting and searching compare strings only on equal hashes
+struct Name
+{
+    uint64_t hash;
+    std::string_view name;
+    uint64_t address;
+
+    bool operator<(Name const& rhs) const { return hash != rhs.hash ? hash < rhs.hash : address < rhs.address; }
+};
+
+// FNV-1a
+uint64_t hash(std::string_view name)
+{
+    uint64_t h = 14695981039346656037ull;
+    for (char c : name) {
+        h = (h ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+    }
+    return h;
+}
+
+constexpr size_t max_tokens = 8;
+
+// Lines of the file, without line endings
+class Lines
+{
+public:
+    explicit Lines(std::string_view text) : p_{text.data()}, end_{text.data() + text.size()} {}
+
+    bool next(std::string_view &line)
+    {
+        if (p_ >= end_) {
+            return false;
+        }
+        auto nl = static_cast<const char*>(std::memchr(p_, '\n', static_cast<size_t>(end_ - p_)));
+        const char *e = nl != nullptr ? nl : end_;
+        line = std::string_view{p_, static_cast<size_t>(e - p_)};
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        p_ = nl != nullptr ? nl + 1 : end_;
+        return true;
+    }
+
+private:
+    const char *p_;
+    const char *end_;
+};
+
+bool is_space(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+// Splits at spaces, keeping the first max_tokens. Returns the number of tokens on the line.
+size_t tokenize(std::string_view line, std::string_view *tokens)
+{
+    size_t n = 0;
+    size_t i = 0;
+    while (i < line.size()) {
+        while (i < line.size() && is_space(line[i])) {
+            i++;
+        }
+        if (i == line.size()) {
+            break;
+        }
+        size_t start = i;
+        while (i < line.size() && !is_space(line[i])) {
+            i++;
+        }
+        if (n < max_tokens) {
+            tokens[n] = line.substr(start, i - start);
+        }
+        n++;
+    }
+    return n;
+}
+
+// From the start of token to the end of the line, for names with spaces
+std::string_view rest_of_line(std::string_view line, std::string_view token)
+{
+    std::string_view rest{token.data(), static_cast<size_t>(line.data() + line.size() - token.data())};
+    while (!rest.empty() && is_space(rest.back())) {
+        rest.remove_suffix(1);
+    }
+    return rest;
+}
+
+// Hexadecimal, with 0x when prefixed. IAR separates groups of digits with '.
+bool parse_hex(std::string_view text, bool prefixed, uint64_t &value)
+{
+    if (prefixed) {
+        if (text.size() < 3 || text[0] != '0' || (text[1] != 'x' && text[1] != 'X')) {
+            return false;
+        }
+        text.remove_prefix(2);
+    }
+    value = 0;
+    int digits = 0;
+    for (char c : text) {
+        int digit;
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            digit = c - 'A' + 10;
+        } else if (c == '\'') {
+            continue;
+        } else {
+            return false;
+        }
+        if (++digits > 16) {
+            return false;
+        }
+        value = value << 4 | static_cast<uint64_t>(digit);
+    }
+    return digits > 0;
+}
+
+// 0x hexadecimal or decimal
+bool parse_size(std::string_view text, uint64_t &value)
+{
+    if (parse_hex(text, true, value)) {
+        return true;
+    }
+    value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        value = value * 10 + static_cast<uint64_t>(c - '0');
+    }
+    return !text.empty();
+}
+
+int rank(std::string_view name)
+{
+    return name.empty() || name[0] == '.' || name[0] == '$' || name.find("$$") != std::string_view::npos ? 1 : 0;
+}
+
+void add(std::vector<Entry> &entries, uint64_t address, uint64_t limit, std::string_view name)
+{
+    entries.push_back(Entry{address, limit > address ? limit : 0, name, rank(name)});
+}
+
+// GNU ld: symbols are "0xADDRESS name" lines below the input section holding them, whose address
+// and size bound the symbol. Long section names push the address and size to the next line.
+// Assignments and PROVIDE lines have more tokens and are skipped.
+void parse_gnu(std::string_view text, std::vector<Entry> &entries)
+{
+    Lines lines{text};
+    std::string_view line;
+    std::string_view t[max_tokens];
+    uint64_t limit = 0;
+    bool wrapped = false;
+    while (lines.next(line)) {
+        size_t n = tokenize(line, t);
+        if (n == 0) {
+            continue;
+        }
+        uint64_t address, size;
+        bool hex0 = parse_hex(t[0], true, address);
+        if (n == 1) {
+            wrapped = !hex0;
+            continue;
+        }
+        if (!hex0 && n >= 3 && parse_hex(t[1], true, address) && parse_hex(t[2], true, size)) {
+            limit = address + size;
+            wrapped = false;
+            continue;
+        }
+        if (wrapped && hex0 && parse_hex(t[1], true, size)) {
+            limit = address + size;
+            wrapped = false;
+            continue;
+        }
+        wrapped = false;
+        if (hex0 && n == 2 && is_space(line[0])) {
+            add(entries, address, address < limit ? limit : 0, t[1]);
+        }
+    }
+}
+
+// IAR ilink ENTRY LIST: "name address size type scope object", the size may be "--" or missing and
+// long names stand alone on their line. Thumb code entries have the lowest address bit set.
+void parse_iar(std::string_view text, std::vector<Entry> &entries)
+{
+    Lines lines{text};
+    std::string_view line;
+    std::string_view t[max_tokens];
+    std::string_view wrapped;
+    while (lines.next(line)) {
+        if (line.substr(0, 3) == "***" && !entries.empty()) {
+            break;
+        }
+        size_t n = std::min(tokenize(line, t), max_tokens);
+        if (n == 1) {
+            wrapped = t[0];
+            continue;
+        }
+        std::string_view name = t[0];
+        std::string_view *fields = t + 1;
+        size_t count = n - 1;
+        uint64_t address;
+        if (!wrapped.empty() && parse_hex(t[0], true, address)) {
+            name = wrapped;
+            fields = t;
+            count = n;
+        }
+        wrapped = {};
+        if (count == 0 || !parse_hex(fields[0], true, address)) {
+            continue;
+        }
+        uint64_t size = 0;
+        size_t type = 1;
+        if (count > 1 && parse_size(fields[1], size)) {
+            type = 2;
+        }
+        if (type < count && fields[type] == "Code") {
+            address &= ~1ull;
+        }
+        add(entries, address, size > 0 ? address + size : 0, name);
+    }
+}
+
+// nm: "address [size] type name", names may contain spaces when demangled
+void parse_nm(std::string_view text, std::vector<Entry> &entries)
+{
+    Lines lines{text};
+    std::string_view line;
+    std::string_view t[max_tokens];
+    while (lines.next(line)) {
+        size_t n = tokenize(line, t);
+        uint64_t address, size = 0;
+        if (n < 3 || !parse_hex(t[0], false, address)) {
+            continue;
+        }
+        size_t type = 1;
+        if (t[1].size() != 1) {
+            if (n < 4 || !parse_hex(t[1], false, size)) {
+                continue;
+            }
+            type = 2;
+        }
+        if (t[type].size() != 1 || t[type] == "U" || t[type] == "N") {
+            continue;
+        }
+        add(entries, address, size > 0 ? address + size : 0, rest_of_line(line, t[type + 1]));
+    }
+}
+
+}
+
+struct SymbolTable::impl
+{
+    MappedFile file;
+    std::vector<Symbol> symbols;
+    std::vector<Name> names;
+
+    // Aliases keep one symbol per address, and every symbol ends where the next starts at the
+    // latest, so that one binary search finds the symbol of an address
+    void build(std::vector<Entry> &entries)
+    {
+        names.reserve(entries.size());
+        for (auto const& e : entries) {
+            names.push_back(Name{hash(e.name), e.name, e.address});
+        }
+        std::sort(names.begin(), names.end());
+        // GNU maps and nm -n list symbols in address order already
+        auto by_address = [](Entry const& a, Entry const& b) {
+            return a.address != b.address ? a.address < b.address : a.rank < b.rank;
+        };
+        if (!std::is_sorted(entries.begin(), entries.end(), by_address)) {
+            std::sort(entries.begin(), entries.end(), by_address);
+        }
+        symbols.reserve(entries.size());
+        for (size_t i = 0; i < entries.size();) {
+            size_t j = i;
+            uint64_t limit = 0;
+            for (; j < entries.size() && entries[j].address == entries[i].address; j++) {
+                limit = std::max(limit, entries[j].limit);
+            }
+            uint64_t address = entries[i].address;
+            uint64_t end = limit;
+            if (j < entries.size() && (end == 0 || end > entries[j].address)) {
+                end = entries[j].address;
+            }
+            symbols.push_back(Symbol{address, end > address ? end - address : 0, entries[i].name});
+            i = j;
+        }
+    }
+};
+
+SymbolTable::SymbolTable(const char *path) :
+    pimpl_{std::make_unique<impl>()}
+{
+    if (!pimpl_->file.open(path)) {
+        throw -1;
+    }
+    std::string_view text{reinterpret_cast<const char*>(pimpl_->file.data()), static_cast<size_t>(pimpl_->file.size())};
+    std::vector<Entry> entries;
+    size_t gnu = text.find("Linker script and memory map");
+    size_t iar = gnu == std::string_view::npos ? text.find("*** ENTRY LIST") : std::string_view::npos;
+    if (gnu != std::string_view::npos) {
+        parse_gnu(text.substr(gnu), entries);
+    } else if (iar != std::string_view::npos) {
+        parse_iar(text.substr(iar + 14), entries);
+    } else {
+        parse_nm(text, entries);
+    }
+    if (entries.empty()) {
+        throw -1;
+    }
+    pimpl_->build(entries);
+}
+
+SymbolTable::~SymbolTable() = default;
+
+std::vector<SymbolTable::Symbol> const& SymbolTable::symbols() const
+{
+    return pimpl_->symbols;
+}
+
+SymbolTable::Symbol const* SymbolTable::at(uint64_t address) const
+{
+    auto const& symbols = pimpl_->symbols;
+    auto it = std::upper_bound(symbols.begin(), symbols.end(), address, [](uint64_t a, Symbol const& s) { return a < s.address; });
+    if (it == symbols.begin()) {
+        return nullptr;
+    }
+    --it;
+    return address - it->address < it->size ? &*it : nullptr;
+}
+
+SymbolTable::Symbol const* SymbolTable::next(uint64_t address) const
+{
+    auto const& symbols = pimpl_->symbols;
+    auto it = std::lower_bound(symbols.begin(), symbols.end(), address, [](Symbol const& s, uint64_t a) { return s.address < a; });
+    return it != symbols.end() ? &*it : nullptr;
+}
+
+bool SymbolTable::find(std::string_view name, uint64_t &address) const
+{
+    auto const& names = pimpl_->names;
+    const uint64_t h = hash(name);
+    auto it = std::lower_bound(names.begin(), names.end(), Name{h, name, 0});
+    for (; it != names.end() && it->hash == h; ++it) {
+        if (it->name == name) {
+            address = it->address;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* SymbolLabels::label(uint64_t address, size_t size, bool &dim)
+{
+    auto const& symbols = table_->symbols();
+    if (auto s = table_->next(address); s != nullptr && s->address - address < size) {
+        size_t more = 0;
+        for (auto t = s + 1; t != symbols.data() + symbols.size() && t->address - address < size; t++) {
+            more++;
+        }
+        int length = static_cast<int>(std::min<size_t>(s->name.size(), sizeof(buffer_) - 24));
+        if (more > 0) {
+            snprintf(buffer_, sizeof(buffer_), "%.*s +%zu", length, s->name.data(), more);
+        } else {
+            snprintf(buffer_, sizeof(buffer_), "%.*s", length, s->name.data());
+        }
+        dim = false;
+        return buffer_;
+    }
+    if (auto s = table_->at(address)) {
+        int length = static_cast<int>(std::min<size_t>(s->name.size(), sizeof(buffer_) - 24));
+        snprintf(buffer_, sizeof(buffer_), "%.*s+0x%llX", length, s->name.data(), static_cast<unsigned long long>(address - s->address));
+        dim = true;
+        return buffer_;
+    }
+    return nullptr;
+}
+
+bool SymbolLabels::resolve(const char *text, uint64_t &address) const
+{
+    std::string_view name{text};
+    while (!name.empty() && is_space(name.front())) {
+        name.remove_prefix(1);
+    }
+    while (!name.empty() && is_space(name.back())) {
+        name.remove_suffix(1);
+    }
+    if (table_->find(name, address)) {
+        return true;
+    }
+    // Names like operator+ were tried whole first
+    size_t plus = name.rfind('+');
+    if (plus == std::string_view::npos || plus == 0) {
+        return false;
+    }
+    std::string offset_text{name.substr(plus + 1)};
+    char *end = nullptr;
+    uint64_t offset = std::strtoull(offset_text.c_str(), &end, 0);
+    if (offset_text.empty() || *end != '\0') {
+        return false;
+    }
+    name = name.substr(0, plus);
+    while (!name.empty() && is_space(name.back())) {
+        name.remove_suffix(1);
+    }
+    if (!table_->find(name, address)) {
+        return false;
+    }
+    address += offset;
+    return true;
+}
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <gui/gui.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace guicpp
+{
+
+// Row labels and goto names of a memory editor from a symbol table. Addresses are absolute,
+// the windows add their base to offsets.
+class SymbolLabels
+{
+public:
+    SymbolLabels() = default;
+    SymbolLabels(SymbolTable const *table, uint64_t base) : table_{table}, base_{base} {}
+
+    bool enabled() const { return table_ != nullptr; }
+    SymbolTable const* table() const { return table_; }
+    uint64_t base() const { return base_; }
+
+    // Names of the symbols starting in [address, address + size), or the symbol the range is in with
+    // the offset into it, dimmed. Null when there is none. Points into a buffer reused by the next call.
+    const char* label(uint64_t address, size_t size, bool &dim);
+    // "name" or "name+offset", offsets in decimal or 0x hexadecimal
+    bool resolve(const char *text, uint64_t &address) const;
+
+private:
+    SymbolTable const *table_ = nullptr;
+    uint64_t base_ = 0;
+    char buffer_[160];
+};
+
+}
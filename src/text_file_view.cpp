@@ -0,0 +1,292 @@
+#include <gui/gui.h>
+#include "imgui.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace guicpp
+{
+
+struct TextFileView::impl
+{
+    // Only the start of every Nth line is indexed; visible lines are found by scanning forward
+    // from the nearest checkpoint, which keeps the index tiny even for multi-GB files.
+    static constexpr uint64_t lines_per_checkpoint = 256;
+    static constexpr uint64_t index_chunk_size = 4 << 20;
+    static constexpr size_t max_line_chars = 4096;
+    // ImGui scroll positions are floats and clipper counts are ints, so files with more lines than this
+    // are shown through a scrolling region of view_max_lines lines starting at view_line_base_.
+    static constexpr uint64_t view_max_lines = 1 << 19;
+    static constexpr uint64_t no_line = ~0ull;
+
+    impl(const char* text, const char *path, Size size = {}, Position position = {}) :
+        text_{text}, path_{path}, size_{size}, position_{position}
+    {}
+
+    ~impl()
+    {
+        stop_ = true;
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    void reset_index()
+    {
+        checkpoints_.assign(1, 0);
+        newlines_ = 0;
+        last_line_start_ = 0;
+        indexed_ = 0;
+    }
+
+    // Runs on the indexing thread, which is also the only one remapping the file, so
+    // the mapping can be read here without holding the lock.
+    void index()
+    {
+        const char *data = reinterpret_cast<const char*>(file_.data());
+        uint64_t end = file_.size();
+        uint64_t pos = indexed_;
+        uint64_t newlines = newlines_;
+        uint64_t last_line_start = last_line_start_;
+        std::vector<uint64_t> found;
+        while (pos < end && !stop_) {
+            const char *p = data + pos;
+            const char *chunk_end = data + std::min(end, pos + index_chunk_size);
+            while ((p = static_cast<const char*>(std::memchr(p, '\n', chunk_end - p))) != nullptr) {
+                p++;
+                newlines++;
+                last_line_start = p - data;
+                if (newlines % lines_per_checkpoint == 0) {
+                    found.push_back(last_line_start);
+                }
+            }
+            pos = chunk_end - data;
+
+            std::lock_guard<std::mutex> lock{mutex_};
+            checkpoints_.insert(checkpoints_.end(), found.begin(), found.end());
+            found.clear();
+            newlines_ = newlines;
+            last_line_start_ = last_line_start;
+            indexed_ = pos;
+        }
+    }
+
+    void run()
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            if (!file_.open(path_)) {
+                failed_ = true;
+                return;
+            }
+            reset_index();
+        }
+        FileWatcher watcher{path_};
+        index();
+        // The size is watched even when not following, reading a mapping past the end of a
+        // truncated file faults. The index is dropped before such a remap, or one that fails,
+        // so draw() never reaches past the mapping.
+        while (!stop_) {
+            // Checked after every wait, so growth while not following is picked up once following
+            watcher.wait(100);
+            uint64_t file_size = file_.file_size();
+            if (file_size == file_.size() || (file_size > file_.size() && !follow_)) {
+                continue;
+            }
+            {
+                std::lock_guard<std::mutex> lock{mutex_};
+                if (file_size < indexed_) {
+                    // Truncated or rewritten, start over
+                    reset_index();
+                }
+                if (!file_.remap()) {
+                    reset_index();
+                }
+            }
+            index();
+        }
+    }
+
+    uint64_t line_count() const
+    {
+        return newlines_ + (last_line_start_ < indexed_ ? 1 : 0);
+    }
+
+    // Lines are read up to readable, the indexed part of the file still on disk
+    void draw_lines(uint64_t first, uint64_t last, uint64_t readable)
+    {
+        const char *data = reinterpret_cast<const char*>(file_.data());
+        const char *end = data + readable;
+        uint64_t checkpoint = first / lines_per_checkpoint;
+        if (checkpoint >= checkpoints_.size() || checkpoints_[checkpoint] >= readable) {
+            return;
+        }
+        const char *p = data + checkpoints_[checkpoint];
+        for (uint64_t skip = first % lines_per_checkpoint; skip > 0; skip--) {
+            const char *eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            if (eol == nullptr) {
+                return;
+            }
+            p = eol + 1;
+        }
+        for (uint64_t line = first; line < last && p < end; line++) {
+            const char *eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            const char *line_end = eol ? eol : end;
+            const char *text_end = line_end;
+            if (text_end > p && text_end[-1] == '\r') {
+                text_end--;
+            }
+            if (static_cast<size_t>(text_end - p) > max_line_chars) {
+                text_end = p + max_line_chars;
+            }
+            ImGui::TextUnformatted(p, text_end);
+            p = line_end + 1;
+        }
+    }
+
+    uint64_t clamp_base(uint64_t base, uint64_t lines) const
+    {
+        if (base + view_max_lines > lines) {
+            base = lines > view_max_lines ? lines - view_max_lines : 0;
+        }
+        return base;
+    }
+
+    void draw()
+    {
+        if (!thread_.joinable()) {
+            thread_ = std::thread([this]() { run(); });
+        }
+        ImGui::SetNextWindowSize(ImVec2(size_.width, size_.height), ImGuiCond_FirstUseEver);
+        ImGui::SetNextWindowPos(ImVec2(position_.x, position_.y), ImGuiCond_FirstUseEver);
+        ImGui::Begin(text_);
+        std::lock_guard<std::mutex> lock{mutex_};
+        if (failed_) {
+            ImGui::Text("Cannot open %s", path_);
+            ImGui::End();
+            return;
+        }
+
+        bool follow = follow_;
+        if (ImGui::Checkbox("Follow tail", &follow)) {
+            follow_ = follow;
+        }
+        ImGui::SameLine();
+        uint64_t lines = line_count();
+        if (indexed_ < file_.size()) {
+            char overlay[64];
+            snprintf(overlay, sizeof(overlay), "Indexing... %llu lines", static_cast<unsigned long long>(lines));
+            ImGui::ProgressBar(static_cast<float>(static_cast<double>(indexed_) / file_.size()), ImVec2(-1.0f, 0.0f), overlay);
+        } else {
+            ImGui::Text("%llu lines, %llu bytes", static_cast<unsigned long long>(lines), static_cast<unsigned long long>(indexed_));
+        }
+        // The scrollbar only spans view_max_lines lines, this jumps anywhere in huge files
+        if (lines > view_max_lines) {
+            uint64_t line = first_visible_;
+            const uint64_t line_min = 0, line_max = lines - 1;
+            ImGui::SetNextItemWidth(-1.0f);
+            if (ImGui::SliderScalar("##line", ImGuiDataType_U64, &line, &line_min, &line_max, "line %llu")) {
+                goto_line_ = line;
+            }
+        }
+        ImGui::Separator();
+
+        // Never past the mapping, which may be shorter than the index until the thread catches up
+        const uint64_t readable = std::min(indexed_, file_.size());
+        ImGui::BeginChild("scrolling", ImVec2(0, 0), false, ImGuiWindowFlags_HorizontalScrollbar);
+        ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(0,1));
+        const float line_height = ImGui::GetTextLineHeightWithSpacing();
+        // The scroll target for a moved region was set last frame and has been applied by BeginChild() above
+        if (pending_view_line_base_ != no_line) {
+            view_line_base_ = pending_view_line_base_;
+            pending_view_line_base_ = no_line;
+        }
+        const bool tail = follow && lines != drawn_lines_;
+        view_line_base_ = clamp_base(tail ? lines : view_line_base_, lines);
+        const uint64_t view_lines = std::min(lines - view_line_base_, view_max_lines);
+
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(view_lines), line_height);
+        int display_start = static_cast<int>(view_lines);
+        int display_end = 0;
+        while (clipper.Step()) {
+            display_start = std::min(display_start, clipper.DisplayStart);
+            display_end = std::max(display_end, clipper.DisplayEnd);
+            draw_lines(view_line_base_ + clipper.DisplayStart, view_line_base_ + clipper.DisplayEnd, readable);
+        }
+        clipper.End();
+        first_visible_ = view_line_base_ + std::min<uint64_t>(display_start, view_lines);
+        if (tail) {
+            ImGui::SetScrollHereY(1.0f);
+        } else if (lines > view_max_lines) {
+            // Move the scrolling region before the user reaches its edges, compensating the scroll position next frame
+            const uint64_t margin = view_max_lines / 4;
+            uint64_t base = view_line_base_;
+            if (static_cast<uint64_t>(display_start) < margin && base > 0) {
+                base = base > margin ? base - margin : 0;
+            } else if (static_cast<uint64_t>(display_end) > view_max_lines - margin) {
+                base = clamp_base(base + margin, lines);
+            }
+            if (base != view_line_base_) {
+                const float shift_lines = base > view_line_base_ ? -static_cast<float>(base - view_line_base_) : static_cast<float>(view_line_base_ - base);
+                ImGui::SetScrollY(ImGui::GetScrollY() + shift_lines * line_height);
+                pending_view_line_base_ = base;
+            }
+        }
+        drawn_lines_ = lines;
+        ImGui::PopStyleVar();
+        ImGui::EndChild();
+
+        if (goto_line_ != no_line) {
+            const uint64_t base = clamp_base(goto_line_ > view_max_lines / 2 ? goto_line_ - view_max_lines / 2 : 0, lines);
+            pending_view_line_base_ = base;
+            ImGui::BeginChild("scrolling");
+            ImGui::SetScrollY(static_cast<float>(goto_line_ - base) * line_height);
+            ImGui::EndChild();
+            goto_line_ = no_line;
+        }
+        ImGui::End();
+    }
+
+    const char *text_;
+    const char *path_;
+    Size size_;
+    Position position_;
+private:
+    std::thread thread_;
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> follow_{false};
+    std::mutex mutex_;
+    bool failed_ = false;
+    MappedFile file_;
+    std::vector<uint64_t> checkpoints_;
+    uint64_t newlines_ = 0;
+    uint64_t last_line_start_ = 0;
+    uint64_t indexed_ = 0;
+    uint64_t drawn_lines_ = 0;
+    uint64_t view_line_base_ = 0;
+    uint64_t pending_view_line_base_ = no_line;
+    uint64_t first_visible_ = 0;
+    uint64_t goto_line_ = no_line;
+};
+
+TextFileView::TextFileView(const char* text, const char *path, Size size, Position position) :
+    pimpl_{std::make_unique<impl>(text, path, size, position)}
+{}
+
+TextFileView::~TextFileView() = default;
+
+TextFileView::TextFileView(TextFileView const& rhs) :
+    pimpl_{std::make_unique<impl>(rhs.pimpl_->text_, rhs.pimpl_->path_, rhs.pimpl_->size_, rhs.pimpl_->position_)}
+{}
+
+void TextFileView::draw() const
+{
+    pimpl_->draw();
+}
+
+}
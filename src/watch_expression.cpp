@@ -0,0 +1,829 @@
+#include "watch_expression.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace guicpp
+{
+
+namespace
+{
+
+using Op = WatchExpression::Op;
+using Instruction = WatchExpression::Instruction;
+
+bool read_memory(WatchMemory const& memory, uint8_t type, int64_t address, WatchSlot &out)
+{
+    const FieldType field = static_cast<FieldType>(type >> 1);
+    const size_t n = StructLayout::type_size(field);
+    const size_t size = memory.provider ? memory.provider->size() : memory.size;
+    if (address < 0 || size < n || static_cast<uint64_t>(address) > size - n) {
+        return false;
+    }
+    uint8_t buffer[8];
+    const uint8_t *p = buffer;
+    if (memory.provider) {
+        memory.provider->read(static_cast<size_t>(address), buffer, n);
+    } else {
+        p = memory.bytes + address;
+    }
+    uint64_t raw = 0;
+    for (size_t i = 0; i < n; i++) {
+        raw |= static_cast<uint64_t>(p[(type & 1) == 0 ? i : n - 1 - i]) << (8 * i);
+    }
+    switch (field) {
+    case FieldType::i8:
+        out.i = static_cast<int8_t>(raw);
+        break;
+    case FieldType::i16:
+        out.i = static_cast<int16_t>(raw);
+        break;
+    case FieldType::i32:
+        out.i = static_cast<int32_t>(raw);
+        break;
+    case FieldType::f32: {
+        const uint32_t bits = static_cast<uint32_t>(raw);
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        out.f = f;
+        break;
+    }
+    case FieldType::f64:
+        std::memcpy(&out.f, &raw, sizeof(out.f));
+        break;
+    default:
+        out.i = static_cast<int64_t>(raw);
+        break;
+    }
+    return true;
+}
+
+// Integer arithmetic wraps around like the unsigned types, instead of being undefined
+int64_t wrap(uint64_t value)
+{
+    return static_cast<int64_t>(value);
+}
+
+// Shift counts outside [0, 63] fail the evaluation, instead of being undefined
+bool shift_count(int64_t count)
+{
+    return count >= 0 && count <= 63;
+}
+
+// Doubles out of the int64_t range, NaN included, become 0
+int64_t truncate(double value)
+{
+    return value > -9.2e18 && value < 9.2e18 ? static_cast<int64_t>(value) : 0;
+}
+
+// The interpreter loop, also used to fold operations on constants while compiling
+bool run(Instruction const *code, size_t count, WatchSlot const *constants, std::vector<WatchMemory> const& memories, WatchSlot &result)
+{
+    WatchSlot stack[WatchExpression::max_depth];
+    size_t sp = 0;
+    for (Instruction const *in = code, *end = code + count; in != end; ++in) {
+        WatchSlot &b = stack[sp > 0 ? sp - 1 : 0];
+        switch (in->op) {
+        case Op::push:
+            stack[sp++] = constants[in->operand];
+            continue;
+        case Op::load:
+            if (!read_memory(memories[in->memory], in->type, b.i, b)) {
+                return false;
+            }
+            continue;
+        case Op::load_at:
+            if (!read_memory(memories[in->memory], in->type, constants[in->operand].i, stack[sp++])) {
+                return false;
+            }
+            continue;
+        case Op::to_float: b.f = static_cast<double>(b.i); continue;
+        case Op::to_float_below: stack[sp - 2].f = static_cast<double>(stack[sp - 2].i); continue;
+        case Op::to_float_u: b.f = static_cast<double>(static_cast<uint64_t>(b.i)); continue;
+        case Op::to_float_below_u: stack[sp - 2].f = static_cast<double>(static_cast<uint64_t>(stack[sp - 2].i)); continue;
+        case Op::to_int: b.i = truncate(b.f); continue;
+        case Op::neg_i: b.i = wrap(0 - static_cast<uint64_t>(b.i)); continue;
+        case Op::neg_f: b.f = -b.f; continue;
+        case Op::not_i: b.i = ~b.i; continue;
+        case Op::lnot_i: b.i = b.i == 0; continue;
+        case Op::lnot_f: b.i = b.f == 0.0; continue;
+        case Op::abs_i: b.i = b.i < 0 ? wrap(0 - static_cast<uint64_t>(b.i)) : b.i; continue;
+        case Op::abs_f: b.f = std::fabs(b.f); continue;
+        default:
+            break;
+        }
+        // Binary operations leave their result in a
+        WatchSlot &a = stack[sp - 2];
+        switch (in->op) {
+        case Op::add_i: a.i = wrap(static_cast<uint64_t>(a.i) + static_cast<uint64_t>(b.i)); break;
+        case Op::add_f: a.f += b.f; break;
+        case Op::sub_i: a.i = wrap(static_cast<uint64_t>(a.i) - static_cast<uint64_t>(b.i)); break;
+        case Op::sub_f: a.f -= b.f; break;
+        case Op::mul_i: a.i = wrap(static_cast<uint64_t>(a.i) * static_cast<uint64_t>(b.i)); break;
+        case Op::mul_f: a.f *= b.f; break;
+        case Op::div_i:
+            if (b.i == 0) {
+                return false;
+            }
+            a.i = b.i == -1 ? wrap(0 - static_cast<uint64_t>(a.i)) : a.i / b.i;
+            break;
+        case Op::div_f: a.f /= b.f; break;
+        case Op::div_u:
+            if (b.i == 0) {
+                return false;
+            }
+            a.i = wrap(static_cast<uint64_t>(a.i) / static_cast<uint64_t>(b.i));
+            break;
+        case Op::mod_i:
+            if (b.i == 0) {
+                return false;
+            }
+            a.i = b.i == -1 ? 0 : a.i % b.i;
+            break;
+        case Op::mod_u:
+            if (b.i == 0) {
+                return false;
+            }
+            a.i = wrap(static_cast<uint64_t>(a.i) % static_cast<uint64_t>(b.i));
+            break;
+        case Op::shl:
+            if (!shift_count(b.i)) {
+                return false;
+            }
+            a.i = wrap(static_cast<uint64_t>(a.i) << b.i);
+            break;
+        case Op::shr:
+            if (!shift_count(b.i)) {
+                return false;
+            }
+            a.i = wrap(static_cast<uint64_t>(a.i) >> b.i);
+            break;
+        case Op::and_i: a.i &= b.i; break;
+        case Op::or_i: a.i |= b.i; break;
+        case Op::xor_i: a.i ^= b.i; break;
+        case Op::bit:
+            if (!shift_count(b.i)) {
+                return false;
+            }
+            a.i = static_cast<int64_t>(static_cast<uint64_t>(a.i) >> b.i & 1);
+            break;
+        case Op::lt_i: a.i = a.i < b.i; break;
+        case Op::lt_f: a.i = a.f < b.f; break;
+        case Op::le_i: a.i = a.i <= b.i; break;
+        case Op::le_f: a.i = a.f <= b.f; break;
+        case Op::gt_i: a.i = a.i > b.i; break;
+        case Op::gt_f: a.i = a.f > b.f; break;
+        case Op::ge_i: a.i = a.i >= b.i; break;
+        case Op::ge_f: a.i = a.f >= b.f; break;
+        case Op::eq_i: a.i = a.i == b.i; break;
+        case Op::eq_f: a.i = a.f == b.f; break;
+        case Op::ne_i: a.i = a.i != b.i; break;
+        case Op::ne_f: a.i = a.f != b.f; break;
+        case Op::lt_u: a.i = static_cast<uint64_t>(a.i) < static_cast<uint64_t>(b.i); break;
+        case Op::le_u: a.i = static_cast<uint64_t>(a.i) <= static_cast<uint64_t>(b.i); break;
+        case Op::gt_u: a.i = static_cast<uint64_t>(a.i) > static_cast<uint64_t>(b.i); break;
+        case Op::ge_u: a.i = static_cast<uint64_t>(a.i) >= static_cast<uint64_t>(b.i); break;
+        case Op::min_i: a.i = std::min(a.i, b.i); break;
+        case Op::min_f: a.f = std::min(a.f, b.f); break;
+        case Op::max_i: a.i = std::max(a.i, b.i); break;
+        case Op::max_f: a.f = std::max(a.f, b.f); break;
+        case Op::min_u: a.i = wrap(std::min(static_cast<uint64_t>(a.i), static_cast<uint64_t>(b.i))); break;
+        case Op::max_u: a.i = wrap(std::max(static_cast<uint64_t>(a.i), static_cast<uint64_t>(b.i))); break;
+        case Op::land: a.i = a.i != 0 && b.i != 0; break;
+        case Op::lor: a.i = a.i != 0 || b.i != 0; break;
+        default: break;
+        }
+        sp--;
+    }
+    result = stack[0];
+    return true;
+}
+
+int arity(Op op)
+{
+    switch (op) {
+    case Op::push:
+    case Op::load_at:
+        return 0;
+    case Op::load:
+    case Op::to_float:
+    case Op::to_float_u:
+    case Op::to_int:
+    case Op::neg_i:
+    case Op::neg_f:
+    case Op::not_i:
+    case Op::lnot_i:
+    case Op::lnot_f:
+    case Op::abs_i:
+    case Op::abs_f:
+        return 1;
+    case Op::to_float_below:
+    case Op::to_float_below_u:
+        return -1;
+    default:
+        return 2;
+    }
+}
+
+struct Read
+{
+    const char *name;
+    FieldType type;
+};
+
+const Read reads[] = {
+    {"u8", FieldType::u8}, {"i8", FieldType::i8}, {"u16", FieldType::u16}, {"i16", FieldType::i16},
+    {"u32", FieldType::u32}, {"i32", FieldType::i32}, {"u64", FieldType::u64}, {"i64", FieldType::i64},
+    {"f32", FieldType::f32}, {"f64", FieldType::f64},
+};
+
+}
+
+// Recursive descent over the C operator precedence, emitting instructions as it goes. Each
+// parse function returns whether the value it left on the stack is a float.
+class WatchCompiler
+{
+public:
+    WatchCompiler(WatchExpression &out, std::string_view source, std::vector<WatchMemory> const& memories) :
+        out_{out},
+        source_{source},
+        memories_{memories}
+    {}
+
+    bool compile()
+    {
+        out_.code_.clear();
+        out_.constants_.clear();
+        out_.error_.clear();
+        out_.error_column_ = 0;
+        unsigned_.clear();
+        next();
+        if (token_ == Token::end) {
+            return fail("expression expected");
+        }
+        bool real;
+        if (!parse_or(real)) {
+            return false;
+        }
+        if (token_ != Token::end) {
+            return fail("unexpected text");
+        }
+        out_.is_float_ = real;
+        out_.is_unsigned_ = !real && !unsigned_.empty() && unsigned_.back();
+        return true;
+    }
+
+private:
+    enum class Token { end, integer, real, name, op };
+
+    struct Binary
+    {
+        const char *text;
+        Op integer;
+        Op real; // integer only when the same
+    };
+
+    bool fail(const char *message)
+    {
+        if (out_.error_.empty()) {
+            out_.error_ = message;
+            out_.error_column_ = start_ + 1;
+        }
+        out_.code_.clear();
+        return false;
+    }
+
+    void next()
+    {
+        while (position_ < source_.size() && std::isspace(static_cast<unsigned char>(source_[position_]))) {
+            position_++;
+        }
+        start_ = position_;
+        if (position_ >= source_.size()) {
+            token_ = Token::end;
+            text_ = {};
+            return;
+        }
+        const char c = source_[position_];
+        if (std::isdigit(static_cast<unsigned char>(c)) || (c == '.' && position_ + 1 < source_.size() && std::isdigit(static_cast<unsigned char>(source_[position_ + 1])))) {
+            lex_number();
+        } else if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            while (position_ < source_.size() && (std::isalnum(static_cast<unsigned char>(source_[position_])) || source_[position_] == '_')) {
+                position_++;
+            }
+            token_ = Token::name;
+        } else {
+            static const char *two[] = {"<<", ">>", "<=", ">=", "==", "!=", "&&", "||"};
+            position_++;
+            for (auto t : two) {
+                if (c == t[0] && position_ < source_.size() && source_[position_] == t[1]) {
+                    position_++;
+                    break;
+                }
+            }
+            token_ = Token::op;
+        }
+        text_ = source_.substr(start_, position_ - start_);
+    }
+
+    void lex_number()
+    {
+        std::string number{source_.substr(position_, std::min<size_t>(source_.size() - position_, 64))};
+        char *end;
+        if (number.size() > 1 && number[0] == '0' && (number[1] == 'x' || number[1] == 'X')) {
+            value_.i = wrap(std::strtoull(number.c_str(), &end, 16));
+            token_ = Token::integer;
+        } else {
+            value_.i = wrap(std::strtoull(number.c_str(), &end, 10));
+            token_ = Token::integer;
+            if (*end == '.' || *end == 'e' || *end == 'E') {
+                value_.f = std::strtod(number.c_str(), &end);
+                token_ = Token::real;
+            }
+        }
+        position_ += end - number.c_str();
+    }
+
+    bool is(const char *op) const
+    {
+        return token_ == Token::op && text_ == op;
+    }
+
+    bool expect(const char *op)
+    {
+        if (!is(op)) {
+            std::string message = std::string{"'"} + op + "' expected";
+            fail(message.c_str());
+            return false;
+        }
+        next();
+        return true;
+    }
+
+    // Keeps which values on the stack are u64, and picks the unsigned variant of op when it
+    // compares, divides or converts one. Integer operations with a u64 operand give a u64, like in C.
+    Op track_unsigned(Op op, int n, uint8_t type)
+    {
+        const size_t size = unsigned_.size();
+        const bool top = size >= 1 && unsigned_[size - 1];
+        const bool below = size >= 2 && unsigned_[size - 2];
+        if (n == -1) {
+            unsigned_[size - 2] = false;
+            return below ? Op::to_float_below_u : op;
+        }
+        bool result = false;
+        if (op == Op::load || op == Op::load_at) {
+            result = static_cast<FieldType>(type >> 1) == FieldType::u64;
+        } else if (n == 1) {
+            result = top && (op == Op::neg_i || op == Op::not_i || op == Op::abs_i);
+            op = top && op == Op::to_float ? Op::to_float_u : op;
+        } else if (n == 2) {
+            const bool either = top || below;
+            switch (op) {
+            case Op::div_i: op = either ? Op::div_u : op; result = either; break;
+            case Op::mod_i: op = either ? Op::mod_u : op; result = either; break;
+            case Op::min_i: op = either ? Op::min_u : op; result = either; break;
+            case Op::max_i: op = either ? Op::max_u : op; result = either; break;
+            case Op::lt_i: op = either ? Op::lt_u : op; break;
+            case Op::le_i: op = either ? Op::le_u : op; break;
+            case Op::gt_i: op = either ? Op::gt_u : op; break;
+            case Op::ge_i: op = either ? Op::ge_u : op; break;
+            case Op::add_i: case Op::sub_i: case Op::mul_i: case Op::and_i: case Op::or_i: case Op::xor_i:
+                result = either;
+                break;
+            case Op::shl: case Op::shr:
+                result = below;
+                break;
+            default:
+                break;
+            }
+        }
+        unsigned_.resize(size - std::min<size_t>(size, static_cast<size_t>(n)));
+        unsigned_.push_back(result);
+        return op;
+    }
+
+    bool emit(Op op, uint8_t memory = 0, uint8_t type = 0, uint32_t operand = 0)
+    {
+        auto &code = out_.code_;
+        const int n = arity(op);
+        op = track_unsigned(op, n, type);
+        // A u64 is its own absolute value
+        if (op == Op::abs_i && unsigned_.back()) {
+            return true;
+        }
+        depth_ += n == 0 ? 1 : n == 2 ? -1 : 0;
+        max_depth_ = std::max(max_depth_, depth_);
+        if (max_depth_ > static_cast<int>(WatchExpression::max_depth)) {
+            return fail("expression too deep");
+        }
+        // Reads at constant addresses take the address from the instruction
+        if (op == Op::load && !code.empty() && code.back().op == Op::push) {
+            code.back() = Instruction{Op::load_at, memory, type, code.back().operand};
+            return true;
+        }
+        // Conversions of constants change the constant. The operand below the top is a constant when
+        // the top is a single instruction and the one before it a push.
+        if ((op == Op::to_float && code.size() >= 1 && code.back().op == Op::push) ||
+            (op == Op::to_float_below && code.size() >= 2 && arity(code.back().op) == 0 && code[code.size() - 2].op == Op::push)) {
+            auto &c = out_.constants_[code[code.size() - (op == Op::to_float ? 1 : 2)].operand];
+            c.f = static_cast<double>(c.i);
+            return true;
+        }
+        code.push_back(Instruction{op, memory, type, operand});
+        fold(n);
+        return true;
+    }
+
+    // Replaces an operation on constants by its result, operations failing like 1/0 are kept
+    void fold(int n)
+    {
+        auto &code = out_.code_;
+        if (n < 1 || code.size() < static_cast<size_t>(n) + 1) {
+            return;
+        }
+        const size_t first = code.size() - 1 - n;
+        for (size_t i = first; i + 1 < code.size(); i++) {
+            if (code[i].op != Op::push) {
+                return;
+            }
+        }
+        WatchSlot result;
+        if (!run(code.data() + first, n + 1, out_.constants_.data(), memories_, result)) {
+            return;
+        }
+        out_.constants_.resize(code[first].operand);
+        code.resize(first);
+        depth_--;
+        unsigned_.pop_back();
+        push(result);
+    }
+
+    void push(WatchSlot value)
+    {
+        out_.constants_.push_back(value);
+        emit(Op::push, 0, 0, static_cast<uint32_t>(out_.constants_.size() - 1));
+    }
+
+    bool integers(bool left, bool right)
+    {
+        if (left || right) {
+            return fail("integer operands expected");
+        }
+        return true;
+    }
+
+    // Converts the operands of a binary operation to float when either is one
+    bool promote(bool left, bool right)
+    {
+        if (left == right) {
+            return true;
+        }
+        return emit(left ? Op::to_float : Op::to_float_below);
+    }
+
+    // Turns a float into 0 or 1 for the logical operators
+    bool truth(bool real)
+    {
+        if (!real) {
+            return true;
+        }
+        WatchSlot zero;
+        zero.f = 0.0;
+        push(zero);
+        return emit(Op::ne_f);
+    }
+
+    // One level of left associative binary operators, parse being the next level
+    bool parse_binary(bool &real, bool (WatchCompiler::*parse)(bool&), Binary const *ops, size_t count, bool integer_only)
+    {
+        if (!(this->*parse)(real)) {
+            return false;
+        }
+        for (;;) {
+            Binary const *op = nullptr;
+            for (size_t i = 0; i < count; i++) {
+                if (is(ops[i].text)) {
+                    op = &ops[i];
+                }
+            }
+            if (op == nullptr) {
+                return true;
+            }
+            next();
+            bool right;
+            if (!(this->*parse)(right)) {
+                return false;
+            }
+            if (integer_only) {
+                if (!integers(real, right) || !emit(op->integer)) {
+                    return false;
+                }
+                continue;
+            }
+            const bool comparison = op->integer >= Op::lt_i && op->integer <= Op::ne_f;
+            if (!promote(real, right) || !emit(real || right ? op->real : op->integer)) {
+                return false;
+            }
+            real = (real || right) && !comparison;
+        }
+    }
+
+    bool parse_or(bool &real)
+    {
+        if (!parse_and(real)) {
+            return false;
+        }
+        while (is("||")) {
+            next();
+            bool right;
+            if (!truth(real) || !parse_and(right) || !truth(right) || !emit(Op::lor)) {
+                return false;
+            }
+            real = false;
+        }
+        return true;
+    }
+
+    bool parse_and(bool &real)
+    {
+        if (!parse_bit_or(real)) {
+            return false;
+        }
+        while (is("&&")) {
+            next();
+            bool right;
+            if (!truth(real) || !parse_bit_or(right) || !truth(right) || !emit(Op::land)) {
+                return false;
+            }
+            real = false;
+        }
+        return true;
+    }
+
+    bool parse_bit_or(bool &real)
+    {
+        static const Binary ops[] = {{"|", Op::or_i, Op::or_i}};
+        return parse_binary(real, &WatchCompiler::parse_bit_xor, ops, 1, true);
+    }
+
+    bool parse_bit_xor(bool &real)
+    {
+        static const Binary ops[] = {{"^", Op::xor_i, Op::xor_i}};
+        return parse_binary(real, &WatchCompiler::parse_bit_and, ops, 1, true);
+    }
+
+    bool parse_bit_and(bool &real)
+    {
+        static const Binary ops[] = {{"&", Op::and_i, Op::and_i}};
+        return parse_binary(real, &WatchCompiler::parse_equality, ops, 1, true);
+    }
+
+    bool parse_equality(bool &real)
+    {
+        static const Binary ops[] = {{"==", Op::eq_i, Op::eq_f}, {"!=", Op::ne_i, Op::ne_f}};
+        return parse_binary(real, &WatchCompiler::parse_relational, ops, 2, false);
+    }
+
+    bool parse_relational(bool &real)
+    {
+        static const Binary ops[] = {{"<", Op::lt_i, Op::lt_f}, {"<=", Op::le_i, Op::le_f}, {">", Op::gt_i, Op::gt_f}, {">=", Op::ge_i, Op::ge_f}};
+        return parse_binary(real, &WatchCompiler::parse_shift, ops, 4, false);
+    }
+
+    bool parse_shift(bool &real)
+    {
+        static const Binary ops[] = {{"<<", Op::shl, Op::shl}, {">>", Op::shr, Op::shr}};
+        return parse_binary(real, &WatchCompiler::parse_additive, ops, 2, true);
+    }
+
+    bool parse_additive(bool &real)
+    {
+        static const Binary ops[] = {{"+", Op::add_i, Op::add_f}, {"-", Op::sub_i, Op::sub_f}};
+        return parse_binary(real, &WatchCompiler::parse_term, ops, 2, false);
+    }
+
+    bool parse_term(bool &real)
+    {
+        if (!parse_unary(real)) {
+            return false;
+        }
+        for (;;) {
+            const bool mul = is("*");
+            const bool div = is("/");
+            if (!mul && !div && !is("%")) {
+                return true;
+            }
+            next();
+            bool right;
+            if (!parse_unary(right)) {
+                return false;
+            }
+            if (!mul && !div) {
+                if (!integers(real, right) || !emit(Op::mod_i)) {
+                    return false;
+                }
+                continue;
+            }
+            const bool both = real || right;
+            if (!promote(real, right) || !emit(mul ? (both ? Op::mul_f : Op::mul_i) : (both ? Op::div_f : Op::div_i))) {
+                return false;
+            }
+            real = both;
+        }
+    }
+
+    bool parse_unary(bool &real)
+    {
+        if (is("+")) {
+            next();
+            return parse_unary(real);
+        }
+        if (is("-") || is("~") || is("!")) {
+            const char op = text_[0];
+            next();
+            if (!parse_unary(real)) {
+                return false;
+            }
+            if (op == '-') {
+                return emit(real ? Op::neg_f : Op::neg_i);
+            }
+            if (op == '!') {
+                const bool was_real = real;
+                real = false;
+                return emit(was_real ? Op::lnot_f : Op::lnot_i);
+            }
+            return integers(real, false) && emit(Op::not_i);
+        }
+        return parse_primary(real);
+    }
+
+    bool parse_primary(bool &real)
+    {
+        if (token_ == Token::integer || token_ == Token::real) {
+            real = token_ == Token::real;
+            push(value_);
+            next();
+            return true;
+        }
+        if (is("(")) {
+            next();
+            return parse_or(real) && expect(")");
+        }
+        if (token_ != Token::name) {
+            return fail(token_ == Token::end ? "unexpected end" : "value expected");
+        }
+        std::string_view name = text_;
+        const size_t name_start = start_;
+        next();
+        if (is("[")) {
+            int memory = find_memory(name);
+            if (memory < 0) {
+                start_ = name_start;
+                return fail("unknown memory");
+            }
+            next();
+            bool index;
+            if (!parse_or(index) || !integers(index, false) || !expect("]")) {
+                return false;
+            }
+            real = false;
+            return emit(Op::load, static_cast<uint8_t>(memory), static_cast<uint8_t>(static_cast<int>(FieldType::u8) * 2));
+        }
+        if (!is("(")) {
+            start_ = name_start;
+            return fail("unknown name");
+        }
+        next();
+        int type = read_type(name);
+        if (type >= 0) {
+            return parse_read(type, real);
+        }
+        return parse_function(name, name_start, real);
+    }
+
+    int find_memory(std::string_view name) const
+    {
+        for (size_t i = 0; i < memories_.size() && i < 256; i++) {
+            if (memories_[i].name == name) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    // u32le, i16be, f64le and so on, little endian without a suffix
+    static int read_type(std::string_view name)
+    {
+        Endian endian = Endian::little;
+        if (name.size() > 2 && (name.substr(name.size() - 2) == "le" || name.substr(name.size() - 2) == "be")) {
+            endian = name.substr(name.size() - 2) == "le" ? Endian::little : Endian::big;
+            name.remove_suffix(2);
+        }
+        for (auto const& read : reads) {
+            if (name == read.name) {
+                return static_cast<int>(read.type) * 2 + static_cast<int>(endian);
+            }
+        }
+        return -1;
+    }
+
+    // The address, after the name of a memory and a comma for others than the first
+    bool parse_read(int type, bool &real)
+    {
+        int memory = 0;
+        if (token_ == Token::name) {
+            const size_t save_start = start_;
+            const int named = find_memory(text_);
+            next();
+            if (named >= 0 && is(",")) {
+                memory = named;
+                next();
+            } else {
+                position_ = save_start;
+                next();
+            }
+        }
+        if (memories_.empty()) {
+            return fail("no memory bound");
+        }
+        bool address;
+        if (!parse_or(address) || !integers(address, false) || !expect(")")) {
+            return false;
+        }
+        const FieldType field = static_cast<FieldType>(type >> 1);
+        real = field == FieldType::f32 || field == FieldType::f64;
+        return emit(Op::load, static_cast<uint8_t>(memory), static_cast<uint8_t>(type));
+    }
+
+    bool parse_function(std::string_view name, size_t name_start, bool &real)
+    {
+        bool first;
+        if (!parse_or(first)) {
+            return false;
+        }
+        if (name == "abs" || name == "int" || name == "float") {
+            if (!expect(")")) {
+                return false;
+            }
+            if (name == "abs") {
+                real = first;
+                return emit(first ? Op::abs_f : Op::abs_i);
+            }
+            real = name == "float";
+            if (real == first) {
+                return true;
+            }
+            return emit(real ? Op::to_float : Op::to_int);
+        }
+        if (name != "bit" && name != "min" && name != "max") {
+            start_ = name_start;
+            return fail("unknown function");
+        }
+        bool second;
+        if (!expect(",") || !parse_or(second) || !expect(")")) {
+            return false;
+        }
+        if (name == "bit") {
+            real = false;
+            return integers(first, second) && emit(Op::bit);
+        }
+        real = first || second;
+        if (!promote(first, second)) {
+            return false;
+        }
+        if (name == "min") {
+            return emit(real ? Op::min_f : Op::min_i);
+        }
+        return emit(real ? Op::max_f : Op::max_i);
+    }
+
+    WatchExpression &out_;
+    std::string_view source_;
+    std::vector<WatchMemory> const& memories_;
+    size_t position_ = 0;
+    size_t start_ = 0;
+    Token token_ = Token::end;
+    std::string_view text_;
+    WatchSlot value_{};
+    int depth_ = 0;
+    int max_depth_ = 0;
+    std::vector<bool> unsigned_; // per value on the stack while compiling
+};
+
+bool WatchExpression::compile(std::string_view source, std::vector<WatchMemory> const& memories)
+{
+    return WatchCompiler{*this, source, memories}.compile();
+}
+
+bool WatchExpression::evaluate(std::vector<WatchMemory> const& memories, WatchSlot &result) const
+{
+    if (code_.empty()) {
+        return false;
+    }
+    return run(code_.data(), code_.size(), constants_.data(), memories, result);
+}
+
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <gui/gui.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace guicpp
+{
+
+// Memory an expression reads by name, bytes or a provider
+struct WatchMemory
+{
+    std::string name;
+    const uint8_t *bytes;
+    size_t size;
+    std::shared_ptr<MemoryProvider> provider;
+};
+
+union WatchSlot
+{
+    int64_t i;
+    double f;
+};
+
+// Expression compiled to bytecode for a stack machine. Every subexpression has a type known when
+// compiling, integer, unsigned (from u64 reads) or float, so the instructions are typed and the
+// interpreter never checks tags.
+// Reads at constant addresses, the usual case, take their address from the instruction.
+class WatchExpression
+{
+public:
+    // Deepest stack accepted, expressions nesting deeper do not compile
+    static constexpr size_t max_depth = 32;
+
+    // Returns false with error() and error_column() set when source does not compile. Memory
+    // names are looked up in memories, reads without a name go to the first one.
+    bool compile(std::string_view source, std::vector<WatchMemory> const& memories);
+    // Returns false when a read falls outside its memory
+    bool evaluate(std::vector<WatchMemory> const& memories, WatchSlot &result) const;
+
+    bool is_float() const { return is_float_; }
+    // The integer result is a u64, to be shown unsigned
+    bool is_unsigned() const { return is_unsigned_; }
+    size_t instructions() const { return code_.size(); }
+    const char* error() const { return error_.c_str(); }
+    size_t error_column() const { return error_column_; }
+
+    enum class Op : uint8_t {
+        push, load, load_at, to_float, to_float_below, to_float_u, to_float_below_u, to_int,
+        neg_i, neg_f, not_i, lnot_i, lnot_f, abs_i, abs_f,
+        add_i, add_f, sub_i, sub_f, mul_i, mul_f, div_i, div_f, div_u, mod_i, mod_u,
+        shl, shr, and_i, or_i, xor_i, bit,
+        lt_i, lt_f, le_i, le_f, gt_i, gt_f, ge_i, ge_f, eq_i, eq_f, ne_i, ne_f,
+        lt_u, le_u, gt_u, ge_u,
+        min_i, min_f, max_i, max_f, min_u, max_u,
+        land, lor,
+    };
+
+    struct Instruction
+    {
+        Op op;
+        uint8_t memory;
+        uint8_t type; // FieldType * 2 + Endian of loads
+        uint32_t operand; // constant index
+    };
+
+private:
+    std::vector<Instruction> code_;
+    std::vector<WatchSlot> constants_;
+    bool is_float_ = false;
+    bool is_unsigned_ = false;
+    std::string error_;
+    size_t error_column_ = 0;
+
+    friend class WatchCompiler;
+};
+
+}
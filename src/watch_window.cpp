@@ -0,0 +1,256 @@
+#include <gui/gui.h>
+#include "imgui.h"
+#include "watch_expression.h"
+#include <cfloat>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+
+namespace guicpp
+{
+
+struct WatchWindow::impl
+{
+    // Values kept for each plot, a sample per frame
+    static constexpr size_t plot_points = 300;
+
+    struct Watch
+    {
+        char text[256];
+        WatchExpression expression;
+        bool compiled;
+        bool valid;
+        WatchSlot value;
+        char formatted[48];
+        bool plot;
+        bool log;
+        std::vector<float> history;
+        size_t history_next;
+    };
+
+    const char *text_;
+    Size size_;
+    Position position_;
+    std::vector<WatchMemory> memories_;
+    std::vector<Watch> watches_;
+    std::optional<LogChannel> channel_;
+    char new_text_[256] = {};
+    double evaluate_us_ = 0.0;
+
+    impl(const char* text, Size size, Position position) :
+        text_{text},
+        size_{size},
+        position_{position}
+    {}
+
+    // Watches compile again, names they use may be bound now
+    void bind(WatchMemory memory)
+    {
+        memories_.push_back(std::move(memory));
+        for (auto &w : watches_) {
+            compile(w);
+        }
+    }
+
+    void watch(const char *expression, bool plot)
+    {
+        watches_.emplace_back();
+        Watch &w = watches_.back();
+        snprintf(w.text, sizeof(w.text), "%s", expression);
+        w.plot = plot;
+        w.log = false;
+        compile(w);
+    }
+
+    void compile(Watch &w)
+    {
+        w.compiled = w.expression.compile(w.text, memories_);
+        w.valid = false;
+        w.value.i = 0;
+        w.history.clear();
+        w.history_next = 0;
+        if (w.compiled) {
+            snprintf(w.formatted, sizeof(w.formatted), "-");
+        } else {
+            snprintf(w.formatted, sizeof(w.formatted), "column %zu: %s", w.expression.error_column(), w.expression.error());
+        }
+    }
+
+    // Values are formatted, and logged, only when they change
+    void evaluate()
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (auto &w : watches_) {
+            if (!w.compiled) {
+                continue;
+            }
+            WatchSlot value;
+            const bool valid = w.expression.evaluate(memories_, value);
+            const bool real = w.expression.is_float();
+            if (valid != w.valid || (valid && std::memcmp(&value, &w.value, sizeof(value)) != 0)) {
+                char previous[sizeof(w.formatted)];
+                std::memcpy(previous, w.formatted, sizeof(previous));
+                if (!valid) {
+                    snprintf(w.formatted, sizeof(w.formatted), "-");
+                } else if (real) {
+                    snprintf(w.formatted, sizeof(w.formatted), "%.6g", value.f);
+                } else if (w.expression.is_unsigned()) {
+                    snprintf(w.formatted, sizeof(w.formatted), "%llu (0x%llX)", static_cast<unsigned long long>(value.i), static_cast<unsigned long long>(value.i));
+                } else {
+                    snprintf(w.formatted, sizeof(w.formatted), "%lld (0x%llX)", static_cast<long long>(value.i), static_cast<unsigned long long>(value.i));
+                }
+                if (w.log && channel_ && w.valid) {
+                    channel_->info("{}: {} -> {}", w.text, previous, w.formatted);
+                }
+                w.valid = valid;
+                w.value = value;
+            }
+            if (w.plot && w.valid) {
+                const double integer = w.expression.is_unsigned() ? static_cast<double>(static_cast<uint64_t>(w.value.i)) : static_cast<double>(w.value.i);
+                const float sample = static_cast<float>(real ? w.value.f : integer);
+                if (w.history.size() < plot_points) {
+                    w.history.push_back(sample);
+                } else {
+                    w.history[w.history_next] = sample;
+                    w.history_next = (w.history_next + 1) % plot_points;
+                }
+            }
+        }
+        evaluate_us_ = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void draw()
+    {
+        evaluate();
+        ImGui::SetNextWindowSize(ImVec2(size_.width, size_.height), ImGuiCond_FirstUseEver);
+        ImGui::SetNextWindowPos(ImVec2(position_.x, position_.y), ImGuiCond_FirstUseEver);
+        ImGui::Begin(text_);
+        draw_table();
+
+        ImGui::SetNextItemWidth(-ImGui::CalcTextSize("Add").x - ImGui::GetStyle().FramePadding.x * 2.0f - ImGui::GetStyle().ItemSpacing.x);
+        bool add = ImGui::InputTextWithHint("##new", "u32le(0x100) * 0.001", new_text_, sizeof(new_text_), ImGuiInputTextFlags_EnterReturnsTrue);
+        ImGui::SameLine();
+        add |= ImGui::Button("Add");
+        if (add && new_text_[0] != '\0') {
+            watch(new_text_, false);
+            new_text_[0] = '\0';
+        }
+
+        for (size_t i = 0; i < watches_.size(); i++) {
+            auto const& w = watches_[i];
+            if (!w.plot || w.history.empty()) {
+                continue;
+            }
+            ImGui::PushID(static_cast<int>(i));
+            ImGui::PlotLines("##plot", w.history.data(), static_cast<int>(w.history.size()), static_cast<int>(w.history_next), w.text,
+                FLT_MAX, FLT_MAX, ImVec2(-1.0f, ImGui::GetTextLineHeight() * 4.0f));
+            ImGui::PopID();
+        }
+        ImGui::TextDisabled("%zu watches evaluated in %.1f us", watches_.size(), evaluate_us_);
+        ImGui::End();
+    }
+
+    void draw_table()
+    {
+        const ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable;
+        if (!ImGui::BeginTable("##watches", channel_ ? 5 : 4, flags)) {
+            return;
+        }
+        ImGui::TableSetupColumn("Expression", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Value", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Plot", ImGuiTableColumnFlags_WidthFixed);
+        if (channel_) {
+            ImGui::TableSetupColumn("Log", ImGuiTableColumnFlags_WidthFixed);
+        }
+        ImGui::TableSetupColumn("", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableHeadersRow();
+
+        size_t removed = watches_.size();
+        for (size_t i = 0; i < watches_.size(); i++) {
+            auto &w = watches_[i];
+            ImGui::PushID(static_cast<int>(i));
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::SetNextItemWidth(-1.0f);
+            if (ImGui::InputText("##expression", w.text, sizeof(w.text), ImGuiInputTextFlags_EnterReturnsTrue)) {
+                compile(w);
+            }
+            ImGui::TableNextColumn();
+            if (!w.compiled) {
+                ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", w.formatted);
+            } else if (!w.valid) {
+                ImGui::TextDisabled("%s", w.formatted);
+            } else {
+                ImGui::TextUnformatted(w.formatted);
+            }
+            ImGui::TableNextColumn();
+            if (ImGui::Checkbox("##plot", &w.plot)) {
+                w.history.clear();
+                w.history_next = 0;
+            }
+            if (channel_) {
+                ImGui::TableNextColumn();
+                ImGui::Checkbox("##log", &w.log);
+            }
+            ImGui::TableNextColumn();
+            if (ImGui::SmallButton("x")) {
+                removed = i;
+            }
+            ImGui::PopID();
+        }
+        ImGui::EndTable();
+        if (removed < watches_.size()) {
+            watches_.erase(watches_.begin() + removed);
+        }
+    }
+};
+
+WatchWindow::WatchWindow(const char* text, Size size, Position position) :
+    pimpl_{std::make_unique<impl>(text, size, position)}
+{}
+
+WatchWindow::~WatchWindow() = default;
+
+WatchWindow::WatchWindow(WatchWindow const& rhs) :
+    pimpl_{std::make_unique<impl>(rhs.pimpl_->text_, rhs.pimpl_->size_, rhs.pimpl_->position_)}
+{
+    auto const& r = *rhs.pimpl_;
+    pimpl_->memories_ = r.memories_;
+    pimpl_->channel_ = r.channel_;
+    for (auto const& w : r.watches_) {
+        pimpl_->watch(w.text, w.plot);
+        pimpl_->watches_.back().log = w.log;
+    }
+}
+
+void WatchWindow::draw() const
+{
+    pimpl_->draw();
+}
+
+WatchWindow& WatchWindow::bind(const char *name, const uint8_t *bytes, size_t size)
+{
+    pimpl_->bind(WatchMemory{name, bytes, size, nullptr});
+    return *this;
+}
+
+WatchWindow& WatchWindow::bind(const char *name, std::shared_ptr<MemoryProvider> provider)
+{
+    pimpl_->bind(WatchMemory{name, nullptr, 0, std::move(provider)});
+    return *this;
+}
+
+WatchWindow& WatchWindow::watch(const char *expression, bool plot)
+{
+    pimpl_->watch(expression, plot);
+    return *this;
+}
+
+WatchWindow& WatchWindow::log(LogChannel channel)
+{
+    pimpl_->channel_ = std::move(channel);
+    return *this;
+}
+
+}